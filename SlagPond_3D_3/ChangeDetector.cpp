@@ -0,0 +1,214 @@
+#include "ChangeDetector.h"
+#include "ParallelFor.h"
+
+#include <QSettings>
+#include <cmath>
+#include <algorithm>
+
+ChangeDetector::ChangeDetector()
+    : m_hasReference(false)
+    , m_window(3)
+    , m_threshold(0.25f)
+    , m_minBlobCells(4)
+{
+}
+
+void ChangeDetector::loadSettings(QSettings &settings)
+{
+    settings.beginGroup("change");
+    setWindow(settings.value("window", m_window).toInt());
+    setThreshold(settings.value("threshold", m_threshold).toFloat());
+    setMinBlobCells(settings.value("minBlobCells", m_minBlobCells).toInt());
+    settings.endGroup();
+}
+
+void ChangeDetector::setReference(const HeightGrid &reference)
+{
+    m_reference = reference;
+    m_hasReference = true;
+}
+
+ChangeResult ChangeDetector::detect(const HeightGrid &current) const
+{
+    ChangeResult result;
+    if (!m_hasReference || current.cols() != m_reference.cols() || current.rows() != m_reference.rows()) {
+        return result;
+    }
+
+    const int cols = current.cols();
+    const int rows = current.rows();
+    const int n = cols * rows;
+    const int radius = m_window / 2;
+    const float threshold = m_threshold;
+
+    result.cols = cols;
+    result.rows = rows;
+    result.delta.resize(n);
+
+    const float *cur = current.heights().constData();
+    const float *ref = m_reference.heights().constData();
+    const quint8 *curValid = current.validMask().constData();
+    const quint8 *refValid = m_reference.validMask().constData();
+
+    // 1. 原始差分和权重（两次扫描都有效的单元权重为1）
+    QVector<float> diff(n);
+    QVector<float> weight(n);
+    float *d = diff.data();
+    float *w = weight.data();
+
+    parallelFor(rows, [&](int begin, int end) {
+        for (int i = begin * cols; i < end * cols; ++i) {
+            const float m = static_cast<float>(curValid[i] & refValid[i]);
+            d[i] = (cur[i] - ref[i]) * m;
+            w[i] = m;
+        }
+    });
+
+    // 2. 水平方向窗口求和：行两端补零后逐偏移累加整行
+    QVector<float> rowSumD(n, 0.0f);
+    QVector<float> rowSumW(n, 0.0f);
+    float *hd = rowSumD.data();
+    float *hw = rowSumW.data();
+
+    parallelFor(rows, [&](int begin, int end) {
+        QVector<float> padD(cols + 2 * radius, 0.0f);
+        QVector<float> padW(cols + 2 * radius, 0.0f);
+        float *pd = padD.data();
+        float *pw = padW.data();
+
+        for (int row = begin; row < end; ++row) {
+            std::copy(d + row * cols, d + (row + 1) * cols, pd + radius);
+            std::copy(w + row * cols, w + (row + 1) * cols, pw + radius);
+
+            float *outD = hd + row * cols;
+            float *outW = hw + row * cols;
+            for (int k = 0; k <= 2 * radius; ++k) {
+                for (int c = 0; c < cols; ++c) {
+                    outD[c] += pd[c + k];
+                    outW[c] += pw[c + k];
+                }
+            }
+        }
+    });
+
+    // 3. 垂直方向窗口求和，求加权平均并按阈值截断
+    float *out = result.delta.data();
+
+    parallelFor(rows, [&](int begin, int end) {
+        QVector<float> sumD(cols);
+        QVector<float> sumW(cols);
+        float *sd = sumD.data();
+        float *sw = sumW.data();
+
+        for (int row = begin; row < end; ++row) {
+            std::fill(sd, sd + cols, 0.0f);
+            std::fill(sw, sw + cols, 0.0f);
+
+            const int r0 = qMax(0, row - radius);
+            const int r1 = qMin(rows - 1, row + radius);
+            for (int rr = r0; rr <= r1; ++rr) {
+                const float *srcD = hd + rr * cols;
+                const float *srcW = hw + rr * cols;
+                for (int c = 0; c < cols; ++c) {
+                    sd[c] += srcD[c];
+                    sw[c] += srcW[c];
+                }
+            }
+
+            const float *center = w + row * cols;
+            float *dst = out + row * cols;
+            for (int c = 0; c < cols; ++c) {
+                const float mean = sd[c] / std::max(sw[c], 1.0f);
+                const bool changed = center[c] > 0.0f && std::fabs(mean) >= threshold;
+                dst[c] = changed ? mean : 0.0f;
+            }
+        }
+    });
+
+    labelBlobs(current, result);
+    return result;
+}
+
+void ChangeDetector::labelBlobs(const HeightGrid &current, ChangeResult &result) const
+{
+    const int cols = result.cols;
+    const int rows = result.rows;
+    const float cellArea = current.cellArea();
+
+    result.labels.fill(0, cols * rows);
+    result.blobs.clear();
+    result.maxAbsDelta = 0.0f;
+
+    QVector<int> stack;
+    QVector<int> cells;
+
+    // 4连通、同号单元归为一个连通块
+    for (int seed = 0; seed < cols * rows; ++seed) {
+        const float seedDelta = result.delta[seed];
+        if (seedDelta == 0.0f || result.labels[seed] != 0) {
+            continue;
+        }
+
+        const int sign = seedDelta > 0.0f ? 1 : -1;
+        const int label = result.blobs.size() + 1;
+
+        ChangeBlob blob;
+        blob.sign = sign;
+        double sumX = 0.0;
+        double sumY = 0.0;
+
+        cells.clear();
+        stack.clear();
+        stack.append(seed);
+        result.labels[seed] = label;
+
+        while (!stack.isEmpty()) {
+            const int i = stack.takeLast();
+            cells.append(i);
+
+            const float delta = result.delta[i];
+            const QPointF c = current.cellCenter(i);
+            blob.volume += delta * cellArea;
+            blob.peakDelta = qMax(blob.peakDelta, std::fabs(delta));
+            sumX += c.x();
+            sumY += c.y();
+
+            const int col = i % cols;
+            const int row = i / cols;
+            const int neighbours[4][2] = {{col - 1, row}, {col + 1, row}, {col, row - 1}, {col, row + 1}};
+            for (const auto &nb : neighbours) {
+                if (nb[0] < 0 || nb[0] >= cols || nb[1] < 0 || nb[1] >= rows) {
+                    continue;
+                }
+                const int j = nb[1] * cols + nb[0];
+                const float dj = result.delta[j];
+                if (result.labels[j] == 0 && dj != 0.0f && (dj > 0.0f) == (sign > 0)) {
+                    result.labels[j] = label;
+                    stack.append(j);
+                }
+            }
+        }
+
+        // 过小的连通块视为噪声，清除
+        if (cells.size() < m_minBlobCells) {
+            for (int i : cells) {
+                result.labels[i] = -1;
+                result.delta[i] = 0.0f;
+            }
+            continue;
+        }
+
+        blob.cellCount = cells.size();
+        blob.area = blob.cellCount * cellArea;
+        blob.centroid = QPointF(sumX / blob.cellCount, sumY / blob.cellCount);
+        result.maxAbsDelta = qMax(result.maxAbsDelta, blob.peakDelta);
+        result.blobs.append(blob);
+    }
+
+    // 噪声单元标记为-1只是为了避免重复访问，最后统一归零
+    for (int &label : result.labels) {
+        if (label < 0) {
+            label = 0;
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef CHANGEDETECTOR_H
+#define CHANGEDETECTOR_H
+
+#include "HeightGrid.h"
+
+#include <QVector>
+#include <QPointF>
+
+class QSettings;
+
+// 变化区域（连通块）
+struct ChangeBlob {
+    int sign = 0;          // +1 堆高（卸料），-1 降低（抓取）
+    int cellCount = 0;
+    float area = 0.0f;     // 面积
+    float volume = 0.0f;   // 带符号体积
+    float peakDelta = 0.0f;
+    QPointF centroid;
+};
+
+// 一次变化检测的结果
+struct ChangeResult {
+    int cols = 0;
+    int rows = 0;
+    QVector<float> delta;       // 窗口平滑后的带符号高差，未超阈值处为0
+    QVector<int> labels;        // 0 = 无变化，否则为 blobs 下标 + 1
+    QVector<ChangeBlob> blobs;
+    float maxAbsDelta = 0.0f;
+};
+
+// 当前高度栅格与参考扫描的差分
+// 差分和窗口平滑按行分块并行，内层为连续数组运算以便编译器向量化
+class ChangeDetector
+{
+public:
+    ChangeDetector();
+
+    // 平滑窗口边长（单元数，取奇数）
+    void setWindow(int window) { m_window = qMax(1, window | 1); }
+    int window() const { return m_window; }
+
+    // 判定为变化的最小高差（米）
+    void setThreshold(float threshold) { m_threshold = qMax(0.0f, threshold); }
+    float threshold() const { return m_threshold; }
+
+    // 小于该单元数的连通块视为噪声
+    void setMinBlobCells(int cells) { m_minBlobCells = qMax(1, cells); }
+    int minBlobCells() const { return m_minBlobCells; }
+
+    // 从配置文件[change]组读取以上参数，未配置的项保持当前值
+    void loadSettings(QSettings &settings);
+
+    void setReference(const HeightGrid &reference);
+    void clearReference() { m_hasReference = false; }
+    bool hasReference() const { return m_hasReference; }
+    const HeightGrid& reference() const { return m_reference; }
+
+    // 与参考扫描比较，栅格尺寸不一致或无参考时返回空结果
+    ChangeResult detect(const HeightGrid &current) const;
+
+private:
+    void labelBlobs(const HeightGrid &current, ChangeResult &result) const;
+
+    HeightGrid m_reference;
+    bool m_hasReference;
+
+    int m_window;
+    float m_threshold;
+    int m_minBlobCells;
+};
+
+#endif // CHANGEDETECTOR_H
@@ -0,0 +1,58 @@
+#include "CloudMerger.h"
+#include "RangeImage.h"
+
+CloudMerger::CloudMerger()
+    : m_ownershipTimeout(5000)
+{
+    m_clock.start();
+    reset(m_layout);
+}
+
+void CloudMerger::reset(const HeightGrid &layout, const QVector<qint8> &regionMask)
+{
+    m_layout.reset(layout.originX(), layout.originY(), layout.cellSize(), layout.cols(), layout.rows());
+    m_regionMask = regionMask.size() == m_layout.cellCount() ? regionMask : QVector<qint8>();
+    m_owner.fill(-1, m_layout.cellCount());
+    m_lastSeen.fill(0, m_layout.cellCount());
+}
+
+int CloudMerger::merge(int radar, const RangeImage &image, const QVector<int> &lines, MergedPoints &out)
+{
+    const qint64 now = m_clock.elapsed();
+    const qint64 expired = now - m_ownershipTimeout;
+
+    const QVector<float> &xs = image.xs();
+    const QVector<float> &ys = image.ys();
+    const QVector<float> &zs = image.zs();
+    const QVector<float> &amplitudes = image.amplitudes();
+
+    const int before = out.size();
+    for (int row : lines) {
+        const int base = image.index(row, 0);
+        const int count = image.lineCount(row);
+        for (int col = 0; col < count; ++col) {
+            const int i = base + col;
+            const int cell = m_layout.cellIndex(xs[i], ys[i]);
+            // 区域外的点在去重前丢弃，不占用单元属主
+            if (cell < 0 || (!m_regionMask.isEmpty() && m_regionMask[cell] < 0)) {
+                continue;
+            }
+
+            // 无属主或属主已超时的单元归本雷达，其它雷达的单元丢弃
+            qint8 &owner = m_owner[cell];
+            if (owner != radar) {
+                if (owner >= 0 && m_lastSeen[cell] > expired) {
+                    continue;
+                }
+                owner = static_cast<qint8>(radar);
+            }
+            m_lastSeen[cell] = now;
+
+            out.x.append(xs[i]);
+            out.y.append(ys[i]);
+            out.z.append(zs[i]);
+            out.amplitude.append(amplitudes[i]);
+        }
+    }
+    return out.size() - before;
+}
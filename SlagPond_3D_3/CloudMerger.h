@@ -0,0 +1,49 @@
+#ifndef CLOUDMERGER_H
+#define CLOUDMERGER_H
+
+#include "HeightGrid.h"
+
+#include <QVector>
+#include <QElapsedTimer>
+
+class RangeImage;
+
+// 合并后的点（SoA，渣池坐标系）
+struct MergedPoints {
+    QVector<float> x;
+    QVector<float> y;
+    QVector<float> z;
+    QVector<float> amplitude;
+
+    int size() const { return x.size(); }
+    void clear() { x.clear(); y.clear(); z.clear(); amplitude.clear(); }
+};
+
+// 多雷达点云合并：各雷达数据经各自的标定变换（含配准修正）到渣池坐标系后，
+// 在融合栅格上按单元去重——重叠区的单元只采用一台雷达（"属主"）的数据，
+// 避免两台雷达的系统偏差在同一单元内被平均成台阶；属主超时未观测时由其它雷达接管
+class CloudMerger
+{
+public:
+    CloudMerger();
+
+    // 去重栅格与融合栅格一致，清空属主记录
+    // regionMask与layout同尺寸时，小于0的单元（不在任何渣池内）直接丢弃，不参与属主判定
+    void reset(const HeightGrid &layout, const QVector<qint8> &regionMask = QVector<qint8>());
+
+    // 属主超过该时间（毫秒）未观测到单元时，其它雷达可接管
+    void setOwnershipTimeout(int ms) { m_ownershipTimeout = ms; }
+
+    // 将某台雷达指定扫描线中的点去重后追加到out，返回追加的点数
+    int merge(int radar, const RangeImage &image, const QVector<int> &lines, MergedPoints &out);
+
+private:
+    HeightGrid m_layout;
+    QVector<qint8> m_regionMask; // 空 = 不限制区域
+    QVector<qint8> m_owner;      // -1 = 无属主
+    QVector<qint64> m_lastSeen;  // 属主最近一次观测的时间（毫秒）
+    QElapsedTimer m_clock;
+    int m_ownershipTimeout;
+};
+
+#endif // CLOUDMERGER_H
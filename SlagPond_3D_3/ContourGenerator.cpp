@@ -0,0 +1,215 @@
+#include "ContourGenerator.h"
+#include "ParallelFor.h"
+
+#include <cmath>
+#include <algorithm>
+
+ContourGenerator::ContourGenerator()
+    : m_interval(0.5f)
+    , m_cols(0)
+    , m_rows(0)
+    , m_tileCols(0)
+    , m_tileRows(0)
+{
+}
+
+void ContourGenerator::setInterval(float interval)
+{
+    if (interval > 0.0f && interval != m_interval) {
+        m_interval = interval;
+        markAllDirty();
+    }
+}
+
+void ContourGenerator::reset(const HeightGrid &layout)
+{
+    m_cols = layout.cols();
+    m_rows = layout.rows();
+    m_tileCols = (m_cols + TILE_SIZE - 1) / TILE_SIZE;
+    m_tileRows = (m_rows + TILE_SIZE - 1) / TILE_SIZE;
+
+    m_tiles.clear();
+    m_tiles.resize(m_tileCols * m_tileRows);
+    m_tileDirty.fill(0, m_tiles.size());
+    m_dirtyTiles.clear();
+}
+
+void ContourGenerator::markTile(int col, int row)
+{
+    if (col < 0 || row < 0) {
+        return;
+    }
+    const int tile = (row / TILE_SIZE) * m_tileCols + col / TILE_SIZE;
+    if (tile < m_tiles.size() && !m_tileDirty[tile]) {
+        m_tileDirty[tile] = 1;
+        m_dirtyTiles.append(tile);
+    }
+}
+
+void ContourGenerator::markDirty(const QVector<int> &cells)
+{
+    if (m_cols <= 0) {
+        return;
+    }
+
+    // 方格(c, r)以单元(c, r)为左下角，一个单元最多影响左下四个方格
+    for (int cell : cells) {
+        const int col = cell % m_cols;
+        const int row = cell / m_cols;
+        markTile(col, row);
+        if (col % TILE_SIZE == 0) {
+            markTile(col - 1, row);
+        }
+        if (row % TILE_SIZE == 0) {
+            markTile(col, row - 1);
+            if (col % TILE_SIZE == 0) {
+                markTile(col - 1, row - 1);
+            }
+        }
+    }
+}
+
+void ContourGenerator::markAllDirty()
+{
+    m_dirtyTiles.clear();
+    for (int tile = 0; tile < m_tiles.size(); ++tile) {
+        m_tileDirty[tile] = 1;
+        m_dirtyTiles.append(tile);
+    }
+}
+
+bool ContourGenerator::update(const HeightGrid &grid)
+{
+    if (grid.cols() != m_cols || grid.rows() != m_rows) {
+        reset(grid);
+        markAllDirty();
+    }
+    if (m_dirtyTiles.isEmpty()) {
+        return false;
+    }
+
+    // 先取出数据指针，避免在工作线程中触发容器分离
+    QVector<QVector3D> *tiles = m_tiles.data();
+    const int *dirty = m_dirtyTiles.constData();
+    parallelFor(m_dirtyTiles.size(), [&](int begin, int end) {
+        for (int k = begin; k < end; ++k) {
+            buildTile(grid, dirty[k], tiles[dirty[k]]);
+        }
+    }, 1);
+
+    for (int tile : m_dirtyTiles) {
+        m_tileDirty[tile] = 0;
+    }
+    m_dirtyTiles.clear();
+    return true;
+}
+
+void ContourGenerator::buildTile(const HeightGrid &grid, int tile, QVector<QVector3D> &out) const
+{
+    out.clear();
+
+    const int col0 = (tile % m_tileCols) * TILE_SIZE;
+    const int row0 = (tile / m_tileCols) * TILE_SIZE;
+    // 方格需要右上方相邻单元，最后一行/列单元不构成方格
+    const int col1 = qMin(col0 + TILE_SIZE, m_cols - 1);
+    const int row1 = qMin(row0 + TILE_SIZE, m_rows - 1);
+
+    const float *h = grid.heights().constData();
+    const quint8 *valid = grid.validMask().constData();
+    const float cellSize = grid.cellSize();
+    const float x0 = grid.originX() + 0.5f * cellSize;
+    const float y0 = grid.originY() + 0.5f * cellSize;
+    const float interval = m_interval;
+
+    // 方格四角按逆时针：0 左下，1 右下，2 右上，3 左上；边 e 连接角 e 和 e+1
+    static const int cornerOffset[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+    // 每种情况的线段（边号对），-1 结束；5和10为鞍点，单独处理
+    static const int edgeTable[16][4] = {
+        {-1, -1, -1, -1}, {3, 0, -1, -1}, {0, 1, -1, -1}, {3, 1, -1, -1},
+        {1, 2, -1, -1},   {3, 0, 1, 2},   {0, 2, -1, -1}, {3, 2, -1, -1},
+        {2, 3, -1, -1},   {2, 0, -1, -1}, {0, 1, 2, 3},   {2, 1, -1, -1},
+        {1, 3, -1, -1},   {1, 0, -1, -1}, {0, 3, -1, -1}, {-1, -1, -1, -1}
+    };
+
+    for (int row = row0; row < row1; ++row) {
+        for (int col = col0; col < col1; ++col) {
+            float v[4];
+            bool complete = true;
+            for (int k = 0; k < 4; ++k) {
+                const int i = grid.index(col + cornerOffset[k][0], row + cornerOffset[k][1]);
+                complete = complete && valid[i];
+                v[k] = h[i];
+            }
+            // 有无效角的方格不生成等高线，避免穿过雷达盲区
+            if (!complete) {
+                continue;
+            }
+
+            const float lo = std::min(std::min(v[0], v[1]), std::min(v[2], v[3]));
+            const float hi = std::max(std::max(v[0], v[1]), std::max(v[2], v[3]));
+            const int firstLevel = static_cast<int>(std::ceil(lo / interval));
+            const int lastLevel = static_cast<int>(std::floor(hi / interval));
+
+            for (int level = firstLevel; level <= lastLevel; ++level) {
+                const float z = level * interval;
+                int index = 0;
+                for (int k = 0; k < 4; ++k) {
+                    if (v[k] >= z) {
+                        index |= 1 << k;
+                    }
+                }
+                if (index == 0 || index == 15) {
+                    continue;
+                }
+
+                // 边上的插值点
+                auto edgePoint = [&](int edge) {
+                    const int a = edge;
+                    const int b = (edge + 1) & 3;
+                    const float t = (z - v[a]) / (v[b] - v[a]);
+                    const float cx = col + cornerOffset[a][0] + t * (cornerOffset[b][0] - cornerOffset[a][0]);
+                    const float cy = row + cornerOffset[a][1] + t * (cornerOffset[b][1] - cornerOffset[a][1]);
+                    return QVector3D(x0 + cx * cellSize, y0 + cy * cellSize, z);
+                };
+
+                const int *edges = edgeTable[index];
+                // 鞍点按方格中心均值决定连接方式
+                int saddle[4];
+                if (index == 5 || index == 10) {
+                    const bool centerAbove = 0.25f * (v[0] + v[1] + v[2] + v[3]) >= z;
+                    const bool lowerLeftAbove = index == 5;
+                    if (centerAbove == lowerLeftAbove) {
+                        saddle[0] = 0; saddle[1] = 1; saddle[2] = 2; saddle[3] = 3;
+                    } else {
+                        saddle[0] = 3; saddle[1] = 0; saddle[2] = 1; saddle[3] = 2;
+                    }
+                    edges = saddle;
+                }
+
+                for (int s = 0; s < 4 && edges[s] >= 0; s += 2) {
+                    out.append(edgePoint(edges[s]));
+                    out.append(edgePoint(edges[s + 1]));
+                }
+            }
+        }
+    }
+}
+
+QVector<QVector3D> ContourGenerator::segments() const
+{
+    QVector<QVector3D> all;
+    all.reserve(segmentCount() * 2);
+    for (const QVector<QVector3D> &tile : m_tiles) {
+        all += tile;
+    }
+    return all;
+}
+
+int ContourGenerator::segmentCount() const
+{
+    int count = 0;
+    for (const QVector<QVector3D> &tile : m_tiles) {
+        count += tile.size() / 2;
+    }
+    return count;
+}
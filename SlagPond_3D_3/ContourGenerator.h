@@ -0,0 +1,50 @@
+#ifndef CONTOURGENERATOR_H
+#define CONTOURGENERATOR_H
+
+#include "HeightGrid.h"
+
+#include <QVector>
+#include <QVector3D>
+
+// 等高线提取（marching squares）
+// 栅格按固定大小分块，每块独立保存线段；只重新生成单元有变化的块，各块并行处理
+class ContourGenerator
+{
+public:
+    ContourGenerator();
+
+    // 等高距（米）
+    void setInterval(float interval);
+    float interval() const { return m_interval; }
+
+    // 清空所有块（栅格尺寸变化时调用）
+    void reset(const HeightGrid &layout);
+
+    // 标记受这些单元影响的块需要重新生成
+    void markDirty(const QVector<int> &cells);
+    void markAllDirty();
+
+    // 重新生成标记过的块，有更新时返回true
+    bool update(const HeightGrid &grid);
+
+    // 全部线段端点（每两个点一条线段，z为等高线高度）
+    QVector<QVector3D> segments() const;
+    int segmentCount() const;
+
+private:
+    void markTile(int col, int row);
+    void buildTile(const HeightGrid &grid, int tile, QVector<QVector3D> &out) const;
+
+    static const int TILE_SIZE = 32;   // 每块的单元边长
+
+    float m_interval;
+    int m_cols;
+    int m_rows;
+    int m_tileCols;
+    int m_tileRows;
+    QVector<QVector<QVector3D>> m_tiles;
+    QVector<quint8> m_tileDirty;
+    QVector<int> m_dirtyTiles;
+};
+
+#endif // CONTOURGENERATOR_H
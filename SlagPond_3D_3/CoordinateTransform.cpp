@@ -0,0 +1,205 @@
+#include "CoordinateTransform.h"
+#include "RangeImage.h"
+#include "ParallelFor.h"
+
+#include <QSettings>
+#include <QStringList>
+#include <QDebug>
+#include <QtMath>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define SLAGPOND_USE_SSE 1
+#endif
+
+CoordinateTransform::CoordinateTransform()
+    : m_inputMode(InputCartesian)
+    , m_unitScale(0.25f)
+    , m_lineSpacing(0.0f)
+{
+    // 默认标定与原显示一致：原始单位的1/4为米，扫描方向原点移到池心
+    m_pondExtrinsics.translate(0.0f, -12.5f, 0.0f);
+    updateMatrix();
+}
+
+void CoordinateTransform::setUnitScale(float metresPerUnit)
+{
+    m_unitScale = metresPerUnit;
+    updateMatrix();
+}
+
+void CoordinateTransform::setLineSpacing(float metresPerLine)
+{
+    m_lineSpacing = metresPerLine;
+    updateMatrix();
+}
+
+void CoordinateTransform::setMountPose(const QVector3D &position, float yaw, float pitch, float roll)
+{
+    m_mountPose.setToIdentity();
+    m_mountPose.translate(position);
+    m_mountPose.rotate(yaw, 0.0f, 0.0f, 1.0f);
+    m_mountPose.rotate(pitch, 0.0f, 1.0f, 0.0f);
+    m_mountPose.rotate(roll, 1.0f, 0.0f, 0.0f);
+    updateMatrix();
+}
+
+void CoordinateTransform::setPondExtrinsics(const QMatrix4x4 &extrinsics)
+{
+    m_pondExtrinsics = extrinsics;
+    updateMatrix();
+}
+
+void CoordinateTransform::setRegistration(const QMatrix4x4 &registration)
+{
+    m_registration = registration;
+    updateMatrix();
+}
+
+void CoordinateTransform::updateMatrix()
+{
+    // y列为扫描线坐标（RangeImage::lineY），极坐标模式下按扫描线间距换算
+    float lineScale = m_unitScale;
+    if (m_inputMode == InputPolar && m_lineSpacing > 0.0f) {
+        lineScale = m_lineSpacing * RangeImage::SCAN_LINES / RangeImage::SCAN_Y_RANGE;
+    }
+    QMatrix4x4 scale;
+    scale.scale(m_unitScale, lineScale, m_unitScale);
+    m_matrix = m_registration * m_pondExtrinsics * m_mountPose * scale;
+
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 4; ++col) {
+            m_rows[row * 4 + col] = m_matrix(row, col);
+        }
+    }
+}
+
+void CoordinateTransform::apply(float *x, float *y, float *z, int count) const
+{
+    if (m_inputMode == InputPolar) {
+        // x列为距离，z列为波束角（度）
+        for (int i = 0; i < count; ++i) {
+            const float range = x[i];
+            const float angle = qDegreesToRadians(z[i]);
+            x[i] = range * std::sin(angle);
+            z[i] = -range * std::cos(angle);
+        }
+    }
+
+    const float *m = m_rows;
+    int i = 0;
+
+#ifdef SLAGPOND_USE_SSE
+    const __m128 m00 = _mm_set1_ps(m[0]), m01 = _mm_set1_ps(m[1]), m02 = _mm_set1_ps(m[2]), m03 = _mm_set1_ps(m[3]);
+    const __m128 m10 = _mm_set1_ps(m[4]), m11 = _mm_set1_ps(m[5]), m12 = _mm_set1_ps(m[6]), m13 = _mm_set1_ps(m[7]);
+    const __m128 m20 = _mm_set1_ps(m[8]), m21 = _mm_set1_ps(m[9]), m22 = _mm_set1_ps(m[10]), m23 = _mm_set1_ps(m[11]);
+
+    for (; i + 4 <= count; i += 4) {
+        const __m128 px = _mm_loadu_ps(x + i);
+        const __m128 py = _mm_loadu_ps(y + i);
+        const __m128 pz = _mm_loadu_ps(z + i);
+
+        const __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, px), _mm_mul_ps(m01, py)),
+                                     _mm_add_ps(_mm_mul_ps(m02, pz), m03));
+        const __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, px), _mm_mul_ps(m11, py)),
+                                     _mm_add_ps(_mm_mul_ps(m12, pz), m13));
+        const __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, px), _mm_mul_ps(m21, py)),
+                                     _mm_add_ps(_mm_mul_ps(m22, pz), m23));
+
+        _mm_storeu_ps(x + i, rx);
+        _mm_storeu_ps(y + i, ry);
+        _mm_storeu_ps(z + i, rz);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        const float px = x[i];
+        const float py = y[i];
+        const float pz = z[i];
+        x[i] = m[0] * px + m[1] * py + m[2] * pz + m[3];
+        y[i] = m[4] * px + m[5] * py + m[6] * pz + m[7];
+        z[i] = m[8] * px + m[9] * py + m[10] * pz + m[11];
+    }
+}
+
+void CoordinateTransform::apply(RangeImage &image, const QVector<int> &lines) const
+{
+    float *x = image.xs().data();
+    float *y = image.ys().data();
+    float *z = image.zs().data();
+
+    parallelFor(lines.size(), [&](int begin, int end) {
+        for (int k = begin; k < end; ++k) {
+            const int row = lines[k];
+            const int base = image.index(row, 0);
+            apply(x + base, y + base, z + base, image.lineCount(row));
+        }
+    });
+}
+
+void CoordinateTransform::loadSettings(QSettings &settings, const QString &group)
+{
+    settings.beginGroup(group);
+
+    m_inputMode = settings.value("inputMode", "cartesian").toString() == "polar" ? InputPolar : InputCartesian;
+    m_unitScale = settings.value("unitScale", m_unitScale).toFloat();
+    m_lineSpacing = settings.value("lineSpacing", m_lineSpacing).toFloat();
+
+    const QVector3D mount(settings.value("mountX", 0.0f).toFloat(),
+                          settings.value("mountY", 0.0f).toFloat(),
+                          settings.value("mountZ", 0.0f).toFloat());
+    setMountPose(mount,
+                 settings.value("mountYaw", 0.0f).toFloat(),
+                 settings.value("mountPitch", 0.0f).toFloat(),
+                 settings.value("mountRoll", 0.0f).toFloat());
+
+    QMatrix4x4 extrinsics;
+    extrinsics.translate(settings.value("pondX", 0.0f).toFloat(),
+                         settings.value("pondY", -12.5f).toFloat(),
+                         settings.value("pondZ", 0.0f).toFloat());
+    extrinsics.rotate(settings.value("pondYaw", 0.0f).toFloat(), 0.0f, 0.0f, 1.0f);
+    setPondExtrinsics(extrinsics);
+
+    QMatrix4x4 registration;
+    // 未加引号的逗号分隔值会被QSettings解析成字符串列表
+    const QVariant value = settings.value("registration");
+    const QString text = value.typeId() == QMetaType::QStringList ? value.toStringList().join(',') : value.toString();
+    if (!text.isEmpty() && !matrixFromString(text, &registration)) {
+        qDebug() << group << "的registration格式错误，应为16个逗号分隔的数";
+    }
+    setRegistration(registration);
+
+    settings.endGroup();
+}
+
+QString CoordinateTransform::matrixToString(const QMatrix4x4 &matrix)
+{
+    QStringList values;
+    for (int row = 0; row < 4; ++row) {
+        for (int col = 0; col < 4; ++col) {
+            values << QString::number(matrix(row, col), 'g', 9);
+        }
+    }
+    return values.join(',');
+}
+
+bool CoordinateTransform::matrixFromString(const QString &text, QMatrix4x4 *matrix)
+{
+    const QStringList values = text.split(',', Qt::SkipEmptyParts);
+    if (values.size() != 16) {
+        return false;
+    }
+
+    float m[16];
+    for (int i = 0; i < 16; ++i) {
+        bool ok = false;
+        m[i] = values[i].trimmed().toFloat(&ok);
+        if (!ok) {
+            return false;
+        }
+    }
+    // QMatrix4x4(const float*)按行优先读取
+    *matrix = QMatrix4x4(m);
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef COORDINATETRANSFORM_H
+#define COORDINATETRANSFORM_H
+
+#include <QMatrix4x4>
+#include <QVector3D>
+#include <QVector>
+#include <QString>
+
+class RangeImage;
+class QSettings;
+
+// 雷达原始数据 -> 渣池坐标系（米）的标定变换
+// 依次为：极坐标转直角坐标（可选）、单位换算、雷达安装位姿、渣池外参。
+// 三者合成为一个4x4矩阵，按SoA列批量施加（SSE一次处理4个点）。
+class CoordinateTransform
+{
+public:
+    enum InputMode {
+        InputCartesian,   // 第0/2列为x/z
+        InputPolar        // 第0/2列为距离/波束角（度，0为竖直向下）
+    };
+
+    CoordinateTransform();
+
+    void setInputMode(InputMode mode) { m_inputMode = mode; updateMatrix(); }
+    InputMode inputMode() const { return m_inputMode; }
+
+    // 原始数据单位对应的米数
+    void setUnitScale(float metresPerUnit);
+    float unitScale() const { return m_unitScale; }
+
+    // 极坐标模式下相邻扫描线的间距（米），只作用于扫描方向(y)，距离仍按单位换算
+    // 小于等于0时与直角坐标模式相同，按单位换算缩放扫描线坐标
+    void setLineSpacing(float metresPerLine);
+    float lineSpacing() const { return m_lineSpacing; }
+
+    // 雷达安装位姿（米、度），旋转顺序为偏航(z) -> 俯仰(y) -> 横滚(x)
+    void setMountPose(const QVector3D &position, float yaw, float pitch, float roll);
+    // 渣池外参：雷达基准坐标系 -> 渣池坐标系（原点在池心）
+    void setPondExtrinsics(const QMatrix4x4 &extrinsics);
+    const QMatrix4x4& pondExtrinsics() const { return m_pondExtrinsics; }
+    // 多雷达配准修正（由离线ICP估计），作用在渣池坐标系上，默认为单位阵
+    void setRegistration(const QMatrix4x4 &registration);
+    const QMatrix4x4& registration() const { return m_registration; }
+
+    // 合成后的4x4矩阵
+    const QMatrix4x4& matrix() const { return m_matrix; }
+
+    // 变换距离图像中指定的扫描线（原地修改）
+    void apply(RangeImage &image, const QVector<int> &lines) const;
+    // 变换一组SoA坐标（原地修改）
+    void apply(float *x, float *y, float *z, int count) const;
+
+    // 从配置文件的指定组读取标定参数，缺失项保持默认
+    // 主雷达为[calibration]，其余雷达为[radar1]、[radar2]...
+    void loadSettings(QSettings &settings, const QString &group = QStringLiteral("calibration"));
+
+    // 4x4矩阵与配置文件字符串（16个数，行优先，逗号分隔）互转
+    static QString matrixToString(const QMatrix4x4 &matrix);
+    static bool matrixFromString(const QString &text, QMatrix4x4 *matrix);
+
+private:
+    void updateMatrix();
+
+    InputMode m_inputMode;
+    float m_unitScale;
+    float m_lineSpacing;
+    QMatrix4x4 m_mountPose;
+    QMatrix4x4 m_pondExtrinsics;
+    QMatrix4x4 m_registration;
+    QMatrix4x4 m_matrix;
+    float m_rows[12];   // 合成矩阵前三行，行优先
+};
+
+#endif // COORDINATETRANSFORM_H
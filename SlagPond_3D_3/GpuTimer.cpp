@@ -0,0 +1,149 @@
+#include "GpuTimer.h"
+
+#include <QOpenGLTimerQuery>
+#include <QDebug>
+#include <algorithm>
+
+FrameStats::FrameStats(int capacity)
+    : m_samples(qMax(1, capacity), 0.0f)
+{
+}
+
+void FrameStats::add(float ms)
+{
+    m_samples[m_next] = ms;
+    m_next = (m_next + 1) % m_samples.size();
+    m_count = qMin(m_count + 1, static_cast<int>(m_samples.size()));
+}
+
+float FrameStats::percentile(float p) const
+{
+    if (m_count == 0) {
+        return 0.0f;
+    }
+
+    // 窗口只有百余个样本，每次复制后部分排序即可
+    QVector<float> sorted(m_samples.constBegin(), m_samples.constBegin() + m_count);
+    const int k = qBound(0, static_cast<int>(p * (m_count - 1) + 0.5f), m_count - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    return sorted[k];
+}
+
+GpuTimer::GpuTimer() = default;
+
+GpuTimer::~GpuTimer()
+{
+    // 查询对象须在上下文当前时由destroy释放
+}
+
+bool GpuTimer::create()
+{
+    if (m_valid) {
+        return true;
+    }
+
+    for (Frame &frame : m_frames) {
+        for (QOpenGLTimerQuery *&query : frame.queries) {
+            query = new QOpenGLTimerQuery();
+            if (!query->create()) {
+                qDebug() << "不支持GPU计时查询，性能面板只显示CPU时间";
+                destroy();
+                return false;
+            }
+        }
+    }
+    m_valid = true;
+    return true;
+}
+
+void GpuTimer::destroy()
+{
+    for (Frame &frame : m_frames) {
+        for (QOpenGLTimerQuery *&query : frame.queries) {
+            if (query) {
+                query->destroy();
+                delete query;
+                query = nullptr;
+            }
+        }
+        frame.used.fill(false);
+        frame.pending = false;
+    }
+    m_valid = false;
+    m_active = -1;
+}
+
+bool GpuTimer::collect(Frame &frame)
+{
+    for (int pass = 0; pass < PassCount; ++pass) {
+        if (frame.used[pass] && !frame.queries[pass]->isResultAvailable()) {
+            return false;
+        }
+    }
+
+    // 结果均已可用，waitForResult不会阻塞
+    float total = 0.0f;
+    for (int pass = 0; pass < PassCount; ++pass) {
+        const float ms = frame.used[pass] ? frame.queries[pass]->waitForResult() / 1000000.0f : 0.0f;
+        m_passTimes[pass] = ms;
+        total += ms;
+    }
+    m_frameTime = total;
+    m_stats.add(total);
+    frame.pending = false;
+    return true;
+}
+
+void GpuTimer::beginFrame()
+{
+    if (!m_valid) {
+        return;
+    }
+
+    // 从最旧的帧开始收取；最旧一帧即将被复用，仍未完成时只能丢弃
+    m_current = (m_current + 1) % RING_FRAMES;
+    for (int k = 0; k < RING_FRAMES; ++k) {
+        Frame &frame = m_frames[(m_current + k) % RING_FRAMES];
+        if (!frame.pending) {
+            continue;
+        }
+        if (!collect(frame)) {
+            if (k == 0) {
+                frame.pending = false;
+                m_dropped++;
+                continue;
+            }
+            break;
+        }
+    }
+
+    m_frames[m_current].used.fill(false);
+}
+
+void GpuTimer::begin(Pass pass)
+{
+    if (!m_valid || m_active >= 0) {
+        return;
+    }
+    m_frames[m_current].queries[pass]->begin();
+    m_frames[m_current].used[pass] = true;
+    m_active = pass;
+}
+
+void GpuTimer::end(Pass pass)
+{
+    if (!m_valid || m_active != pass) {
+        return;
+    }
+    m_frames[m_current].queries[pass]->end();
+    m_active = -1;
+}
+
+void GpuTimer::endFrame()
+{
+    if (!m_valid) {
+        return;
+    }
+    Frame &frame = m_frames[m_current];
+    frame.pending = std::find(frame.used.begin(), frame.used.end(), true) != frame.used.end();
+}
@@ -0,0 +1,85 @@
+#ifndef GPUTIMER_H
+#define GPUTIMER_H
+
+#include <QVector>
+#include <array>
+
+class QOpenGLTimerQuery;
+
+// 最近若干帧耗时的滑动窗口，用于求分位数
+class FrameStats
+{
+public:
+    explicit FrameStats(int capacity = 120);
+
+    void add(float ms);
+    // p取0~1，无样本时返回0
+    float percentile(float p) const;
+    int count() const { return m_count; }
+
+private:
+    QVector<float> m_samples;
+    int m_next = 0;
+    int m_count = 0;
+};
+
+// 按绘制阶段的GPU计时：每帧每个阶段一个GL_TIME_ELAPSED查询，查询对象按帧环形复用，
+// 只读取已完成的结果（通常落后1~2帧），从不等待GPU
+// 需在OpenGL上下文当前时使用；同一时刻只能有一个阶段在计时
+class GpuTimer
+{
+public:
+    enum Pass {
+        PassFills,
+        PassGrid,
+        PassTicks,
+        PassSurface,     // 三角网格、高度场、等高线、标记
+        PassPoints,
+        PassCount
+    };
+
+    // 环形缓冲的帧数，GPU落后超过该帧数时丢弃最旧一帧的结果
+    static const int RING_FRAMES = 4;
+
+    GpuTimer();
+    ~GpuTimer();
+
+    // 不支持计时查询（GL 3.3以下且无ARB_timer_query）时返回false，之后各调用均为空操作
+    bool create();
+    void destroy();
+    bool isValid() const { return m_valid; }
+
+    // 收取已完成的帧并切换到下一组查询对象
+    void beginFrame();
+    void begin(Pass pass);
+    void end(Pass pass);
+    void endFrame();
+
+    // 最近一次读回的结果（毫秒）
+    float passTime(Pass pass) const { return m_passTimes[pass]; }
+    float frameTime() const { return m_frameTime; }
+    const FrameStats &frameStats() const { return m_stats; }
+    int droppedFrames() const { return m_dropped; }
+
+private:
+    struct Frame {
+        std::array<QOpenGLTimerQuery*, PassCount> queries{};
+        std::array<bool, PassCount> used{};
+        bool pending = false;
+    };
+
+    // 该帧所有查询结果都已可用时读回并返回true
+    bool collect(Frame &frame);
+
+    std::array<Frame, RING_FRAMES> m_frames;
+    int m_current = 0;
+    bool m_valid = false;
+    int m_active = -1;
+
+    std::array<float, PassCount> m_passTimes{};
+    float m_frameTime = 0.0f;
+    FrameStats m_stats;
+    int m_dropped = 0;
+};
+
+#endif // GPUTIMER_H
@@ -0,0 +1,93 @@
+#include "HeightGrid.h"
+
+#include <cmath>
+
+HeightGrid::HeightGrid(float originX, float originY, float cellSize, int cols, int rows)
+{
+    reset(originX, originY, cellSize, cols, rows);
+}
+
+void HeightGrid::reset(float originX, float originY, float cellSize, int cols, int rows)
+{
+    m_originX = originX;
+    m_originY = originY;
+    m_cellSize = cellSize > 0.0f ? cellSize : 1.0f;
+    m_cols = qMax(0, cols);
+    m_rows = qMax(0, rows);
+    clear();
+}
+
+void HeightGrid::clear()
+{
+    m_height.fill(0.0f, cellCount());
+    m_valid.fill(0, cellCount());
+}
+
+int HeightGrid::cellIndex(float x, float y) const
+{
+    const int col = static_cast<int>(std::floor((x - m_originX) / m_cellSize));
+    const int row = static_cast<int>(std::floor((y - m_originY) / m_cellSize));
+    return contains(col, row) ? index(col, row) : -1;
+}
+
+QPointF HeightGrid::cellCenter(int index) const
+{
+    const int col = index % m_cols;
+    const int row = index / m_cols;
+    return QPointF(m_originX + (col + 0.5f) * m_cellSize,
+                   m_originY + (row + 0.5f) * m_cellSize);
+}
+
+bool HeightGrid::heightRange(float *minHeight, float *maxHeight, int *maxIndex, int *minIndex) const
+{
+    bool found = false;
+    float minZ = 0.0f;
+    float maxZ = 0.0f;
+    int maxI = 0;
+    int minI = 0;
+
+    for (int i = 0; i < cellCount(); ++i) {
+        if (!m_valid[i]) {
+            continue;
+        }
+        const float z = m_height[i];
+        if (!found) {
+            minZ = maxZ = z;
+            maxI = minI = i;
+            found = true;
+        } else {
+            if (z < minZ) {
+                minZ = z;
+                minI = i;
+            }
+            if (z > maxZ) {
+                maxZ = z;
+                maxI = i;
+            }
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    if (minHeight) *minHeight = minZ;
+    if (maxHeight) *maxHeight = maxZ;
+    if (maxIndex) *maxIndex = maxI;
+    if (minIndex) *minIndex = minI;
+    return true;
+}
+
+QVector<QVector3D> HeightGrid::toPoints(float scale) const
+{
+    QVector<QVector3D> points;
+    points.reserve(cellCount());
+
+    for (int i = 0; i < cellCount(); ++i) {
+        if (m_valid[i]) {
+            const QPointF c = cellCenter(i);
+            points.append(QVector3D(c.x() * scale, c.y() * scale, m_height[i] * scale));
+        }
+    }
+    return points;
+}
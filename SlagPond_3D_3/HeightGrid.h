@@ -0,0 +1,60 @@
+#ifndef HEIGHTGRID_H
+#define HEIGHTGRID_H
+
+#include <QVector>
+#include <QVector3D>
+#include <QPointF>
+
+// 渣池俯视方向的规则高度栅格（行优先，SoA存储）
+// 坐标为渣池坐标系（米，原点在池心），每个单元保存高度和有效位
+class HeightGrid
+{
+public:
+    HeightGrid(float originX = -12.5f, float originY = -12.5f, float cellSize = 0.125f,
+               int cols = 200, int rows = 200);
+
+    void reset(float originX, float originY, float cellSize, int cols, int rows);
+    void clear();
+
+    int cols() const { return m_cols; }
+    int rows() const { return m_rows; }
+    int cellCount() const { return m_cols * m_rows; }
+    float cellSize() const { return m_cellSize; }
+    float cellArea() const { return m_cellSize * m_cellSize; }
+    float originX() const { return m_originX; }
+    float originY() const { return m_originY; }
+
+    int index(int col, int row) const { return row * m_cols + col; }
+    bool contains(int col, int row) const { return col >= 0 && col < m_cols && row >= 0 && row < m_rows; }
+    // 坐标所在单元，栅格外返回-1
+    int cellIndex(float x, float y) const;
+    QPointF cellCenter(int index) const;
+
+    float height(int index) const { return m_height[index]; }
+    bool isValid(int index) const { return m_valid[index] != 0; }
+    void setHeight(int index, float height) { m_height[index] = height; m_valid[index] = 1; }
+    void invalidate(int index) { m_valid[index] = 0; }
+
+    QVector<float>& heights() { return m_height; }
+    const QVector<float>& heights() const { return m_height; }
+    QVector<quint8>& validMask() { return m_valid; }
+    const QVector<quint8>& validMask() const { return m_valid; }
+
+    // 有效单元的高度范围，无有效单元时返回false
+    bool heightRange(float *minHeight, float *maxHeight, int *maxIndex = nullptr, int *minIndex = nullptr) const;
+
+    // 导出有效单元中心点（按scale缩放），供点云视图使用
+    QVector<QVector3D> toPoints(float scale = 1.0f) const;
+
+private:
+    float m_originX;
+    float m_originY;
+    float m_cellSize;
+    int m_cols;
+    int m_rows;
+
+    QVector<float> m_height;
+    QVector<quint8> m_valid;
+};
+
+#endif // HEIGHTGRID_H
@@ -0,0 +1,210 @@
+#include "HoleFiller.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// 金字塔的一级
+struct Level {
+    int cols = 0;
+    int rows = 0;
+    QVector<float> value;
+    QVector<float> weight;
+};
+
+} // namespace
+
+HoleFiller::HoleFiller()
+    : m_maxDistance(1.5f)
+{
+}
+
+void HoleFiller::distanceToValid(const HeightGrid &grid, QVector<float> &distance)
+{
+    const int cols = grid.cols();
+    const int rows = grid.rows();
+    const float far = std::numeric_limits<float>::max() / 2;
+    const quint8 *valid = grid.validMask().constData();
+
+    distance.resize(cols * rows);
+    float *d = distance.data();
+    for (int i = 0; i < cols * rows; ++i) {
+        d[i] = valid[i] ? 0.0f : far;
+    }
+
+    // 正向：左、上、左上、右上
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            float &v = d[row * cols + col];
+            if (col > 0) v = std::min(v, d[row * cols + col - 1] + 3.0f);
+            if (row > 0) {
+                v = std::min(v, d[(row - 1) * cols + col] + 3.0f);
+                if (col > 0) v = std::min(v, d[(row - 1) * cols + col - 1] + 4.0f);
+                if (col + 1 < cols) v = std::min(v, d[(row - 1) * cols + col + 1] + 4.0f);
+            }
+        }
+    }
+    // 反向：右、下、右下、左下
+    for (int row = rows - 1; row >= 0; --row) {
+        for (int col = cols - 1; col >= 0; --col) {
+            float &v = d[row * cols + col];
+            if (col + 1 < cols) v = std::min(v, d[row * cols + col + 1] + 3.0f);
+            if (row + 1 < rows) {
+                v = std::min(v, d[(row + 1) * cols + col] + 3.0f);
+                if (col + 1 < cols) v = std::min(v, d[(row + 1) * cols + col + 1] + 4.0f);
+                if (col > 0) v = std::min(v, d[(row + 1) * cols + col - 1] + 4.0f);
+            }
+        }
+    }
+
+    // 倒角距离按3为单位长度
+    for (int i = 0; i < cols * rows; ++i) {
+        d[i] /= 3.0f;
+    }
+}
+
+int HoleFiller::fill(const HeightGrid &grid, const QVector<quint8> &regionMask,
+                     HeightGrid &out, QVector<quint8> &filled, QVector<int> *changed) const
+{
+    const int cols = grid.cols();
+    const int rows = grid.rows();
+    const int n = cols * rows;
+
+    // 与上一次结果逐单元比较，只报告插值有变化的单元；否则整幅重建
+    const bool incremental = changed && out.cellCount() == n && filled.size() == n;
+    if (changed) {
+        changed->clear();
+    }
+    if (!incremental) {
+        out = grid;
+        filled.fill(0, n);
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    const float *h = grid.heights().constData();
+    const quint8 *valid = grid.validMask().constData();
+
+    // 1. push：逐级2x2加权下采样，直到1x1
+    QVector<Level> levels(1);
+    levels[0].cols = cols;
+    levels[0].rows = rows;
+    levels[0].value.resize(n);
+    levels[0].weight.resize(n);
+    for (int i = 0; i < n; ++i) {
+        levels[0].value[i] = valid[i] ? h[i] : 0.0f;
+        levels[0].weight[i] = valid[i] ? 1.0f : 0.0f;
+    }
+
+    while (levels.last().cols > 1 || levels.last().rows > 1) {
+        const Level &fine = levels.last();
+        Level coarse;
+        coarse.cols = (fine.cols + 1) / 2;
+        coarse.rows = (fine.rows + 1) / 2;
+        coarse.value.resize(coarse.cols * coarse.rows);
+        coarse.weight.resize(coarse.cols * coarse.rows);
+
+        const float *fv = fine.value.constData();
+        const float *fw = fine.weight.constData();
+        float *cv = coarse.value.data();
+        float *cw = coarse.weight.data();
+        parallelFor(coarse.rows, [&](int begin, int end) {
+            for (int row = begin; row < end; ++row) {
+                for (int col = 0; col < coarse.cols; ++col) {
+                    float sumV = 0.0f;
+                    float sumW = 0.0f;
+                    for (int dy = 0; dy < 2; ++dy) {
+                        const int r = 2 * row + dy;
+                        if (r >= fine.rows) continue;
+                        for (int dx = 0; dx < 2; ++dx) {
+                            const int c = 2 * col + dx;
+                            if (c >= fine.cols) continue;
+                            const int i = r * fine.cols + c;
+                            sumV += fv[i] * fw[i];
+                            sumW += fw[i];
+                        }
+                    }
+                    const int j = row * coarse.cols + col;
+                    cv[j] = sumW > 0.0f ? sumV / sumW : 0.0f;
+                    cw[j] = std::min(sumW, 1.0f);
+                }
+            }
+        });
+        levels.append(coarse);
+    }
+
+    // 整个栅格都没有实测数据
+    if (levels.last().weight[0] <= 0.0f) {
+        return 0;
+    }
+
+    // 2. pull：由粗到细，权重不足的单元与上一级双线性插值混合
+    for (int level = levels.size() - 2; level >= 0; --level) {
+        Level &fine = levels[level];
+        const Level &coarse = levels[level + 1];
+        const float *cv = coarse.value.constData();
+        float *fv = fine.value.data();
+        const float *fw = fine.weight.constData();
+
+        parallelFor(fine.rows, [&](int begin, int end) {
+            for (int row = begin; row < end; ++row) {
+                // 细单元中心在粗一级中的坐标
+                const float y = qBound(0.0f, (row + 0.5f) * 0.5f - 0.5f, coarse.rows - 1.0f);
+                const int y0 = static_cast<int>(y);
+                const int y1 = std::min(y0 + 1, coarse.rows - 1);
+                const float ty = y - y0;
+                for (int col = 0; col < fine.cols; ++col) {
+                    const int i = row * fine.cols + col;
+                    const float w = fw[i];
+                    if (w >= 1.0f) {
+                        continue;
+                    }
+                    const float x = qBound(0.0f, (col + 0.5f) * 0.5f - 0.5f, coarse.cols - 1.0f);
+                    const int x0 = static_cast<int>(x);
+                    const int x1 = std::min(x0 + 1, coarse.cols - 1);
+                    const float tx = x - x0;
+                    const float top = cv[y0 * coarse.cols + x0] * (1.0f - tx) + cv[y0 * coarse.cols + x1] * tx;
+                    const float bottom = cv[y1 * coarse.cols + x0] * (1.0f - tx) + cv[y1 * coarse.cols + x1] * tx;
+                    const float interpolated = top * (1.0f - ty) + bottom * ty;
+                    fv[i] = w * fv[i] + (1.0f - w) * interpolated;
+                }
+            }
+        });
+    }
+
+    // 3. 只写回区域内、距实测单元足够近的空洞
+    QVector<float> distance;
+    distanceToValid(grid, distance);
+    const float maxCells = m_maxDistance / grid.cellSize();
+    const bool useMask = regionMask.size() == n;
+    const float *result = levels[0].value.constData();
+
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        if (valid[i] || distance[i] > maxCells || (useMask && !regionMask[i])) {
+            if (incremental) {
+                // 实测单元的变化由融合结果给出，这里只处理插值标记被取消的单元
+                if (filled[i]) {
+                    filled[i] = 0;
+                    changed->append(i);
+                }
+                if (valid[i]) {
+                    out.setHeight(i, h[i]);
+                } else {
+                    out.invalidate(i);
+                }
+            }
+            continue;
+        }
+        if (incremental && (!filled[i] || out.height(i) != result[i])) {
+            changed->append(i);
+        }
+        out.setHeight(i, result[i]);
+        filled[i] = 1;
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,33 @@
+#ifndef HOLEFILLER_H
+#define HOLEFILLER_H
+
+#include "HeightGrid.h"
+
+#include <QVector>
+
+// 雷达阴影区补洞：金字塔push-pull插值
+// 逐级2x2加权下采样（push），再由粗到细双线性回填缺失单元（pull），总耗时与栅格大小成线性
+// 只填充距实测单元不超过设定距离的空洞，远处的大片盲区保持无效
+class HoleFiller
+{
+public:
+    HoleFiller();
+
+    // 最大填充距离（米）
+    void setMaxDistance(float distance) { m_maxDistance = qMax(0.0f, distance); }
+    float maxDistance() const { return m_maxDistance; }
+
+    // regionMask非空时只填充掩码为1的单元（渣池区域内）
+    // out为补洞后的栅格，filled标记插值得到的单元，返回填充的单元数
+    // changed非空且out、filled为同一栅格上一次的结果时，输出插值标记或插值高度有变化的单元
+    int fill(const HeightGrid &grid, const QVector<quint8> &regionMask,
+             HeightGrid &out, QVector<quint8> &filled, QVector<int> *changed = nullptr) const;
+
+private:
+    // 到最近实测单元的距离（单元数，3-4倒角距离两遍扫描）
+    static void distanceToValid(const HeightGrid &grid, QVector<float> &distance);
+
+    float m_maxDistance;
+};
+
+#endif // HOLEFILLER_H
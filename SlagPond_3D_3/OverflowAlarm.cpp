@@ -0,0 +1,78 @@
+#include "OverflowAlarm.h"
+
+#include <QSettings>
+
+OverflowAlarm::OverflowAlarm()
+    : m_heightWarning(8.0f)
+    , m_heightOverflow(10.0f)
+    , m_volumeWarning(0.0f)
+    , m_volumeOverflow(0.0f)
+    , m_heightHysteresis(0.2f)
+    , m_volumeHysteresis(0.05f)
+{
+    setPondCount(1);
+}
+
+void OverflowAlarm::setPondCount(int count)
+{
+    m_state.fill(PondAlarm(), qMax(1, count));
+}
+
+void OverflowAlarm::loadSettings(QSettings &settings)
+{
+    settings.beginGroup("alarm");
+    m_heightWarning = settings.value("heightWarning", m_heightWarning).toFloat();
+    m_heightOverflow = settings.value("heightOverflow", m_heightOverflow).toFloat();
+    m_volumeWarning = settings.value("volumeWarning", m_volumeWarning).toFloat();
+    m_volumeOverflow = settings.value("volumeOverflow", m_volumeOverflow).toFloat();
+    m_heightHysteresis = settings.value("heightHysteresis", m_heightHysteresis).toFloat();
+    m_volumeHysteresis = settings.value("volumeHysteresis", m_volumeHysteresis).toFloat();
+    settings.endGroup();
+}
+
+AlarmLevel OverflowAlarm::step(AlarmLevel current, float value, float warning, float overflow,
+                               float hysteresisWarning, float hysteresisOverflow)
+{
+    // 上升
+    if (overflow > 0.0f && value >= overflow) {
+        return AlarmOverflow;
+    }
+    if (warning > 0.0f && value >= warning && current < AlarmWarning) {
+        return AlarmWarning;
+    }
+
+    // 下降
+    if (current == AlarmOverflow && (overflow <= 0.0f || value < overflow - hysteresisOverflow)) {
+        current = AlarmWarning;   // 是否继续降到正常由下面的预警回差判断
+    }
+    if (current == AlarmWarning && (warning <= 0.0f || value < warning - hysteresisWarning)) {
+        current = AlarmNormal;
+    }
+    return current;
+}
+
+bool OverflowAlarm::evaluate(int pond, float height, float volume)
+{
+    PondAlarm &state = m_state[pond];
+
+    state.heightLevel = step(state.heightLevel, height, m_heightWarning, m_heightOverflow,
+                             m_heightHysteresis, m_heightHysteresis);
+    state.volumeLevel = step(state.volumeLevel, volume, m_volumeWarning, m_volumeOverflow,
+                             m_volumeWarning * m_volumeHysteresis, m_volumeOverflow * m_volumeHysteresis);
+
+    const AlarmLevel level = qMax(state.heightLevel, state.volumeLevel);
+    if (level == state.level) {
+        return false;
+    }
+    state.level = level;
+    return true;
+}
+
+QString OverflowAlarm::levelName(AlarmLevel level)
+{
+    switch (level) {
+    case AlarmWarning: return "预警";
+    case AlarmOverflow: return "满池报警";
+    default: return "正常";
+    }
+}
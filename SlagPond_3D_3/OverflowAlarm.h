@@ -0,0 +1,60 @@
+#ifndef OVERFLOWALARM_H
+#define OVERFLOWALARM_H
+
+#include <QVector>
+#include <QString>
+
+class QSettings;
+
+// 报警等级
+enum AlarmLevel {
+    AlarmNormal = 0,    // 正常
+    AlarmWarning = 1,   // 预警
+    AlarmOverflow = 2   // 溢出报警
+};
+
+// 满池报警：按最高点高度和体积两项阈值逐渣池判定，带回差防止在阈值附近反复跳变
+// 只使用融合阶段增量维护的量（最高点、高度和），判定为O(1)，在融合后立即执行
+class OverflowAlarm
+{
+public:
+    OverflowAlarm();
+
+    void setPondCount(int count);
+
+    // 阈值（米 / 立方米），<=0 表示不启用该项
+    void setHeightThresholds(float warning, float overflow) { m_heightWarning = warning; m_heightOverflow = overflow; }
+    void setVolumeThresholds(float warning, float overflow) { m_volumeWarning = warning; m_volumeOverflow = overflow; }
+    // 回差：高度为米，体积为阈值的比例
+    void setHysteresis(float height, float volumeRatio) { m_heightHysteresis = height; m_volumeHysteresis = volumeRatio; }
+
+    // 从配置文件的[alarm]组读取阈值，缺失项保持默认
+    void loadSettings(QSettings &settings);
+
+    // 判定某渣池的当前等级，等级变化时返回true
+    bool evaluate(int pond, float height, float volume);
+
+    AlarmLevel level(int pond) const { return m_state[pond].level; }
+    static QString levelName(AlarmLevel level);
+
+private:
+    // 单项带回差的等级：上升到达阈值即升级，下降需低于阈值减回差才降级
+    static AlarmLevel step(AlarmLevel current, float value, float warning, float overflow, float hysteresisWarning,
+                           float hysteresisOverflow);
+
+    struct PondAlarm {
+        AlarmLevel heightLevel = AlarmNormal;
+        AlarmLevel volumeLevel = AlarmNormal;
+        AlarmLevel level = AlarmNormal;
+    };
+    QVector<PondAlarm> m_state;
+
+    float m_heightWarning;
+    float m_heightOverflow;
+    float m_volumeWarning;
+    float m_volumeOverflow;
+    float m_heightHysteresis;
+    float m_volumeHysteresis;
+};
+
+#endif // OVERFLOWALARM_H
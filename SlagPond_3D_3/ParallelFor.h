@@ -0,0 +1,30 @@
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <QVector>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
+#include <numeric>
+
+// 将[0, count)按连续区段分给线程池并行执行，func(begin, end)
+// 区段数取线程数的若干倍以平衡负载；数据量很小时直接在当前线程执行
+template <typename Func>
+void parallelFor(int count, Func func, int minPerBand = 16)
+{
+    const int threads = qMax(1, QThread::idealThreadCount());
+    const int bandCount = qMin(threads * 4, count / qMax(1, minPerBand));
+    if (bandCount <= 1) {
+        func(0, count);
+        return;
+    }
+
+    QVector<int> bands(bandCount);
+    std::iota(bands.begin(), bands.end(), 0);
+    QtConcurrent::blockingMap(bands, [&](int band) {
+        const int begin = static_cast<int>(static_cast<qint64>(count) * band / bandCount);
+        const int end = static_cast<int>(static_cast<qint64>(count) * (band + 1) / bandCount);
+        func(begin, end);
+    });
+}
+
+#endif // PARALLELFOR_H
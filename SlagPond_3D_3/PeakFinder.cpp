@@ -0,0 +1,122 @@
+#include "PeakFinder.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// 一维滑动窗口最大值（窗口半径radius），src/dst按stride跨步访问
+void slidingMax(const float *src, float *dst, int count, int stride, int radius, int *queue)
+{
+    // queue保存下标，对应值单调递减
+    int head = 0;
+    int tail = 0;
+    int next = 0;
+    for (int i = 0; i < count; ++i) {
+        const int right = qMin(count - 1, i + radius);
+        for (; next <= right; ++next) {
+            const float v = src[next * stride];
+            while (tail > head && src[queue[tail - 1] * stride] <= v) {
+                --tail;
+            }
+            queue[tail++] = next;
+        }
+        while (queue[head] < i - radius) {
+            ++head;
+        }
+        dst[i * stride] = src[queue[head] * stride];
+    }
+}
+
+} // namespace
+
+PeakFinder::PeakFinder()
+    : m_minSeparation(2.0f)
+    , m_maxPeaks(5)
+    , m_minHeight(-std::numeric_limits<float>::infinity())
+{
+}
+
+QVector<Peak> PeakFinder::find(const HeightGrid &grid) const
+{
+    QVector<Peak> peaks;
+    const int cols = grid.cols();
+    const int rows = grid.rows();
+    const int n = cols * rows;
+    if (n == 0) {
+        return peaks;
+    }
+
+    const int radius = qMax(1, static_cast<int>(std::ceil(m_minSeparation / grid.cellSize())));
+    const float *h = grid.heights().constData();
+    const quint8 *valid = grid.validMask().constData();
+    const float lowest = -std::numeric_limits<float>::infinity();
+
+    // 1. 无效单元置为负无穷
+    QVector<float> source(n);
+    float *src = source.data();
+    parallelFor(rows, [&](int begin, int end) {
+        for (int i = begin * cols; i < end * cols; ++i) {
+            src[i] = valid[i] ? h[i] : lowest;
+        }
+    });
+
+    // 2. 行方向、列方向两遍滑动最大值
+    QVector<float> rowMax(n);
+    QVector<float> dilated(n);
+    float *rm = rowMax.data();
+    float *dl = dilated.data();
+
+    parallelFor(rows, [&](int begin, int end) {
+        QVector<int> queue(cols);
+        for (int row = begin; row < end; ++row) {
+            slidingMax(src + row * cols, rm + row * cols, cols, 1, radius, queue.data());
+        }
+    });
+    parallelFor(cols, [&](int begin, int end) {
+        QVector<int> queue(rows);
+        for (int col = begin; col < end; ++col) {
+            slidingMax(rm + col, dl + col, rows, cols, radius, queue.data());
+        }
+    });
+
+    // 3. 等于邻域最大值的有效单元为候选峰
+    QVector<Peak> candidates;
+    for (int i = 0; i < n; ++i) {
+        if (valid[i] && src[i] == dl[i] && src[i] >= m_minHeight) {
+            Peak peak;
+            peak.index = i;
+            peak.height = src[i];
+            candidates.append(peak);
+        }
+    }
+
+    // 4. 按高度建堆依次弹出；平台上等高的相邻候选按最小间距再筛一次
+    auto lower = [](const Peak &a, const Peak &b) { return a.height < b.height; };
+    std::make_heap(candidates.begin(), candidates.end(), lower);
+
+    const float minDistance2 = m_minSeparation * m_minSeparation;
+    auto end = candidates.end();
+    while (end != candidates.begin() && peaks.size() < m_maxPeaks) {
+        std::pop_heap(candidates.begin(), end, lower);
+        --end;
+        Peak peak = *end;
+        peak.position = grid.cellCenter(peak.index);
+
+        bool separated = true;
+        for (const Peak &accepted : peaks) {
+            const QPointF d = accepted.position - peak.position;
+            if (d.x() * d.x() + d.y() * d.y() < minDistance2) {
+                separated = false;
+                break;
+            }
+        }
+        if (separated) {
+            peaks.append(peak);
+        }
+    }
+
+    return peaks;
+}
@@ -0,0 +1,42 @@
+#ifndef PEAKFINDER_H
+#define PEAKFINDER_H
+
+#include "HeightGrid.h"
+
+#include <QVector>
+#include <QPointF>
+
+// 料堆峰值点
+struct Peak {
+    int index = -1;        // 栅格单元
+    QPointF position;      // 渣池坐标（米）
+    float height = 0.0f;
+};
+
+// 峰值检测：窗口最大值滤波做非极大值抑制，再用堆按高度取前K个
+// 最大值滤波可分离为行、列两遍滑动窗口（单调队列，O(n)），按行/列分块并行
+class PeakFinder
+{
+public:
+    PeakFinder();
+
+    // 峰值之间的最小间距（米）
+    void setMinSeparation(float separation) { m_minSeparation = qMax(0.0f, separation); }
+    float minSeparation() const { return m_minSeparation; }
+
+    void setMaxPeaks(int count) { m_maxPeaks = qMax(1, count); }
+    int maxPeaks() const { return m_maxPeaks; }
+
+    // 低于该高度的峰忽略（如水面）
+    void setMinHeight(float height) { m_minHeight = height; }
+
+    // 按高度降序返回峰值
+    QVector<Peak> find(const HeightGrid &grid) const;
+
+private:
+    float m_minSeparation;
+    int m_maxPeaks;
+    float m_minHeight;
+};
+
+#endif // PEAKFINDER_H
@@ -0,0 +1,140 @@
+#include "PickBuffer.h"
+
+#include <QOpenGLContext>
+#include <QDebug>
+#include <cstring>
+
+bool PickBuffer::create()
+{
+    if (m_fbo) {
+        return true;
+    }
+    m_gl = QOpenGLContext::currentContext()->extraFunctions();
+
+    GLint previousFbo = 0;
+    m_gl->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFbo);
+
+    m_gl->glGenRenderbuffers(1, &m_idRenderbuffer);
+    m_gl->glBindRenderbuffer(GL_RENDERBUFFER, m_idRenderbuffer);
+    m_gl->glRenderbufferStorage(GL_RENDERBUFFER, GL_R32UI, SIZE, SIZE);
+    m_gl->glGenRenderbuffers(1, &m_depthRenderbuffer);
+    m_gl->glBindRenderbuffer(GL_RENDERBUFFER, m_depthRenderbuffer);
+    m_gl->glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, SIZE, SIZE);
+    m_gl->glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    m_gl->glGenFramebuffers(1, &m_fbo);
+    m_gl->glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    m_gl->glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_idRenderbuffer);
+    m_gl->glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthRenderbuffer);
+    const GLenum status = m_gl->glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    m_gl->glBindFramebuffer(GL_FRAMEBUFFER, previousFbo);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        qDebug() << "拾取帧缓冲区不完整:" << Qt::hex << status;
+        destroy();
+        return false;
+    }
+
+    // ID和深度读回到同一个像素缓冲区的前后两半
+    m_gl->glGenBuffers(1, &m_pbo);
+    m_gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+    m_gl->glBufferData(GL_PIXEL_PACK_BUFFER, 2 * SIZE * SIZE * 4, nullptr, GL_STREAM_READ);
+    m_gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+void PickBuffer::destroy()
+{
+    if (!m_gl) {
+        return;
+    }
+    if (m_fence) {
+        m_gl->glDeleteSync(m_fence);
+        m_fence = nullptr;
+    }
+    if (m_pbo) {
+        m_gl->glDeleteBuffers(1, &m_pbo);
+        m_pbo = 0;
+    }
+    if (m_fbo) {
+        m_gl->glDeleteFramebuffers(1, &m_fbo);
+        m_fbo = 0;
+    }
+    if (m_idRenderbuffer) {
+        m_gl->glDeleteRenderbuffers(1, &m_idRenderbuffer);
+        m_idRenderbuffer = 0;
+    }
+    if (m_depthRenderbuffer) {
+        m_gl->glDeleteRenderbuffers(1, &m_depthRenderbuffer);
+        m_depthRenderbuffer = 0;
+    }
+}
+
+bool PickBuffer::begin()
+{
+    if (!m_fbo || m_fence) {
+        return false;
+    }
+
+    // QOpenGLWidget绘制时默认帧缓冲区不是0，记下后在end中恢复
+    m_gl->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_previousFbo);
+    m_gl->glGetIntegerv(GL_VIEWPORT, m_previousViewport);
+
+    m_gl->glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    m_gl->glViewport(0, 0, SIZE, SIZE);
+    m_gl->glDisable(GL_SCISSOR_TEST);
+    m_gl->glDisable(GL_BLEND);
+    m_gl->glEnable(GL_DEPTH_TEST);
+    m_gl->glDepthMask(GL_TRUE);
+
+    const GLuint zero[4] = {0, 0, 0, 0};
+    m_gl->glClearBufferuiv(GL_COLOR, 0, zero);
+    m_gl->glClear(GL_DEPTH_BUFFER_BIT);
+    return true;
+}
+
+void PickBuffer::end()
+{
+    // 读到像素缓冲区，glReadPixels立即返回；栅栏完成后再映射
+    m_gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+    m_gl->glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    m_gl->glReadBuffer(GL_COLOR_ATTACHMENT0);
+    m_gl->glReadPixels(0, 0, SIZE, SIZE, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    m_gl->glReadPixels(0, 0, SIZE, SIZE, GL_DEPTH_COMPONENT, GL_FLOAT,
+                       reinterpret_cast<void*>(static_cast<quintptr>(SIZE * SIZE * 4)));
+    m_gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_fence = m_gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_gl->glBindFramebuffer(GL_FRAMEBUFFER, m_previousFbo);
+    m_gl->glViewport(m_previousViewport[0], m_previousViewport[1], m_previousViewport[2], m_previousViewport[3]);
+}
+
+bool PickBuffer::poll(QVector<quint32> *ids, QVector<float> *depths)
+{
+    if (!m_fence) {
+        return false;
+    }
+    const GLenum status = m_gl->glClientWaitSync(m_fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    m_gl->glDeleteSync(m_fence);
+    m_fence = nullptr;
+    if (status == GL_WAIT_FAILED) {
+        qDebug() << "拾取读回栅栏等待失败";
+        return false;
+    }
+
+    const int count = SIZE * SIZE;
+    ids->resize(count);
+    depths->resize(count);
+    m_gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+    const void *ptr = m_gl->glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 2 * count * 4, GL_MAP_READ_BIT);
+    if (ptr) {
+        std::memcpy(ids->data(), ptr, count * 4);
+        std::memcpy(depths->data(), static_cast<const char*>(ptr) + count * 4, count * 4);
+        m_gl->glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    m_gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return ptr != nullptr;
+}
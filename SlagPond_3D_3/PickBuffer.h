@@ -0,0 +1,58 @@
+#ifndef PICKBUFFER_H
+#define PICKBUFFER_H
+
+#include <QOpenGLExtraFunctions>
+#include <QVector>
+#include <QVector3D>
+
+// 拾取结果
+struct PickResult {
+    enum Kind {
+        None,
+        Point,          // 点集中的点，index为点序号（八叉树显示时点已重排，为-1）
+        HeightCell,     // 高度场单元，index为单元序号（行 * 列数 + 列）
+        SurfaceVertex   // 三角网格顶点，index为顶点序号
+    };
+    Kind kind = None;
+    int index = -1;
+    QVector3D position;   // 渣池坐标系（米）
+};
+
+// ID缓冲区拾取：把对象序号绘制到小尺寸整数帧缓冲区（R32UI + 深度），
+// 只覆盖光标周围SIZE x SIZE像素；结果经像素缓冲区异步读回，栅栏完成后再取，不阻塞当前帧
+// ID编码：高4位为对象类型（PickResult::Kind），低28位为序号 + 1，0表示无对象
+// 需在OpenGL上下文当前时使用
+class PickBuffer
+{
+public:
+    static const int SIZE = 9;
+
+    static quint32 encode(PickResult::Kind kind, int index) { return (static_cast<quint32>(kind) << 28) + static_cast<quint32>(index) + 1; }
+    static PickResult::Kind kind(quint32 id) { return static_cast<PickResult::Kind>(id >> 28); }
+    static int index(quint32 id) { return static_cast<int>(id & 0x0fffffff) - 1; }
+
+    bool create();
+    void destroy();
+    bool isCreated() const { return m_fbo != 0; }
+
+    // 绑定ID帧缓冲区并清空，返回false表示上一次读回尚未完成
+    bool begin();
+    // 发起异步读回并恢复之前的帧缓冲区和视口
+    void end();
+
+    bool isPending() const { return m_fence != nullptr; }
+    // 读回完成时取出ID和深度（各SIZE * SIZE个，行优先、自下而上），未完成返回false
+    bool poll(QVector<quint32> *ids, QVector<float> *depths);
+
+private:
+    QOpenGLExtraFunctions *m_gl = nullptr;
+    GLuint m_fbo = 0;
+    GLuint m_idRenderbuffer = 0;
+    GLuint m_depthRenderbuffer = 0;
+    GLuint m_pbo = 0;
+    GLsync m_fence = nullptr;
+    GLint m_previousFbo = 0;
+    GLint m_previousViewport[4] = {0, 0, 0, 0};
+};
+
+#endif // PICKBUFFER_H
@@ -0,0 +1,374 @@
+#include "PointCloudRegistration.h"
+#include "ParallelFor.h"
+
+#include <QMutex>
+#include <QDebug>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// ---------------- KdTree ----------------
+
+void KdTree::build(const QVector<QVector3D> &points)
+{
+    m_points = points;
+    m_nodes.clear();
+    m_nodes.reserve(points.size());
+
+    QVector<int> indices(points.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    m_root = buildRecursive(indices.data(), indices.size(), 0);
+}
+
+int KdTree::buildRecursive(int *indices, int count, int depth)
+{
+    if (count <= 0) {
+        return -1;
+    }
+
+    // 按当前深度轮换切分轴，取中位数保证树平衡
+    const int axis = depth % 3;
+    const int mid = count / 2;
+    std::nth_element(indices, indices + mid, indices + count, [&](int a, int b) {
+        return m_points[a][axis] < m_points[b][axis];
+    });
+
+    const int node = m_nodes.size();
+    m_nodes.append({indices[mid], -1, -1, axis});
+
+    const int left = buildRecursive(indices, mid, depth + 1);
+    const int right = buildRecursive(indices + mid + 1, count - mid - 1, depth + 1);
+    m_nodes[node].left = left;
+    m_nodes[node].right = right;
+    return node;
+}
+
+int KdTree::nearest(const QVector3D &query, float maxDistance, float *distance2) const
+{
+    int best = -1;
+    float bestDistance2 = maxDistance * maxDistance;
+    searchNearest(m_root, query, best, bestDistance2);
+    if (best >= 0 && distance2) {
+        *distance2 = bestDistance2;
+    }
+    return best;
+}
+
+void KdTree::searchNearest(int node, const QVector3D &query, int &best, float &bestDistance2) const
+{
+    if (node < 0) {
+        return;
+    }
+
+    const Node &n = m_nodes[node];
+    const QVector3D &p = m_points[n.point];
+    const float d2 = (p - query).lengthSquared();
+    if (d2 < bestDistance2) {
+        bestDistance2 = d2;
+        best = n.point;
+    }
+
+    const float diff = query[n.axis] - p[n.axis];
+    const int nearSide = diff < 0.0f ? n.left : n.right;
+    const int farSide = diff < 0.0f ? n.right : n.left;
+    searchNearest(nearSide, query, best, bestDistance2);
+    if (diff * diff < bestDistance2) {
+        searchNearest(farSide, query, best, bestDistance2);
+    }
+}
+
+int KdTree::kNearest(const QVector3D &query, int k, int *out, float *outDistance2) const
+{
+    int found = 0;
+    searchKNearest(m_root, query, k, out, outDistance2, found);
+    return found;
+}
+
+void KdTree::searchKNearest(int node, const QVector3D &query, int k, int *out, float *outDistance2, int &found) const
+{
+    if (node < 0) {
+        return;
+    }
+
+    const Node &n = m_nodes[node];
+    const QVector3D &p = m_points[n.point];
+    const float d2 = (p - query).lengthSquared();
+
+    // out按距离升序保存，k很小时插入排序即可
+    if (found < k || d2 < outDistance2[found - 1]) {
+        int pos = found < k ? found++ : k - 1;
+        while (pos > 0 && outDistance2[pos - 1] > d2) {
+            out[pos] = out[pos - 1];
+            outDistance2[pos] = outDistance2[pos - 1];
+            --pos;
+        }
+        out[pos] = n.point;
+        outDistance2[pos] = d2;
+    }
+
+    const float diff = query[n.axis] - p[n.axis];
+    const int nearSide = diff < 0.0f ? n.left : n.right;
+    const int farSide = diff < 0.0f ? n.right : n.left;
+    searchKNearest(nearSide, query, k, out, outDistance2, found);
+    if (found < k || diff * diff < outDistance2[found - 1]) {
+        searchKNearest(farSide, query, k, out, outDistance2, found);
+    }
+}
+
+// ---------------- 数值工具 ----------------
+
+namespace {
+
+// 对称3x3矩阵的最小特征值对应的特征向量（Jacobi旋转）
+QVector3D smallestEigenvector(double a[3][3])
+{
+    double v[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+
+    for (int sweep = 0; sweep < 16; ++sweep) {
+        const double off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+        if (off < 1e-18) {
+            break;
+        }
+        for (int p = 0; p < 2; ++p) {
+            for (int q = p + 1; q < 3; ++q) {
+                if (std::fabs(a[p][q]) < 1e-15) {
+                    continue;
+                }
+                const double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                const double t = (theta >= 0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+                const double c = 1.0 / std::sqrt(t * t + 1.0);
+                const double s = t * c;
+
+                for (int k = 0; k < 3; ++k) {
+                    const double akp = a[k][p];
+                    const double akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    const double apk = a[p][k];
+                    const double aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    const double vkp = v[k][p];
+                    const double vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    int smallest = 0;
+    for (int i = 1; i < 3; ++i) {
+        if (a[i][i] < a[smallest][smallest]) {
+            smallest = i;
+        }
+    }
+    return QVector3D(v[0][smallest], v[1][smallest], v[2][smallest]).normalized();
+}
+
+// 6x6线性方程组（列主元高斯消元），奇异时返回false
+bool solve6(double A[6][6], double b[6], double x[6])
+{
+    for (int col = 0; col < 6; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < 6; ++row) {
+            if (std::fabs(A[row][col]) > std::fabs(A[pivot][col])) {
+                pivot = row;
+            }
+        }
+        if (std::fabs(A[pivot][col]) < 1e-12) {
+            return false;
+        }
+        if (pivot != col) {
+            std::swap(A[pivot], A[col]);
+            std::swap(b[pivot], b[col]);
+        }
+        for (int row = col + 1; row < 6; ++row) {
+            const double f = A[row][col] / A[col][col];
+            for (int k = col; k < 6; ++k) {
+                A[row][k] -= f * A[col][k];
+            }
+            b[row] -= f * b[col];
+        }
+    }
+    for (int row = 5; row >= 0; --row) {
+        double sum = b[row];
+        for (int k = row + 1; k < 6; ++k) {
+            sum -= A[row][k] * x[k];
+        }
+        x[row] = sum / A[row][row];
+    }
+    return true;
+}
+
+// 点到平面误差的法方程 AᵀA·x = Aᵀb 的累加量
+struct NormalEquations {
+    double ata[6][6] = {};
+    double atb[6] = {};
+    double error2 = 0.0;
+    int count = 0;
+
+    void add(const QVector3D &p, const QVector3D &q, const QVector3D &n)
+    {
+        const QVector3D c = QVector3D::crossProduct(p, n);
+        const double row[6] = {c.x(), c.y(), c.z(), n.x(), n.y(), n.z()};
+        const double r = QVector3D::dotProduct(q - p, n);
+        for (int i = 0; i < 6; ++i) {
+            for (int j = i; j < 6; ++j) {
+                ata[i][j] += row[i] * row[j];
+            }
+            atb[i] += row[i] * r;
+        }
+        error2 += r * r;
+        count++;
+    }
+
+    void merge(const NormalEquations &other)
+    {
+        for (int i = 0; i < 6; ++i) {
+            for (int j = i; j < 6; ++j) {
+                ata[i][j] += other.ata[i][j];
+            }
+            atb[i] += other.atb[i];
+        }
+        error2 += other.error2;
+        count += other.count;
+    }
+};
+
+} // namespace
+
+// ---------------- IcpRegistration ----------------
+
+IcpRegistration::IcpRegistration()
+    : m_maxIterations(50)
+    , m_maxDistance(1.0f)
+    , m_tolerance(1e-5f)
+{
+}
+
+QVector<QVector3D> IcpRegistration::estimateNormals(const KdTree &tree, int k)
+{
+    k = qBound(3, k, 32);
+    QVector<QVector3D> normals(tree.size());
+
+    parallelFor(tree.size(), [&](int begin, int end) {
+        int neighbours[32];
+        float distance2[32];
+        for (int i = begin; i < end; ++i) {
+            const int found = tree.kNearest(tree.point(i), k, neighbours, distance2);
+            if (found < 3) {
+                normals[i] = QVector3D(0.0f, 0.0f, 1.0f);
+                continue;
+            }
+
+            QVector3D mean;
+            for (int j = 0; j < found; ++j) {
+                mean += tree.point(neighbours[j]);
+            }
+            mean /= found;
+
+            double cov[3][3] = {};
+            for (int j = 0; j < found; ++j) {
+                const QVector3D d = tree.point(neighbours[j]) - mean;
+                for (int r = 0; r < 3; ++r) {
+                    for (int c = 0; c < 3; ++c) {
+                        cov[r][c] += d[r] * d[c];
+                    }
+                }
+            }
+
+            // 雷达自上向下观测，法向量统一朝上
+            QVector3D normal = smallestEigenvector(cov);
+            if (normal.z() < 0.0f) {
+                normal = -normal;
+            }
+            normals[i] = normal;
+        }
+    }, 256);
+
+    return normals;
+}
+
+IcpResult IcpRegistration::align(const QVector<QVector3D> &source, const QVector<QVector3D> &target,
+                                 const QMatrix4x4 &initial) const
+{
+    IcpResult result;
+    result.transform = initial;
+    if (source.isEmpty() || target.size() < 3) {
+        return result;
+    }
+
+    KdTree tree;
+    tree.build(target);
+    const QVector<QVector3D> normals = estimateNormals(tree);
+
+    const float maxDistance = m_maxDistance;
+
+    for (int iter = 0; iter < m_maxIterations; ++iter) {
+        result.iterations = iter + 1;
+
+        // 1. 变换源点云，并行查找对应点、累加法方程
+        NormalEquations total;
+        QMutex mutex;
+        const QMatrix4x4 transform = result.transform;
+
+        parallelFor(source.size(), [&](int begin, int end) {
+            NormalEquations local;
+            for (int i = begin; i < end; ++i) {
+                const QVector3D p = transform.map(source[i]);
+                const int j = tree.nearest(p, maxDistance);
+                if (j >= 0) {
+                    local.add(p, tree.point(j), normals[j]);
+                }
+            }
+            QMutexLocker locker(&mutex);
+            total.merge(local);
+        }, 256);
+
+        result.inliers = total.count;
+        if (total.count < 6) {
+            qDebug() << "ICP对应点不足：" << total.count;
+            return result;
+        }
+        result.rmse = static_cast<float>(std::sqrt(total.error2 / total.count));
+
+        // 2. 求解小角度线性化的增量位姿 [alpha beta gamma tx ty tz]
+        double A[6][6];
+        double b[6];
+        double x[6];
+        for (int i = 0; i < 6; ++i) {
+            for (int j = 0; j < 6; ++j) {
+                A[i][j] = i <= j ? total.ata[i][j] : total.ata[j][i];
+            }
+            b[i] = total.atb[i];
+        }
+        if (!solve6(A, b, x)) {
+            qDebug() << "ICP法方程奇异，点云几何约束不足";
+            return result;
+        }
+
+        QMatrix4x4 delta;
+        delta.translate(x[3], x[4], x[5]);
+        delta.rotate(qRadiansToDegrees(x[2]), 0.0f, 0.0f, 1.0f);
+        delta.rotate(qRadiansToDegrees(x[1]), 0.0f, 1.0f, 0.0f);
+        delta.rotate(qRadiansToDegrees(x[0]), 1.0f, 0.0f, 0.0f);
+        result.transform = delta * result.transform;
+
+        double step = 0.0;
+        for (double v : x) {
+            step = std::max(step, std::fabs(v));
+        }
+        if (step < m_tolerance) {
+            result.converged = true;
+            break;
+        }
+    }
+
+    return result;
+}
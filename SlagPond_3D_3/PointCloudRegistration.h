@@ -0,0 +1,73 @@
+#ifndef POINTCLOUDREGISTRATION_H
+#define POINTCLOUDREGISTRATION_H
+
+#include <QVector>
+#include <QVector3D>
+#include <QMatrix4x4>
+
+// 三维KD树（静态构建），用于最近邻和k近邻查询
+class KdTree
+{
+public:
+    void build(const QVector<QVector3D> &points);
+
+    int size() const { return m_points.size(); }
+    const QVector3D& point(int index) const { return m_points[index]; }
+
+    // 最近邻，maxDistance内无点时返回-1
+    int nearest(const QVector3D &query, float maxDistance, float *distance2 = nullptr) const;
+    // k近邻，按距离升序写入out，返回实际个数
+    int kNearest(const QVector3D &query, int k, int *out, float *outDistance2) const;
+
+private:
+    struct Node {
+        int point;
+        int left;
+        int right;
+        int axis;
+    };
+
+    int buildRecursive(int *indices, int count, int depth);
+    void searchNearest(int node, const QVector3D &query, int &best, float &bestDistance2) const;
+    void searchKNearest(int node, const QVector3D &query, int k, int *out, float *outDistance2, int &found) const;
+
+    QVector<QVector3D> m_points;
+    QVector<Node> m_nodes;
+    int m_root = -1;
+};
+
+// ICP配准结果
+struct IcpResult {
+    QMatrix4x4 transform;   // source -> target
+    int iterations = 0;
+    int inliers = 0;
+    float rmse = 0.0f;
+    bool converged = false;
+};
+
+// 点到平面ICP：用KD树在目标点云中找对应点，目标法向量由k近邻PCA估计
+// 对应点搜索和法方程累加按点分块并行
+class IcpRegistration
+{
+public:
+    IcpRegistration();
+
+    void setMaxIterations(int iterations) { m_maxIterations = iterations; }
+    // 对应点最大距离（米）
+    void setMaxCorrespondenceDistance(float distance) { m_maxDistance = distance; }
+    // 单次增量（弧度/米）小于该值时认为收敛
+    void setTolerance(float tolerance) { m_tolerance = tolerance; }
+
+    IcpResult align(const QVector<QVector3D> &source, const QVector<QVector3D> &target,
+                    const QMatrix4x4 &initial = QMatrix4x4()) const;
+
+    // 由k近邻PCA估计每个点的法向量
+    static QVector<QVector3D> estimateNormals(const KdTree &tree, int k = 8);
+
+private:
+    int m_maxIterations;
+    float m_maxDistance;
+    float m_tolerance;
+};
+
+#endif // POINTCLOUDREGISTRATION_H
@@ -0,0 +1,282 @@
+#include "PointOctree.h"
+#include "ParallelFor.h"
+
+#include <QElapsedTimer>
+#include <QVector4D>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+
+const int MORTON_BITS = 21;
+const int MAX_DEPTH = MORTON_BITS - 1;
+
+// 21位整数的各位间隔两位展开，三轴交织成63位Morton码
+quint64 spreadBits(quint32 value)
+{
+    quint64 x = value & 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffffULL;
+    x = (x | x << 16) & 0x1f0000ff0000ffULL;
+    x = (x | x << 8) & 0x100f00f00f00f00fULL;
+    x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+    x = (x | x << 2) & 0x1249249249249249ULL;
+    return x;
+}
+
+// 第depth层的子节点编号：bit0 = x，bit1 = y，bit2 = z
+inline int childDigit(quint64 code, int depth)
+{
+    return static_cast<int>((code >> (3 * (MAX_DEPTH - depth))) & 7);
+}
+
+// 分块并行排序后两两归并
+template <typename T>
+void parallelSort(QVector<T> &data)
+{
+    const int n = data.size();
+    const int chunks = qMax(1, qMin(QThread::idealThreadCount(), n / 65536));
+    if (chunks <= 1) {
+        std::sort(data.begin(), data.end());
+        return;
+    }
+
+    QVector<int> bounds(chunks + 1);
+    for (int i = 0; i <= chunks; ++i) {
+        bounds[i] = static_cast<int>(static_cast<qint64>(n) * i / chunks);
+    }
+    T *base = data.data();
+    parallelFor(chunks, [&](int begin, int end) {
+        for (int c = begin; c < end; ++c) {
+            std::sort(base + bounds[c], base + bounds[c + 1]);
+        }
+    }, 1);
+
+    for (int width = 1; width < chunks; width *= 2) {
+        const int pairs = (chunks + 2 * width - 1) / (2 * width);
+        parallelFor(pairs, [&](int begin, int end) {
+            for (int p = begin; p < end; ++p) {
+                const int lo = p * 2 * width;
+                const int mid = qMin(lo + width, chunks);
+                const int hi = qMin(lo + 2 * width, chunks);
+                if (mid < hi) {
+                    std::inplace_merge(base + bounds[lo], base + bounds[mid], base + bounds[hi]);
+                }
+            }
+        }, 1);
+    }
+}
+
+} // namespace
+
+void PointOctree::build(const QVector<QVector3D> &points)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    m_nodes.clear();
+    m_pointCount = points.size();
+    if (points.isEmpty()) {
+        return;
+    }
+
+    // 根节点取包围盒外接立方体，略微放大保证最大坐标也落在内部
+    QVector3D boundsMin;
+    QVector3D boundsSize;
+    pointBounds(points.constData(), points.size(), &boundsMin, &boundsSize);
+    const float size = qMax(boundsSize.x(), qMax(boundsSize.y(), boundsSize.z())) * 1.0001f;
+
+    // 1. 并行计算Morton码
+    QVector<Entry> entries(points.size());
+    Entry *e = entries.data();
+    const QVector3D *src = points.constData();
+    const float scale = (1 << MORTON_BITS) / size;
+    const quint32 maxCoord = (1u << MORTON_BITS) - 1;
+    parallelFor(points.size(), [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            const QVector3D q = (src[i] - boundsMin) * scale;
+            const quint32 x = qMin(maxCoord, static_cast<quint32>(qMax(0.0f, q.x())));
+            const quint32 y = qMin(maxCoord, static_cast<quint32>(qMax(0.0f, q.y())));
+            const quint32 z = qMin(maxCoord, static_cast<quint32>(qMax(0.0f, q.z())));
+            e[i].code = spreadBits(x) | (spreadBits(y) << 1) | (spreadBits(z) << 2);
+            e[i].index = i;
+        }
+    }, 4096);
+    const float mortonTime = timer.nsecsElapsed() / 1000000.0f;
+
+    // 2. 并行排序，之后每个节点的点在数组中连续
+    parallelSort(entries);
+    const float sortTime = timer.nsecsElapsed() / 1000000.0f;
+
+    // 3. 自顶向下分层抽样建树，根节点的8个子树并行
+    buildNode(m_nodes, points, std::move(entries), boundsMin, size, 0);
+
+    qDebug() << "八叉树构建完成，点数:" << m_pointCount << "，节点数:" << m_nodes.size()
+             << "，Morton码:" << mortonTime << "ms，排序:" << sortTime - mortonTime
+             << "ms，总用时:" << timer.nsecsElapsed() / 1000000.0f << "ms";
+}
+
+int PointOctree::buildNode(QVector<OctreeNode> &nodes, const QVector<QVector3D> &points, QVector<Entry> entries,
+                           const QVector3D &boundsMin, float size, int depth) const
+{
+    const int count = entries.size();
+    const bool leaf = count <= NODE_POINTS || depth >= MAX_DEPTH;
+
+    // 内部节点按Morton序等间隔抽取约NODE_POINTS个点，空间上近似均匀；其余点按子立方体分组
+    QVector<int> own;
+    std::array<QVector<Entry>, 8> childEntries;
+    if (leaf) {
+        own.reserve(count);
+        for (const Entry &entry : entries) {
+            own.append(entry.index);
+        }
+    } else {
+        const int stride = (count + NODE_POINTS - 1) / NODE_POINTS;
+        own.reserve(count / stride + 1);
+        for (int i = 0; i < count; ++i) {
+            if (i % stride == 0) {
+                own.append(entries[i].index);
+            } else {
+                childEntries[childDigit(entries[i].code, depth)].append(entries[i]);
+            }
+        }
+    }
+    entries = QVector<Entry>();
+
+    OctreeNode node;
+    node.boundsMin = boundsMin;
+    node.size = size;
+    node.depth = depth;
+    node.spacing = size / std::sqrt(static_cast<float>(qMax(1, own.size())));
+    node.points.resize(own.size());
+    const float quantScale = 65535.0f / size;
+    for (int i = 0; i < own.size(); ++i) {
+        const QVector3D q = (points[own[i]] - boundsMin) * quantScale;
+        node.points[i].x = static_cast<quint16>(qBound(0.0f, q.x() + 0.5f, 65535.0f));
+        node.points[i].y = static_cast<quint16>(qBound(0.0f, q.y() + 0.5f, 65535.0f));
+        node.points[i].z = static_cast<quint16>(qBound(0.0f, q.z() + 0.5f, 65535.0f));
+    }
+
+    const int index = nodes.size();
+    nodes.append(std::move(node));
+    if (leaf) {
+        return index;
+    }
+
+    const float half = size * 0.5f;
+    auto childMin = [&](int digit) {
+        return boundsMin + QVector3D((digit & 1) ? half : 0.0f, (digit & 2) ? half : 0.0f, (digit & 4) ? half : 0.0f);
+    };
+
+    if (depth == 0) {
+        // 各子树独立建在局部数组中，完成后拼接并修正子节点下标
+        std::array<QVector<OctreeNode>, 8> subtrees;
+        parallelFor(8, [&](int begin, int end) {
+            for (int digit = begin; digit < end; ++digit) {
+                if (!childEntries[digit].isEmpty()) {
+                    buildNode(subtrees[digit], points, std::move(childEntries[digit]), childMin(digit), half, depth + 1);
+                }
+            }
+        }, 1);
+        for (int digit = 0; digit < 8; ++digit) {
+            if (!subtrees[digit].isEmpty()) {
+                int child;
+                append(nodes, subtrees[digit], &child);
+                nodes[index].children[digit] = child;
+            }
+        }
+    } else {
+        for (int digit = 0; digit < 8; ++digit) {
+            if (!childEntries[digit].isEmpty()) {
+                const int child = buildNode(nodes, points, std::move(childEntries[digit]), childMin(digit), half, depth + 1);
+                nodes[index].children[digit] = child;
+            }
+        }
+    }
+    return index;
+}
+
+void PointOctree::append(QVector<OctreeNode> &nodes, const QVector<OctreeNode> &subtree, int *childIndex)
+{
+    const int offset = nodes.size();
+    *childIndex = offset;
+    for (OctreeNode node : subtree) {
+        for (int &child : node.children) {
+            if (child >= 0) {
+                child += offset;
+            }
+        }
+        nodes.append(std::move(node));
+    }
+}
+
+void PointOctree::select(const QMatrix4x4 &mvp, const QVector3D &eye, float pixelsPerUnit, int pointBudget,
+                         float minPixelSpacing, QVector<int> *out) const
+{
+    out->clear();
+    if (m_nodes.isEmpty()) {
+        return;
+    }
+
+    // 由MVP矩阵提取六个裁剪平面（法向朝内）
+    const QVector4D r0 = mvp.row(0);
+    const QVector4D r1 = mvp.row(1);
+    const QVector4D r2 = mvp.row(2);
+    const QVector4D r3 = mvp.row(3);
+    const QVector4D planes[6] = {r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2};
+
+    auto visible = [&](const OctreeNode &node) {
+        const QVector3D lo = node.boundsMin;
+        const QVector3D hi = node.boundsMax();
+        for (const QVector4D &p : planes) {
+            // 包围盒上沿平面法向最远的角都在外侧，则整体在外
+            const QVector3D corner(p.x() >= 0.0f ? hi.x() : lo.x(),
+                                   p.y() >= 0.0f ? hi.y() : lo.y(),
+                                   p.z() >= 0.0f ? hi.z() : lo.z());
+            if (p.x() * corner.x() + p.y() * corner.y() + p.z() * corner.z() + p.w() < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // 节点到相机的距离（包围球外），用于估算投影尺寸
+    auto distance = [&](const OctreeNode &node) {
+        const QVector3D center = node.boundsMin + QVector3D(node.size, node.size, node.size) * 0.5f;
+        const float radius = node.size * 0.8660254f;
+        return qMax(0.1f, (center - eye).length() - radius);
+    };
+
+    // 投影尺寸越大的节点越优先
+    using Item = std::pair<float, int>;
+    std::priority_queue<Item> queue;
+    if (visible(m_nodes[0])) {
+        queue.push({std::numeric_limits<float>::max(), 0});
+    }
+
+    int used = 0;
+    while (!queue.empty()) {
+        const int index = queue.top().second;
+        queue.pop();
+
+        const OctreeNode &node = m_nodes[index];
+        if (used + node.points.size() > pointBudget) {
+            break;
+        }
+        out->append(index);
+        used += node.points.size();
+
+        // 本节点点间距投影后已小于阈值，不再细化
+        const float d = distance(node);
+        if (node.spacing * pixelsPerUnit / d < minPixelSpacing) {
+            continue;
+        }
+        for (int child : node.children) {
+            if (child >= 0 && visible(m_nodes[child])) {
+                const OctreeNode &c = m_nodes[child];
+                queue.push({c.size * pixelsPerUnit / distance(c), child});
+            }
+        }
+    }
+}
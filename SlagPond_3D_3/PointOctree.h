@@ -0,0 +1,57 @@
+#ifndef POINTOCTREE_H
+#define POINTOCTREE_H
+
+#include "PointUploader.h"
+
+#include <QVector>
+#include <QVector3D>
+#include <QMatrix4x4>
+
+// 八叉树节点：每个点只属于一个节点，内部节点保存其范围内的均匀抽样（粗略层级），
+// 其余点下放到子节点；绘制时父节点与选中的子节点叠加即为更精细的显示
+struct OctreeNode {
+    QVector3D boundsMin;          // 立方体最小角
+    float size = 0.0f;            // 立方体边长
+    int depth = 0;
+    int children[8] = {-1, -1, -1, -1, -1, -1, -1, -1};
+    QVector<PackedPoint> points;  // 相对本节点立方体量化
+    float spacing = 0.0f;         // 本节点点间距估计（米）
+
+    QVector3D boundsMax() const { return boundsMin + QVector3D(size, size, size); }
+};
+
+// 点集LOD八叉树：按Morton码并行排序后自顶向下分层抽样构建，顶层子树并行
+// 每帧按视锥和屏幕空间误差在点数预算内选出要绘制的节点
+class PointOctree
+{
+public:
+    // 每个节点保存的最多点数，也是叶节点拆分的阈值
+    static const int NODE_POINTS = 16384;
+
+    void build(const QVector<QVector3D> &points);
+
+    int nodeCount() const { return m_nodes.size(); }
+    const OctreeNode& node(int index) const { return m_nodes[index]; }
+    int pointCount() const { return m_pointCount; }
+
+    // 视锥内、按投影尺寸从大到小选节点，直到点数预算用完或细节已小于minPixelSpacing像素
+    // pixelsPerUnit = 视口高度 / (2 * tan(fov / 2))，eye为模型坐标系下的相机位置
+    void select(const QMatrix4x4 &mvp, const QVector3D &eye, float pixelsPerUnit, int pointBudget,
+                float minPixelSpacing, QVector<int> *out) const;
+
+private:
+    struct Entry {
+        quint64 code;
+        int index;
+        bool operator<(const Entry &other) const { return code < other.code; }
+    };
+
+    int buildNode(QVector<OctreeNode> &nodes, const QVector<QVector3D> &points, QVector<Entry> entries,
+                  const QVector3D &boundsMin, float size, int depth) const;
+    static void append(QVector<OctreeNode> &nodes, const QVector<OctreeNode> &subtree, int *childIndex);
+
+    QVector<OctreeNode> m_nodes;
+    int m_pointCount = 0;
+};
+
+#endif // POINTOCTREE_H
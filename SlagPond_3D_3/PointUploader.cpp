@@ -0,0 +1,271 @@
+#include "PointUploader.h"
+#include "ParallelFor.h"
+
+#include <QOpenGLContext>
+#include <QOffscreenSurface>
+#include <QElapsedTimer>
+#include <QDebug>
+
+void pointBounds(const QVector3D *points, int count, QVector3D *boundsMin, QVector3D *boundsSize)
+{
+    if (count <= 0) {
+        *boundsMin = QVector3D();
+        *boundsSize = QVector3D(1e-3f, 1e-3f, 1e-3f);
+        return;
+    }
+
+    QVector3D lo = points[0];
+    QVector3D hi = points[0];
+    QMutex mutex;
+    parallelFor(count, [&](int begin, int end) {
+        QVector3D localMin = points[begin];
+        QVector3D localMax = points[begin];
+        for (int i = begin + 1; i < end; ++i) {
+            localMin = QVector3D(qMin(localMin.x(), points[i].x()), qMin(localMin.y(), points[i].y()), qMin(localMin.z(), points[i].z()));
+            localMax = QVector3D(qMax(localMax.x(), points[i].x()), qMax(localMax.y(), points[i].y()), qMax(localMax.z(), points[i].z()));
+        }
+        QMutexLocker locker(&mutex);
+        lo = QVector3D(qMin(lo.x(), localMin.x()), qMin(lo.y(), localMin.y()), qMin(lo.z(), localMin.z()));
+        hi = QVector3D(qMax(hi.x(), localMax.x()), qMax(hi.y(), localMax.y()), qMax(hi.z(), localMax.z()));
+    }, 4096);
+
+    *boundsMin = lo;
+    *boundsSize = QVector3D(qMax(hi.x() - lo.x(), 1e-3f),
+                            qMax(hi.y() - lo.y(), 1e-3f),
+                            qMax(hi.z() - lo.z(), 1e-3f));
+}
+
+void quantizePoints(const QVector3D *points, int count, const QVector3D &boundsMin, const QVector3D &boundsSize,
+                    PackedPoint *out)
+{
+    const QVector3D scale(65535.0f / boundsSize.x(), 65535.0f / boundsSize.y(), 65535.0f / boundsSize.z());
+    parallelFor(count, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            const QVector3D q = (points[i] - boundsMin) * scale;
+            out[i].x = static_cast<quint16>(q.x() + 0.5f);
+            out[i].y = static_cast<quint16>(q.y() + 0.5f);
+            out[i].z = static_cast<quint16>(q.z() + 0.5f);
+        }
+    }, 4096);
+}
+
+PointUploader::PointUploader(QOpenGLContext *shareContext)
+    : m_shareContext(shareContext)
+{
+    m_guiGl = shareContext->extraFunctions();
+
+    // QOffscreenSurface必须在界面线程创建
+    m_surface = new QOffscreenSurface();
+    m_surface->setFormat(shareContext->format());
+    m_surface->create();
+
+    moveToThread(&m_thread);
+    m_thread.start();
+    QMetaObject::invokeMethod(this, [this]() { initialize(); }, Qt::BlockingQueuedConnection);
+}
+
+PointUploader::~PointUploader()
+{
+    QMetaObject::invokeMethod(this, [this]() { cleanup(); }, Qt::BlockingQueuedConnection);
+    m_thread.quit();
+    m_thread.wait();
+    delete m_surface;
+}
+
+bool PointUploader::isSupported()
+{
+    return QOpenGLContext::supportsThreadedOpenGL();
+}
+
+void PointUploader::initialize()
+{
+    m_context = new QOpenGLContext();
+    m_context->setFormat(m_shareContext->format());
+    m_context->setShareContext(m_shareContext);
+    if (!m_context->create() || !m_context->makeCurrent(m_surface)) {
+        qDebug() << "点集上传线程创建共享上下文失败";
+        delete m_context;
+        m_context = nullptr;
+        return;
+    }
+    m_gl = m_context->extraFunctions();
+}
+
+void PointUploader::cleanup()
+{
+    if (!m_gl) {
+        return;
+    }
+
+    for (Slot &slot : m_slots) {
+        if (slot.uploadFence) {
+            m_gl->glDeleteSync(slot.uploadFence);
+        }
+        if (slot.releaseFence) {
+            m_gl->glDeleteSync(slot.releaseFence);
+        }
+        if (slot.buffer) {
+            m_gl->glDeleteBuffers(1, &slot.buffer);
+        }
+        slot = Slot();
+    }
+
+    m_context->doneCurrent();
+    delete m_context;
+    m_context = nullptr;
+    m_gl = nullptr;
+}
+
+void PointUploader::submit(const QVector<QVector3D> &points)
+{
+    QMutexLocker locker(&m_mutex);
+    m_pending = points;
+    m_hasPending = true;
+    if (!m_processing) {
+        m_processing = true;
+        QMetaObject::invokeMethod(this, [this]() { process(); }, Qt::QueuedConnection);
+    }
+}
+
+void PointUploader::process()
+{
+    forever {
+        QVector<QVector3D> points;
+        GLsync releaseFence = nullptr;
+        int slot = 0;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_hasPending || !m_gl) {
+                m_processing = false;
+                return;
+            }
+            points.swap(m_pending);
+            m_hasPending = false;
+
+            // 三个缓冲区中总有一个既不在绘制也不在等待取用
+            while (slot == m_front || slot == m_ready) {
+                ++slot;
+            }
+            m_writing = slot;
+            releaseFence = m_slots[slot].releaseFence;
+            m_slots[slot].releaseFence = nullptr;
+        }
+
+        // 等GPU读完该缓冲区的上一次绘制；轮换间隔远大于一帧，通常立即返回
+        if (releaseFence) {
+            m_gl->glClientWaitSync(releaseFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);   // 1s
+            m_gl->glDeleteSync(releaseFence);
+        }
+
+        upload(slot, points);
+
+        {
+            QMutexLocker locker(&m_mutex);
+            // 尚未被取用的旧结果直接作废，其缓冲区回到空闲
+            if (m_ready >= 0 && m_slots[m_ready].uploadFence) {
+                m_gl->glDeleteSync(m_slots[m_ready].uploadFence);
+                m_slots[m_ready].uploadFence = nullptr;
+            }
+            m_ready = slot;
+            m_writing = -1;
+        }
+        emit uploaded();
+    }
+}
+
+void PointUploader::upload(int index, const QVector<QVector3D> &points)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    Slot &slot = m_slots[index];
+    const int count = points.size();
+
+    QVector3D boundsMin;
+    QVector3D boundsSize;
+    pointBounds(points.constData(), count, &boundsMin, &boundsSize);
+
+    if (!slot.buffer) {
+        m_gl->glGenBuffers(1, &slot.buffer);
+    }
+    m_gl->glBindBuffer(GL_ARRAY_BUFFER, slot.buffer);
+
+    // 按容量分配，点数增长时才重新分配（1.5倍）
+    if (count > slot.capacity) {
+        slot.capacity = qMax(count, slot.capacity + slot.capacity / 2);
+        m_gl->glBufferData(GL_ARRAY_BUFFER, static_cast<qint64>(slot.capacity) * sizeof(PackedPoint), nullptr,
+                           GL_STREAM_DRAW);
+    }
+
+    // 缓冲区已确认不在使用中，映射后直接量化写入
+    const qint64 bytes = static_cast<qint64>(count) * sizeof(PackedPoint);
+    void *ptr = count > 0 ? m_gl->glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes,
+                                                   GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT)
+                          : nullptr;
+    if (ptr) {
+        quantizePoints(points.constData(), count, boundsMin, boundsSize, static_cast<PackedPoint*>(ptr));
+        m_gl->glUnmapBuffer(GL_ARRAY_BUFFER);
+    } else if (count > 0) {
+        QVector<PackedPoint> staging(count);
+        quantizePoints(points.constData(), count, boundsMin, boundsSize, staging.data());
+        m_gl->glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, staging.constData());
+    }
+    m_gl->glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    slot.points.buffer = slot.buffer;
+    slot.points.count = count;
+    slot.points.boundsMin = boundsMin;
+    slot.points.boundsSize = boundsSize;
+
+    // 栅栏须在flush后才对界面线程的上下文可见
+    slot.uploadFence = m_gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_gl->glFlush();
+
+    qDebug() << "后台上传点集，点数:" << count << "，用时:" << timer.nsecsElapsed() / 1000000.0f << "ms";
+}
+
+bool PointUploader::acquire(UploadedPoints *out)
+{
+    GLsync fence = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_ready < 0) {
+            return false;
+        }
+        m_front = m_ready;
+        m_ready = -1;
+        fence = m_slots[m_front].uploadFence;
+        m_slots[m_front].uploadFence = nullptr;
+        *out = m_slots[m_front].points;
+    }
+
+    // GPU端等待，命令流中排在上传之后即可，CPU不阻塞
+    if (fence) {
+        m_guiGl->glWaitSync(fence, 0, GL_TIMEOUT_IGNORED);
+        m_guiGl->glDeleteSync(fence);
+    }
+    return true;
+}
+
+void PointUploader::releaseFront()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_front < 0) {
+        return;
+    }
+    Slot &slot = m_slots[m_front];
+    if (slot.releaseFence) {
+        m_guiGl->glDeleteSync(slot.releaseFence);
+    }
+    slot.releaseFence = m_guiGl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+qint64 PointUploader::gpuBytes()
+{
+    QMutexLocker locker(&m_mutex);
+    qint64 bytes = 0;
+    for (const Slot &slot : m_slots) {
+        bytes += static_cast<qint64>(slot.capacity) * sizeof(PackedPoint);
+    }
+    return bytes;
+}
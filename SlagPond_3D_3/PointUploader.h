@@ -0,0 +1,100 @@
+#ifndef POINTUPLOADER_H
+#define POINTUPLOADER_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <QVector3D>
+#include <QOpenGLExtraFunctions>
+#include <array>
+
+class QOpenGLContext;
+class QOffscreenSurface;
+
+// 点集顶点：相对包围盒归一化的16位位置，6字节，颜色由着色器按高度查表
+struct PackedPoint {
+    quint16 x, y, z;
+};
+
+// 点集包围盒（并行归约），退化的轴给一个很小的尺寸以免除零
+void pointBounds(const QVector3D *points, int count, QVector3D *boundsMin, QVector3D *boundsSize);
+// 按包围盒把位置量化为16位整数（并行），渣池尺度下精度优于1毫米
+void quantizePoints(const QVector3D *points, int count, const QVector3D &boundsMin, const QVector3D &boundsSize,
+                    PackedPoint *out);
+
+// 已上传到GPU的一份点集
+struct UploadedPoints {
+    GLuint buffer = 0;
+    int count = 0;
+    QVector3D boundsMin;
+    QVector3D boundsSize;
+};
+
+// 后台线程点集上传：工作线程持有与界面共享的OpenGL上下文（QOffscreenSurface），
+// 在其中完成量化和缓冲区写入，用栅栏同步后把缓冲区句柄交给界面线程；paintGL只负责绑定和绘制
+// 共三个缓冲区轮换：界面正在绘制的、已上传待取用的、工作线程正在写入的
+class PointUploader : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 在界面线程、shareContext为当前上下文时构造
+    // 对象移到工作线程，因此不设父对象，由使用者在上下文当前时删除
+    explicit PointUploader(QOpenGLContext *shareContext);
+    ~PointUploader();
+
+    // 平台是否支持在其它线程使用共享上下文
+    static bool isSupported();
+    // 工作线程上下文创建成功
+    bool isValid() const { return m_gl != nullptr; }
+
+    // 提交新点集（任意线程），工作线程忙时只保留最新一份
+    void submit(const QVector<QVector3D> &points);
+
+    // 界面线程、上下文当前时调用：有新上传完成时切换为绘制用缓冲区，返回true
+    // 只在GPU端等待上传栅栏，不阻塞CPU
+    bool acquire(UploadedPoints *out);
+    // 界面线程绘制完当前缓冲区后调用，插入栅栏供工作线程复用前等待
+    void releaseFront();
+
+    // 三个缓冲区已分配的显存（任意线程）
+    qint64 gpuBytes();
+
+signals:
+    // 工作线程发出，有新的点集可取用
+    void uploaded();
+
+private:
+    void initialize();
+    void process();
+    void cleanup();
+    void upload(int slot, const QVector<QVector3D> &points);
+
+    struct Slot {
+        GLuint buffer = 0;
+        int capacity = 0;   // 按点数
+        UploadedPoints points;
+        GLsync uploadFence = nullptr;    // 工作线程写入完成
+        GLsync releaseFence = nullptr;   // 界面线程最后一次绘制完成
+    };
+
+    QThread m_thread;
+    QOpenGLContext *m_shareContext;
+    QOpenGLContext *m_context = nullptr;
+    QOffscreenSurface *m_surface = nullptr;
+    QOpenGLExtraFunctions *m_gl = nullptr;
+    QOpenGLExtraFunctions *m_guiGl = nullptr;
+
+    // 以下由m_mutex保护
+    QMutex m_mutex;
+    std::array<Slot, 3> m_slots;
+    int m_front = -1;
+    int m_ready = -1;
+    int m_writing = -1;
+    QVector<QVector3D> m_pending;
+    bool m_hasPending = false;
+    bool m_processing = false;
+};
+
+#endif // POINTUPLOADER_H
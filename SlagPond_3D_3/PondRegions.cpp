@@ -0,0 +1,147 @@
+#include "PondRegions.h"
+
+#include <QSettings>
+#include <QStringList>
+#include <QRegularExpression>
+#include <QDebug>
+#include <cmath>
+#include <algorithm>
+
+PondRegions::PondRegions()
+{
+    // 默认：与融合栅格一致的单个渣池
+    const HeightGrid defaults;
+    PondRegion region;
+    region.name = "1号";
+    region.polygon = QPolygonF(QRectF(defaults.originX(), defaults.originY(),
+                                      defaults.cols() * defaults.cellSize(), defaults.rows() * defaults.cellSize()));
+    setRegions({region});
+}
+
+void PondRegions::loadSettings(QSettings &settings)
+{
+    QVector<PondRegion> regions;
+
+    const int size = settings.beginReadArray("ponds");
+    for (int i = 0; i < size; ++i) {
+        settings.setArrayIndex(i);
+
+        // 未加引号时逗号会被QSettings拆成列表，统一拼回后按分号分割顶点
+        const QVariant value = settings.value("polygon");
+        const QString text = value.typeId() == QMetaType::QStringList ? value.toStringList().join(',') : value.toString();
+
+        PondRegion region;
+        region.name = settings.value("name", QString("%1号").arg(i + 1)).toString();
+        for (const QString &vertex : text.split(';', Qt::SkipEmptyParts)) {
+            const QStringList xy = vertex.simplified().split(QRegularExpression("[ ,]"), Qt::SkipEmptyParts);
+            if (xy.size() == 2) {
+                region.polygon.append(QPointF(xy[0].toDouble(), xy[1].toDouble()));
+            }
+        }
+
+        if (region.polygon.size() < 3) {
+            qDebug() << "渣池" << region.name << "的polygon顶点不足3个，忽略";
+            continue;
+        }
+        regions.append(region);
+    }
+    settings.endArray();
+
+    if (!regions.isEmpty()) {
+        setRegions(regions);
+    }
+    qDebug() << "渣池数量:" << m_regions.size();
+}
+
+void PondRegions::setRegions(const QVector<PondRegion> &regions)
+{
+    // 编号存为qint8
+    m_regions = regions.mid(0, 127);
+
+    QRectF bounds;
+    for (PondRegion &region : m_regions) {
+        // 每个渣池的栅格为多边形外接矩形，对齐到单元边长
+        const QRectF box = region.polygon.boundingRect();
+        const float x0 = std::floor(box.left() / CELL_SIZE) * CELL_SIZE;
+        const float y0 = std::floor(box.top() / CELL_SIZE) * CELL_SIZE;
+        const int cols = qMax(1, static_cast<int>(std::ceil((box.right() - x0) / CELL_SIZE)));
+        const int rows = qMax(1, static_cast<int>(std::ceil((box.bottom() - y0) / CELL_SIZE)));
+        region.layout.reset(x0, y0, CELL_SIZE, cols, rows);
+
+        bounds = bounds.united(QRectF(x0, y0, cols * CELL_SIZE, rows * CELL_SIZE));
+    }
+
+    m_layout.reset(bounds.left(), bounds.top(), CELL_SIZE,
+                   qRound(bounds.width() / CELL_SIZE), qRound(bounds.height() / CELL_SIZE));
+    rasterize();
+
+    // 各渣池栅格的区域掩码直接取自全局查找表
+    for (int pond = 0; pond < m_regions.size(); ++pond) {
+        PondRegion &region = m_regions[pond];
+        region.mask.resize(region.layout.cellCount());
+        for (int i = 0; i < region.layout.cellCount(); ++i) {
+            const QPointF center = region.layout.cellCenter(i);
+            region.mask[i] = pondAt(center.x(), center.y()) == pond ? 1 : 0;
+        }
+    }
+}
+
+void PondRegions::rasterize()
+{
+    const int cols = m_layout.cols();
+    const int rows = m_layout.rows();
+    m_mask.fill(-1, cols * rows);
+
+    // 逐行扫描线填充：求单元中心所在水平线与多边形各边的交点，交点之间（奇偶规则）为内部
+    QVector<double> crossings;
+    for (int pond = 0; pond < m_regions.size(); ++pond) {
+        const QPolygonF &polygon = m_regions[pond].polygon;
+        const int n = polygon.size();
+
+        for (int row = 0; row < rows; ++row) {
+            const double y = m_layout.originY() + (row + 0.5) * CELL_SIZE;
+            crossings.clear();
+            for (int i = 0; i < n; ++i) {
+                const QPointF &a = polygon[i];
+                const QPointF &b = polygon[(i + 1) % n];
+                if ((a.y() <= y) != (b.y() <= y)) {
+                    crossings.append(a.x() + (y - a.y()) * (b.x() - a.x()) / (b.y() - a.y()));
+                }
+            }
+            std::sort(crossings.begin(), crossings.end());
+
+            for (int k = 0; k + 1 < crossings.size(); k += 2) {
+                // 中心落在[x0, x1)内的单元
+                const int c0 = qMax(0, static_cast<int>(std::ceil((crossings[k] - m_layout.originX()) / CELL_SIZE - 0.5)));
+                const int c1 = qMin(cols - 1, static_cast<int>(std::ceil((crossings[k + 1] - m_layout.originX()) / CELL_SIZE - 0.5)) - 1);
+                // 区域重叠时先配置的渣池优先
+                qint8 *mask = m_mask.data() + row * cols;
+                for (int col = c0; col <= c1; ++col) {
+                    if (mask[col] < 0) {
+                        mask[col] = static_cast<qint8>(pond);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void PondRegions::split(const MergedPoints &points, QVector<MergedPoints> &out) const
+{
+    out.resize(m_regions.size());
+    for (MergedPoints &pond : out) {
+        pond.clear();
+    }
+
+    for (int i = 0; i < points.size(); ++i) {
+        const int pond = pondAt(points.x[i], points.y[i]);
+        if (pond < 0) {
+            continue;
+        }
+        MergedPoints &dst = out[pond];
+        dst.x.append(points.x[i]);
+        dst.y.append(points.y[i]);
+        dst.z.append(points.z[i]);
+        dst.amplitude.append(points.amplitude[i]);
+    }
+}
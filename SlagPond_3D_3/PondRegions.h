@@ -0,0 +1,59 @@
+#ifndef PONDREGIONS_H
+#define PONDREGIONS_H
+
+#include "HeightGrid.h"
+#include "CloudMerger.h"
+
+#include <QVector>
+#include <QPolygonF>
+#include <QString>
+
+class QSettings;
+
+// 单个渣池的感兴趣区域
+struct PondRegion {
+    QString name;
+    QPolygonF polygon;   // 渣池坐标系（米）
+    HeightGrid layout;   // 该渣池高度栅格的布局（多边形外接矩形）
+    QVector<quint8> mask;  // layout中各单元是否在多边形内
+};
+
+// 渣池划分：一次扫描可能覆盖多个渣池，按配置的多边形区域把点分到各渣池
+// 多边形预先栅格化为单元 -> 渣池编号的查找表，每个点的归属判断为O(1)
+class PondRegions
+{
+public:
+    PondRegions();
+
+    // 读取[ponds]数组（name、polygon="x y; x y; ..."），未配置时整个默认栅格为一个渣池
+    void loadSettings(QSettings &settings);
+    void setRegions(const QVector<PondRegion> &regions);
+
+    int count() const { return m_regions.size(); }
+    const PondRegion& region(int pond) const { return m_regions[pond]; }
+    // 查找表的布局（覆盖所有渣池）
+    const HeightGrid& layout() const { return m_layout; }
+    // 查找表：单元 -> 渣池编号，不在任何区域内为-1
+    const QVector<qint8>& mask() const { return m_mask; }
+
+    // 点所在的渣池，不在任何区域内返回-1
+    int pondAt(float x, float y) const
+    {
+        const int cell = m_layout.cellIndex(x, y);
+        return cell < 0 ? -1 : m_mask[cell];
+    }
+
+    // 按渣池拆分点，区域外的点丢弃；out大小与渣池数一致
+    void split(const MergedPoints &points, QVector<MergedPoints> &out) const;
+
+private:
+    void rasterize();
+
+    static constexpr float CELL_SIZE = 0.125f;
+
+    QVector<PondRegion> m_regions;
+    HeightGrid m_layout;
+    QVector<qint8> m_mask;
+};
+
+#endif // PONDREGIONS_H
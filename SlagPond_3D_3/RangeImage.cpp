@@ -0,0 +1,374 @@
+#include "RangeImage.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+#include <cmath>
+#include <algorithm>
+
+RangeImage::RangeImage(int rows, int cols)
+    : m_rows(0)
+    , m_cols(0)
+    , m_validCount(0)
+    , m_amplitudeColumn(DEFAULT_AMPLITUDE_COLUMN)
+{
+    resize(rows, cols);
+}
+
+void RangeImage::resize(int rows, int cols)
+{
+    m_rows = qMax(0, rows);
+    m_cols = qMax(0, cols);
+
+    const int size = m_rows * m_cols;
+    m_x.fill(0.0f, size);
+    m_y.fill(0.0f, size);
+    m_z.fill(0.0f, size);
+    m_amplitude.fill(0.0f, size);
+    m_valid.fill(0, size);
+    m_lineCount.fill(0, m_rows);
+    m_lineArrival.fill(0, m_rows);
+    m_lineDirty.fill(false, m_rows);
+    m_dirtyLines.clear();
+    m_validCount = 0;
+
+    m_pendingLine = LineBuffer();
+    m_pendingScanIndex = -1;
+    m_pendingCommitted = false;
+    m_pendingArrival = 0;
+}
+
+void RangeImage::clear()
+{
+    resize(m_rows, 0);
+}
+
+QVector3D RangeImage::point(int row, int col) const
+{
+    const int i = index(row, col);
+    return QVector3D(m_x[i], m_y[i], m_z[i]);
+}
+
+int RangeImage::rowForScanIndex(int scanIndex)
+{
+    int row = scanIndex % SCAN_LINES;
+    return row < 0 ? row + SCAN_LINES : row;
+}
+
+float RangeImage::lineY(int row)
+{
+    return row * SCAN_Y_RANGE / SCAN_LINES;
+}
+
+void RangeImage::growColumns(int cols)
+{
+    if (cols <= m_cols) {
+        return;
+    }
+
+    // 扩列时按行搬移已有数据
+    QVector<float> x(m_rows * cols, 0.0f);
+    QVector<float> y(m_rows * cols, 0.0f);
+    QVector<float> z(m_rows * cols, 0.0f);
+    QVector<float> amplitude(m_rows * cols, 0.0f);
+    QVector<quint8> valid(m_rows * cols, 0);
+
+    for (int row = 0; row < m_rows; ++row) {
+        const int count = m_lineCount[row];
+        const int src = row * m_cols;
+        const int dst = row * cols;
+        std::copy(m_x.constBegin() + src, m_x.constBegin() + src + count, x.begin() + dst);
+        std::copy(m_y.constBegin() + src, m_y.constBegin() + src + count, y.begin() + dst);
+        std::copy(m_z.constBegin() + src, m_z.constBegin() + src + count, z.begin() + dst);
+        std::copy(m_amplitude.constBegin() + src, m_amplitude.constBegin() + src + count, amplitude.begin() + dst);
+        std::copy(m_valid.constBegin() + src, m_valid.constBegin() + src + count, valid.begin() + dst);
+    }
+
+    m_x.swap(x);
+    m_y.swap(y);
+    m_z.swap(z);
+    m_amplitude.swap(amplitude);
+    m_valid.swap(valid);
+    m_cols = cols;
+}
+
+void RangeImage::setLine(int row, const float *x, const float *z, const float *amplitude, int count)
+{
+    if (row < 0 || row >= m_rows || count < 0) {
+        return;
+    }
+
+    growColumns(count);
+
+    const int base = row * m_cols;
+    const float y = lineY(row);
+
+    m_validCount -= m_lineCount[row];
+    for (int col = 0; col < count; ++col) {
+        m_x[base + col] = x[col];
+        m_y[base + col] = y;
+        m_z[base + col] = z[col];
+        m_amplitude[base + col] = amplitude ? amplitude[col] : 0.0f;
+        m_valid[base + col] = 1;
+    }
+    for (int col = count; col < m_lineCount[row]; ++col) {
+        m_valid[base + col] = 0;
+    }
+    m_lineCount[row] = count;
+    m_validCount += count;
+
+    if (!m_lineDirty[row]) {
+        m_lineDirty[row] = true;
+        m_dirtyLines.append(row);
+    }
+}
+
+QVector<int> RangeImage::takeDirtyLines()
+{
+    QVector<int> lines;
+    lines.swap(m_dirtyLines);
+    for (int row : lines) {
+        m_lineDirty[row] = false;
+    }
+    return lines;
+}
+
+int RangeImage::neighbours4(int row, int col, QVector3D out[4]) const
+{
+    static const int offsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+    int n = 0;
+    for (const auto &offset : offsets) {
+        const int r = row + offset[0];
+        const int c = col + offset[1];
+        if (contains(r, c) && isValid(r, c)) {
+            out[n++] = point(r, c);
+        }
+    }
+    return n;
+}
+
+QVector3D RangeImage::normalAt(int row, int col) const
+{
+    auto validAt = [this](int r, int c) {
+        return contains(r, c) && isValid(r, c);
+    };
+
+    if (!validAt(row, col)) {
+        return QVector3D(0.0f, 0.0f, 1.0f);
+    }
+
+    // 沿列方向（线内）和行方向（扫描线间）的中心差分，缺失一侧时退化为单侧差分
+    const int c0 = validAt(row, col - 1) ? col - 1 : col;
+    const int c1 = validAt(row, col + 1) ? col + 1 : col;
+    const int r0 = validAt(row - 1, col) ? row - 1 : row;
+    const int r1 = validAt(row + 1, col) ? row + 1 : row;
+
+    if (c0 == c1 || r0 == r1) {
+        return QVector3D(0.0f, 0.0f, 1.0f);
+    }
+
+    const QVector3D du = point(row, c1) - point(row, c0);
+    const QVector3D dv = point(r1, col) - point(r0, col);
+    QVector3D n = QVector3D::crossProduct(du, dv).normalized();
+    if (n.z() < 0.0f) {
+        n = -n;
+    }
+    return n.isNull() ? QVector3D(0.0f, 0.0f, 1.0f) : n;
+}
+
+bool RangeImage::heightRange(float *minHeight, float *maxHeight, int *maxRow, int *maxCol) const
+{
+    bool found = false;
+    float minZ = 0.0f;
+    float maxZ = 0.0f;
+    int maxIndex = 0;
+
+    for (int row = 0; row < m_rows; ++row) {
+        const int base = row * m_cols;
+        for (int col = 0; col < m_lineCount[row]; ++col) {
+            const float z = m_z[base + col];
+            if (!found) {
+                minZ = maxZ = z;
+                maxIndex = base + col;
+                found = true;
+            } else {
+                minZ = qMin(minZ, z);
+                if (z > maxZ) {
+                    maxZ = z;
+                    maxIndex = base + col;
+                }
+            }
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    if (minHeight) *minHeight = minZ;
+    if (maxHeight) *maxHeight = maxZ;
+    if (maxRow) *maxRow = m_cols > 0 ? maxIndex / m_cols : 0;
+    if (maxCol) *maxCol = m_cols > 0 ? maxIndex % m_cols : 0;
+    return true;
+}
+
+QVector<QVector3D> RangeImage::toPoints(float scale) const
+{
+    QVector<QVector3D> points;
+    points.reserve(m_validCount);
+
+    for (int row = 0; row < m_rows; ++row) {
+        const int base = row * m_cols;
+        for (int col = 0; col < m_lineCount[row]; ++col) {
+            const int i = base + col;
+            points.append(QVector3D(m_x[i] * scale, m_y[i] * scale, m_z[i] * scale));
+        }
+    }
+    return points;
+}
+
+void RangeImage::LineBuffer::append(const RadarSample &sample)
+{
+    x.append(sample.x);
+    z.append(sample.z);
+    amplitude.append(sample.amplitude);
+}
+
+void RangeImage::setLine(int row, const LineBuffer &line)
+{
+    setLine(row, line.x.constData(), line.z.constData(), line.amplitude.constData(), line.x.size());
+}
+
+bool RangeImage::parseRecord(const QStringList &fields, RadarSample *sample, int amplitudeColumn)
+{
+    if (fields.size() < 11) {
+        return false;
+    }
+
+    bool okX, okZ, okIndex;
+    sample->x = fields[0].toFloat(&okX);
+    sample->z = fields[2].toFloat(&okZ);
+    sample->scanIndex = fields[10].toInt(&okIndex);
+
+    bool okAmplitude = false;
+    if (amplitudeColumn >= 0 && amplitudeColumn < fields.size()) {
+        sample->amplitude = fields[amplitudeColumn].toFloat(&okAmplitude);
+    }
+    if (!okAmplitude) {
+        sample->amplitude = 0.0f;
+    }
+    return okX && okZ && okIndex;
+}
+
+bool RangeImage::loadCSV(const QString &filePath, char separator, int maxPoints, QString *errorString)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (errorString) {
+            *errorString = QString("无法打开文件: %1").arg(filePath);
+        }
+        return false;
+    }
+
+    QTextStream in(&file);
+    in.setEncoding(QStringConverter::Encoding::System);
+
+    // 读取表头
+    QString header = in.readLine().trimmed();
+    qDebug() << "CSV表头:" << header;
+
+    // 先按扫描线分桶，再一次性写入，避免反复扩列
+    QVector<LineBuffer> lines(m_rows);
+
+    int lineCount = 0;
+    int validPointCount = 0;
+    RadarSample sample;
+
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        lineCount++;
+
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        if (!parseRecord(line.split(separator), &sample, m_amplitudeColumn)) {
+            qWarning() << "第" << lineCount << "行数据格式错误，跳过";
+            continue;
+        }
+
+        lines[rowForScanIndex(sample.scanIndex)].append(sample);
+        validPointCount++;
+
+        // 限制最大点数量
+        if (maxPoints > 0 && validPointCount >= maxPoints) {
+            qDebug() << "达到最大点数限制(" << maxPoints << ")，停止读取";
+            break;
+        }
+    }
+    file.close();
+
+    int maxLine = 0;
+    for (const LineBuffer &buffer : lines) {
+        maxLine = qMax(maxLine, static_cast<int>(buffer.x.size()));
+    }
+
+    resize(m_rows, maxLine);
+    for (int row = 0; row < m_rows; ++row) {
+        if (!lines[row].x.isEmpty()) {
+            setLine(row, lines[row]);
+        }
+    }
+
+    qDebug() << "成功读取" << validPointCount << "个点，总行数:" << lineCount
+             << "，距离图像:" << m_rows << "x" << m_cols;
+
+    if (validPointCount == 0 && errorString) {
+        *errorString = "文件中没有有效数据";
+    }
+    return validPointCount > 0;
+}
+
+int RangeImage::decodeDatagram(const QByteArray &datagram, char separator, qint64 arrival)
+{
+    // 一条扫描线（约870点）跨多个数据报发送：片段追加到暂存行，
+    // 扫描线序号变化（含一次扫描结束后序号回绕）或采样数达到列数时才整行写入
+    RadarSample sample;
+    int decoded = 0;
+
+    const QList<QByteArray> records = datagram.split('\n');
+    for (const QByteArray &record : records) {
+        const QString line = QString::fromUtf8(record).trimmed();
+        if (line.isEmpty() || !parseRecord(line.split(separator), &sample, m_amplitudeColumn)) {
+            continue;
+        }
+
+        if (sample.scanIndex != m_pendingScanIndex) {
+            commitPendingLine();
+            m_pendingLine = LineBuffer();
+            m_pendingScanIndex = sample.scanIndex;
+        }
+        m_pendingLine.append(sample);
+        m_pendingCommitted = false;
+        m_pendingArrival = arrival;
+        decoded++;
+    }
+
+    // 已达到当前列数的扫描线视为完整，不必等下一条扫描线的首个片段
+    if (m_cols > 0 && m_pendingLine.x.size() >= m_cols) {
+        commitPendingLine();
+    }
+    return decoded;
+}
+
+void RangeImage::commitPendingLine()
+{
+    if (m_pendingCommitted || m_pendingLine.x.isEmpty()) {
+        return;
+    }
+    const int row = rowForScanIndex(m_pendingScanIndex);
+    setLine(row, m_pendingLine);
+    m_lineArrival[row] = m_pendingArrival;
+    m_pendingCommitted = true;
+}
@@ -0,0 +1,139 @@
+#ifndef RANGEIMAGE_H
+#define RANGEIMAGE_H
+
+#include <QVector>
+#include <QVector3D>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+
+// 雷达采样点（一行CSV记录解码后的结果）
+struct RadarSample {
+    int scanIndex = 0;   // 第10列：扫描线序号
+    float x = 0.0f;      // 第0列
+    float z = 0.0f;      // 第2列
+    float amplitude = 0.0f;  // 回波幅度（列号可配置）
+};
+
+// 按扫描线组织的距离图像：行 = 扫描线，列 = 线内采样序号
+// 采用SoA存储（x/y/z/幅度/有效位分别连续存放），邻域查询为O(1)数组下标运算
+class RangeImage
+{
+public:
+    // 一次完整扫描包含的扫描线数（第10列对该值取模）
+    static const int SCAN_LINES = 1151;
+    // 扫描线序号映射到y方向的范围
+    static constexpr float SCAN_Y_RANGE = 100.0f;
+    // 回波幅度默认所在列
+    static const int DEFAULT_AMPLITUDE_COLUMN = 3;
+
+    explicit RangeImage(int rows = SCAN_LINES, int cols = 0);
+
+    void resize(int rows, int cols);
+    void clear();
+
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+    int index(int row, int col) const { return row * m_cols + col; }
+    bool contains(int row, int col) const { return row >= 0 && row < m_rows && col >= 0 && col < m_cols; }
+
+    bool isValid(int row, int col) const { return m_valid[index(row, col)] != 0; }
+    QVector3D point(int row, int col) const;
+
+    // SoA列
+    const QVector<float>& xs() const { return m_x; }
+    const QVector<float>& ys() const { return m_y; }
+    const QVector<float>& zs() const { return m_z; }
+    const QVector<float>& amplitudes() const { return m_amplitude; }
+    // 标定变换等原地处理使用
+    QVector<float>& xs() { return m_x; }
+    QVector<float>& ys() { return m_y; }
+    QVector<float>& zs() { return m_z; }
+    const QVector<quint8>& validMask() const { return m_valid; }
+    int lineCount(int row) const { return m_lineCount[row]; }
+    // 扫描线最后一个片段的到达时间（decodeDatagram传入的时间戳，非网络数据为0）
+    qint64 lineArrival(int row) const { return m_lineArrival[row]; }
+
+    // 扫描线序号 -> 行号 / y坐标
+    static int rowForScanIndex(int scanIndex);
+    static float lineY(int row);
+
+    // 整行替换（增量更新），采样数超过当前列数时自动扩列；amplitude可为空
+    void setLine(int row, const float *x, const float *z, const float *amplitude, int count);
+
+    // 自上次取出以来被更新的扫描线（按更新顺序）
+    const QVector<int>& dirtyLines() const { return m_dirtyLines; }
+    QVector<int> takeDirtyLines();
+
+    // 4邻域（上下左右）中有效的点，返回个数
+    int neighbours4(int row, int col, QVector3D out[4]) const;
+    // 基于行列中心差分估计法向量，邻域不足时返回(0,0,1)
+    QVector3D normalAt(int row, int col) const;
+
+    int validCount() const { return m_validCount; }
+    bool isEmpty() const { return m_validCount == 0; }
+
+    // 高度范围及最高点，无有效点时返回false
+    bool heightRange(float *minHeight, float *maxHeight, int *maxRow = nullptr, int *maxCol = nullptr) const;
+
+    // 导出有效点（按scale缩放），供点云视图使用
+    QVector<QVector3D> toPoints(float scale = 1.0f) const;
+
+    // 回波幅度所在列，小于0表示数据中没有幅度
+    void setAmplitudeColumn(int column) { m_amplitudeColumn = column; }
+    int amplitudeColumn() const { return m_amplitudeColumn; }
+
+    // 解析一行CSV记录（幅度列缺失或无法解析时幅度记为0）
+    static bool parseRecord(const QStringList &fields, RadarSample *sample,
+                            int amplitudeColumn = DEFAULT_AMPLITUDE_COLUMN);
+    // 读取CSV文件，按扫描线组织。maxPoints <= 0 时不限制点数
+    bool loadCSV(const QString &filePath, char separator = ',', int maxPoints = 1000000,
+                 QString *errorString = nullptr);
+    // 解码网络数据报（每行一条CSV记录），返回解码的点数
+    // 同一扫描线的片段跨数据报累积，扫描线序号变化或采样数达到列数时整行写入
+    // arrival为数据报到达时间，记为扫描线最后一个片段的到达时间
+    int decodeDatagram(const QByteArray &datagram, char separator = ',', qint64 arrival = 0);
+
+    // 尚未写入的扫描线片段及其最后一个片段的到达时间
+    bool hasPendingLine() const { return !m_pendingCommitted && !m_pendingLine.x.isEmpty(); }
+    qint64 pendingArrival() const { return m_pendingArrival; }
+    // 暂存的扫描线片段整行写入（已写入过且无新片段时跳过），供接收超时时调用
+    void commitPendingLine();
+
+private:
+    // 按扫描线暂存的采样
+    struct LineBuffer {
+        QVector<float> x;
+        QVector<float> z;
+        QVector<float> amplitude;
+
+        void append(const RadarSample &sample);
+    };
+
+    void growColumns(int cols);
+    void setLine(int row, const LineBuffer &line);
+
+    int m_rows;
+    int m_cols;
+    int m_validCount;
+    int m_amplitudeColumn;
+
+    QVector<float> m_x;
+    QVector<float> m_y;
+    QVector<float> m_z;
+    QVector<float> m_amplitude;
+    QVector<quint8> m_valid;
+    QVector<int> m_lineCount;
+    QVector<qint64> m_lineArrival;
+
+    QVector<bool> m_lineDirty;
+    QVector<int> m_dirtyLines;
+
+    // 网络接收中尚未写入的扫描线（片段跨数据报累积）
+    LineBuffer m_pendingLine;
+    int m_pendingScanIndex = -1;
+    bool m_pendingCommitted = false;
+    qint64 m_pendingArrival = 0;
+};
+
+#endif // RANGEIMAGE_H
@@ -0,0 +1,229 @@
+#include "RegionStats.h"
+#include "ParallelFor.h"
+
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+RegionStats::RegionStats()
+    : m_floorHeight(0.0f)
+{
+}
+
+void RegionStats::build(const HeightGrid &grid)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const int cols = grid.cols();
+    const int rows = grid.rows();
+    const int stride = cols + 1;
+    m_cols = cols;
+    m_rows = rows;
+    m_originX = grid.originX();
+    m_originY = grid.originY();
+    m_cellSize = grid.cellSize();
+    m_blocksPerRow = (cols + MAX_BLOCK - 1) / MAX_BLOCK;
+
+    m_sum.resize(stride * (rows + 1));
+    m_sumSquares.resize(stride * (rows + 1));
+    m_excess.resize(stride * (rows + 1));
+    m_count.resize(stride * (rows + 1));
+    m_heights.resize(cols * rows);
+    m_blockMax.resize(m_blocksPerRow * rows);
+
+    // 首行为0
+    std::fill(m_sum.begin(), m_sum.begin() + stride, 0.0);
+    std::fill(m_sumSquares.begin(), m_sumSquares.begin() + stride, 0.0);
+    std::fill(m_excess.begin(), m_excess.begin() + stride, 0.0);
+    std::fill(m_count.begin(), m_count.begin() + stride, 0);
+
+    const float *heights = grid.heights().constData();
+    const quint8 *valid = grid.validMask().constData();
+    const float lowest = std::numeric_limits<float>::lowest();
+    const double floor = m_floorHeight;
+
+    // 第一遍按行并行：行内前缀和、分块最大值
+    parallelFor(rows, [&](int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+            const int src = row * cols;
+            double *sum = m_sum.data() + (row + 1) * stride;
+            double *sumSquares = m_sumSquares.data() + (row + 1) * stride;
+            double *excess = m_excess.data() + (row + 1) * stride;
+            int *count = m_count.data() + (row + 1) * stride;
+            float *h = m_heights.data() + src;
+            sum[0] = 0.0;
+            sumSquares[0] = 0.0;
+            excess[0] = 0.0;
+            count[0] = 0;
+            for (int col = 0; col < cols; ++col) {
+                const bool v = valid[src + col] != 0;
+                const double value = v ? heights[src + col] : 0.0;
+                sum[col + 1] = sum[col] + value;
+                sumSquares[col + 1] = sumSquares[col] + value * value;
+                excess[col + 1] = excess[col] + (v ? std::max(value - floor, 0.0) : 0.0);
+                count[col + 1] = count[col] + (v ? 1 : 0);
+                h[col] = v ? heights[src + col] : lowest;
+            }
+            float *blockMax = m_blockMax.data() + row * m_blocksPerRow;
+            for (int b = 0; b < m_blocksPerRow; ++b) {
+                const int first = b * MAX_BLOCK;
+                blockMax[b] = *std::max_element(h + first, h + qMin(first + MAX_BLOCK, cols));
+            }
+        }
+    });
+
+    // 第二遍按列分段并行：逐行累加上一行，段内连续访问
+    parallelFor(stride, [&](int begin, int end) {
+        for (int row = 1; row < rows; ++row) {
+            const int prev = row * stride;
+            const int cur = (row + 1) * stride;
+            for (int col = begin; col < end; ++col) {
+                m_sum[cur + col] += m_sum[prev + col];
+                m_sumSquares[cur + col] += m_sumSquares[prev + col];
+                m_excess[cur + col] += m_excess[prev + col];
+                m_count[cur + col] += m_count[prev + col];
+            }
+        }
+    }, 64);
+
+    qDebug() << "选区积分图构建用时:" << timer.nsecsElapsed() / 1000000.0f << "ms，栅格:" << cols << "x" << rows;
+}
+
+bool RegionStats::columnRange(double x0, double x1, int *col0, int *col1) const
+{
+    // 单元中心 originX + (col + 0.5) * cellSize 落在[x0, x1]内
+    *col0 = qMax(0, static_cast<int>(std::ceil((x0 - m_originX) / m_cellSize - 0.5)));
+    *col1 = qMin(m_cols - 1, static_cast<int>(std::floor((x1 - m_originX) / m_cellSize - 0.5)));
+    return *col0 <= *col1;
+}
+
+void RegionStats::accumulateSpan(int row, int col0, int col1, Accumulator *acc) const
+{
+    const int stride = m_cols + 1;
+    const int top = row * stride;
+    const int bottom = (row + 1) * stride;
+    acc->sum += m_sum[bottom + col1 + 1] - m_sum[bottom + col0] - m_sum[top + col1 + 1] + m_sum[top + col0];
+    acc->sumSquares += m_sumSquares[bottom + col1 + 1] - m_sumSquares[bottom + col0]
+                       - m_sumSquares[top + col1 + 1] + m_sumSquares[top + col0];
+    acc->excess += m_excess[bottom + col1 + 1] - m_excess[bottom + col0] - m_excess[top + col1 + 1] + m_excess[top + col0];
+    acc->count += m_count[bottom + col1 + 1] - m_count[bottom + col0] - m_count[top + col1 + 1] + m_count[top + col0];
+    acc->total += col1 - col0 + 1;
+
+    // 两端不满一块的单元逐个比较，中间整块取预存的块最大值
+    const float *h = m_heights.constData() + row * m_cols;
+    const float *blockMax = m_blockMax.constData() + row * m_blocksPerRow;
+    float maxHeight = std::numeric_limits<float>::lowest();
+    const int firstBlock = (col0 + MAX_BLOCK - 1) / MAX_BLOCK;
+    const int lastBlock = (col1 + 1) / MAX_BLOCK;   // 不含
+    if (firstBlock >= lastBlock) {
+        maxHeight = *std::max_element(h + col0, h + col1 + 1);
+    } else {
+        for (int col = col0; col < firstBlock * MAX_BLOCK; ++col) {
+            maxHeight = qMax(maxHeight, h[col]);
+        }
+        for (int b = firstBlock; b < lastBlock; ++b) {
+            maxHeight = qMax(maxHeight, blockMax[b]);
+        }
+        for (int col = lastBlock * MAX_BLOCK; col <= col1; ++col) {
+            maxHeight = qMax(maxHeight, h[col]);
+        }
+    }
+    if (maxHeight > std::numeric_limits<float>::lowest()) {
+        acc->maxHeight = acc->hasMax ? qMax(acc->maxHeight, maxHeight) : maxHeight;
+        acc->hasMax = true;
+    }
+}
+
+RegionStatistics RegionStats::finish(const Accumulator &acc) const
+{
+    RegionStatistics stats;
+    stats.cellCount = acc.count;
+    stats.totalCells = acc.total;
+    if (acc.count == 0) {
+        return stats;
+    }
+    const float cellArea = m_cellSize * m_cellSize;
+    const double mean = acc.sum / acc.count;
+    stats.area = acc.count * cellArea;
+    stats.volume = static_cast<float>(acc.excess * cellArea);
+    stats.meanHeight = static_cast<float>(mean);
+    stats.stdDev = static_cast<float>(std::sqrt(std::max(0.0, acc.sumSquares / acc.count - mean * mean)));
+    stats.maxHeight = acc.maxHeight;
+    return stats;
+}
+
+RegionStatistics RegionStats::rectangle(const QRectF &rect) const
+{
+    Accumulator acc;
+    if (isEmpty()) {
+        return finish(acc);
+    }
+    const QRectF r = rect.normalized();
+    int col0, col1;
+    if (!columnRange(r.left(), r.right(), &col0, &col1)) {
+        return finish(acc);
+    }
+    const int row0 = qMax(0, static_cast<int>(std::ceil((r.top() - m_originY) / m_cellSize - 0.5)));
+    const int row1 = qMin(m_rows - 1, static_cast<int>(std::floor((r.bottom() - m_originY) / m_cellSize - 0.5)));
+    if (row0 > row1) {
+        return finish(acc);
+    }
+
+    // 和、平方和、计数为整块矩形一次查询；最大值按行查询
+    const int stride = m_cols + 1;
+    auto rectSum = [&](const auto &table) {
+        return table[(row1 + 1) * stride + col1 + 1] - table[(row1 + 1) * stride + col0]
+               - table[row0 * stride + col1 + 1] + table[row0 * stride + col0];
+    };
+    Accumulator rowMax;
+    for (int row = row0; row <= row1; ++row) {
+        accumulateSpan(row, col0, col1, &rowMax);
+    }
+    acc.sum = rectSum(m_sum);
+    acc.sumSquares = rectSum(m_sumSquares);
+    acc.excess = rectSum(m_excess);
+    acc.count = rectSum(m_count);
+    acc.total = (row1 - row0 + 1) * (col1 - col0 + 1);
+    acc.maxHeight = rowMax.maxHeight;
+    acc.hasMax = rowMax.hasMax;
+    return finish(acc);
+}
+
+RegionStatistics RegionStats::polygon(const QPolygonF &polygon) const
+{
+    Accumulator acc;
+    if (isEmpty() || polygon.size() < 3) {
+        return finish(acc);
+    }
+
+    const QRectF bounds = polygon.boundingRect();
+    const int row0 = qMax(0, static_cast<int>(std::ceil((bounds.top() - m_originY) / m_cellSize - 0.5)));
+    const int row1 = qMin(m_rows - 1, static_cast<int>(std::floor((bounds.bottom() - m_originY) / m_cellSize - 0.5)));
+
+    // 每行取单元中心所在的水平线与各边的交点（半开区间规则避免顶点重复计数），排序后两两成区段
+    const int n = polygon.size();
+    QVector<double> crossings;
+    crossings.reserve(n);
+    for (int row = row0; row <= row1; ++row) {
+        const double y = m_originY + (row + 0.5) * m_cellSize;
+        crossings.clear();
+        for (int i = 0; i < n; ++i) {
+            const QPointF &a = polygon[i];
+            const QPointF &b = polygon[(i + 1) % n];
+            if ((a.y() <= y) != (b.y() <= y)) {
+                crossings.append(a.x() + (y - a.y()) * (b.x() - a.x()) / (b.y() - a.y()));
+            }
+        }
+        std::sort(crossings.begin(), crossings.end());
+        for (int k = 0; k + 1 < crossings.size(); k += 2) {
+            int col0, col1;
+            if (columnRange(crossings[k], crossings[k + 1], &col0, &col1)) {
+                accumulateSpan(row, col0, col1, &acc);
+            }
+        }
+    }
+    return finish(acc);
+}
@@ -0,0 +1,79 @@
+#ifndef REGIONSTATS_H
+#define REGIONSTATS_H
+
+#include "HeightGrid.h"
+
+#include <QVector>
+#include <QRectF>
+#include <QPolygonF>
+
+// 选区统计结果（只计有效单元）
+struct RegionStatistics {
+    int cellCount = 0;        // 选区内有效单元数
+    int totalCells = 0;       // 选区内单元总数（含无效单元）
+    float area = 0.0f;        // 有效单元面积（平方米）
+    float volume = 0.0f;      // 池底以上的体积（立方米），逐单元按max(h - 池底, 0)计
+    float meanHeight = 0.0f;
+    float stdDev = 0.0f;      // 高度标准差
+    float maxHeight = 0.0f;
+};
+
+// 选区统计：高度栅格上的积分图（高度和、高度平方和、池底以上高度和、有效单元数），任意矩形O(1)求和；
+// 多边形按单元中心所在的扫描线拆成行内区段，每段O(1)，总耗时与选区行数成正比
+// 最大值不能由积分图求出，按行分块预存块内最大值，区段查询只遍历两端不满一块的单元
+// 栅格更新时重建一次（O(n)，按行/列分块并行），拖动选区期间只做查询
+class RegionStats
+{
+public:
+    RegionStats();
+
+    // 池底高度（体积计算基准），修改后需重新build
+    void setFloorHeight(float height) { m_floorHeight = height; }
+    float floorHeight() const { return m_floorHeight; }
+
+    void build(const HeightGrid &grid);
+    bool isEmpty() const { return m_cols == 0 || m_rows == 0; }
+
+    // 坐标为渣池坐标系（米），单元中心在选区内即计入
+    RegionStatistics rectangle(const QRectF &rect) const;
+    RegionStatistics polygon(const QPolygonF &polygon) const;
+
+private:
+    struct Accumulator {
+        double sum = 0.0;
+        double sumSquares = 0.0;
+        double excess = 0.0;
+        int count = 0;
+        int total = 0;
+        float maxHeight = 0.0f;
+        bool hasMax = false;
+    };
+
+    // 行内[col0, col1]累加到acc，要求已裁剪到栅格内
+    void accumulateSpan(int row, int col0, int col1, Accumulator *acc) const;
+    // 单元中心x坐标落在[x0, x1]内的列范围，为空时返回false
+    bool columnRange(double x0, double x1, int *col0, int *col1) const;
+    RegionStatistics finish(const Accumulator &acc) const;
+
+    static const int MAX_BLOCK = 32;   // 行内分块最大值的块宽（单元）
+
+    float m_floorHeight;
+    float m_originX = 0.0f;
+    float m_originY = 0.0f;
+    float m_cellSize = 0.0f;
+    int m_cols = 0;
+    int m_rows = 0;
+
+    // 积分图，(rows + 1) x (cols + 1)，首行首列为0
+    QVector<double> m_sum;
+    QVector<double> m_sumSquares;
+    QVector<double> m_excess;   // max(h - 池底, 0)
+    QVector<int> m_count;
+
+    // 求最大值用：无效单元为最小浮点数
+    QVector<float> m_heights;
+    QVector<float> m_blockMax;
+    int m_blocksPerRow = 0;
+};
+
+#endif // REGIONSTATS_H
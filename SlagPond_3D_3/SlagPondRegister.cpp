@@ -0,0 +1,115 @@
+// 多雷达离线配准工具
+// 用两台雷达对同一渣池的扫描数据，以点到平面ICP估计源雷达相对目标雷达的配准修正，
+// 结果写入配置文件源雷达组的registration键，运行时合并阶段直接使用
+//
+// 用法: SlagPondRegister [选项] <源雷达CSV> <目标雷达CSV>
+
+#include "RangeImage.h"
+#include "CoordinateTransform.h"
+#include "PointCloudRegistration.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QSettings>
+#include <QDebug>
+
+// 读取CSV并变换到渣池坐标系，按步长抽稀到不超过maxPoints个点
+static bool loadCloud(const QString &path, const CoordinateTransform &transform, int maxPoints,
+                      QVector<QVector3D> *points)
+{
+    RangeImage image;
+    QString errorString;
+    if (!image.loadCSV(path, ',', 1000000, &errorString)) {
+        qWarning() << errorString;
+        return false;
+    }
+
+    const QVector<int> lines = image.takeDirtyLines();
+    transform.apply(image, lines);
+
+    const int total = image.validCount();
+    const int stride = qMax(1, total / qMax(1, maxPoints));
+    points->clear();
+    points->reserve(total / stride + 1);
+
+    int n = 0;
+    for (int row : lines) {
+        for (int col = 0; col < image.lineCount(row); ++col) {
+            if (n++ % stride == 0) {
+                points->append(image.point(row, col));
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("SlagPondRegister");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("多雷达点云配准（点到平面ICP）");
+    parser.addHelpOption();
+    parser.addPositionalArgument("source", "源雷达CSV");
+    parser.addPositionalArgument("target", "目标雷达（主雷达）CSV");
+    QCommandLineOption configOption("config", "配置文件", "ini", "SlagPond.ini");
+    QCommandLineOption radarOption("radar", "源雷达编号（对应[radarN]组）", "N", "1");
+    QCommandLineOption distanceOption("max-distance", "对应点最大距离（米）", "d", "1.0");
+    QCommandLineOption iterationsOption("iterations", "最大迭代次数", "n", "50");
+    QCommandLineOption pointsOption("max-points", "源点云抽稀后的最大点数", "n", "50000");
+    QCommandLineOption writeOption("write", "将结果写入配置文件");
+    parser.addOptions({configOption, radarOption, distanceOption, iterationsOption, pointsOption, writeOption});
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() != 2) {
+        parser.showHelp(1);
+    }
+
+    // 源雷达按现有标定（含已有配准修正）变换，ICP估计的是在此基础上的剩余修正
+    QSettings settings(parser.value(configOption), QSettings::IniFormat);
+    const QString sourceGroup = QString("radar%1").arg(parser.value(radarOption).toInt());
+    CoordinateTransform sourceTransform;
+    CoordinateTransform targetTransform;
+    sourceTransform.loadSettings(settings, sourceGroup);
+    targetTransform.loadSettings(settings);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<QVector3D> source;
+    QVector<QVector3D> target;
+    if (!loadCloud(args[0], sourceTransform, parser.value(pointsOption).toInt(), &source)
+        || !loadCloud(args[1], targetTransform, 1000000, &target)) {
+        return 1;
+    }
+    qDebug() << "源点数:" << source.size() << "，目标点数:" << target.size()
+             << "，加载用时:" << timer.elapsed() << "ms";
+
+    timer.restart();
+    IcpRegistration icp;
+    icp.setMaxCorrespondenceDistance(parser.value(distanceOption).toFloat());
+    icp.setMaxIterations(parser.value(iterationsOption).toInt());
+    const IcpResult result = icp.align(source, target);
+
+    qDebug() << "迭代次数:" << result.iterations << (result.converged ? "（已收敛）" : "（未收敛）")
+             << "，对应点数:" << result.inliers << "，RMSE:" << result.rmse << "m"
+             << "，配准用时:" << timer.elapsed() << "ms";
+
+    const QMatrix4x4 registration = result.transform * sourceTransform.registration();
+    const QString text = CoordinateTransform::matrixToString(registration);
+    qDebug().noquote() << QString("[%1]\nregistration=\"%2\"").arg(sourceGroup, text);
+
+    if (!result.converged) {
+        qWarning() << "ICP未收敛，结果未写入配置";
+        return 2;
+    }
+    if (parser.isSet(writeOption)) {
+        settings.setValue(sourceGroup + "/registration", text);
+        settings.sync();
+        qDebug() << "已写入" << settings.fileName();
+    }
+    return 0;
+}
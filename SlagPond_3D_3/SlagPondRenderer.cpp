@@ -0,0 +1,859 @@
+#include "SlagPondRenderer.h"
+#include "PointUploader.h"
+#include <QDebug>
+#include <cstddef>
+#include <algorithm>
+
+static const float GRID_SIZE = 5.0f;
+
+SlagPondRenderer::SlagPondRenderer()
+    : m_sceneBuffer(QOpenGLBuffer::VertexBuffer)
+    , m_lowColor(0.0f, 0.0f, 1.0f, 1.0f)
+    , m_highColor(1.0f, 0.0f, 0.0f, 1.0f)
+    , m_surfaceOpacity(1.0f)
+{
+    // 设置默认颜色渐变
+    m_colorGradient[0.0f] = QColor(0, 0, 255);      // 蓝色（低）
+    m_colorGradient[0.3f] = QColor(0, 255, 255);    // 青色
+    m_colorGradient[0.6f] = QColor(0, 255, 0);      // 绿色
+    m_colorGradient[0.8f] = QColor(255, 255, 0);    // 黄色
+    m_colorGradient[1.0f] = QColor(255, 0, 0);      // 红色（高）
+
+    // 预构建颜色查找表
+    buildColorLookupTable();
+}
+
+void SlagPondRenderer::initialize()
+{
+    if (isInitialized()) {
+        return;
+    }
+    initializeOpenGLFunctions();
+
+    // 设置着色器
+    setupShaderProgram();
+
+    // 创建静态场景几何体（四个视角一次写入）
+    buildSceneGeometry();
+}
+
+void SlagPondRenderer::destroy()
+{
+    if (!isInitialized()) {
+        return;
+    }
+
+    // 清理静态场景几何体
+    if (m_vaoScene) {
+        m_vaoScene->destroy();
+        delete m_vaoScene;
+        m_vaoScene = nullptr;
+    }
+    m_sceneBuffer.destroy();
+
+    // 清理颜色纹理
+    if (m_colormapTexture) {
+        m_colormapTexture->destroy();
+        delete m_colormapTexture;
+        m_colormapTexture = nullptr;
+    }
+    m_colormapDirty = true;
+
+    delete m_shaderProgram;
+    delete m_pointShaderProgram;
+    delete m_surfaceProgram;
+    delete m_heightFieldProgram;
+    delete m_pointPickProgram;
+    delete m_surfacePickProgram;
+    delete m_heightFieldPickProgram;
+    m_shaderProgram = nullptr;
+    m_pointShaderProgram = nullptr;
+    m_surfaceProgram = nullptr;
+    m_heightFieldProgram = nullptr;
+    m_pointPickProgram = nullptr;
+    m_surfacePickProgram = nullptr;
+    m_heightFieldPickProgram = nullptr;
+}
+
+void SlagPondRenderer::setupShaderProgram()
+{
+    m_shaderProgram = new QOpenGLShaderProgram();
+
+    // 顶点着色器
+    const char *vshader =
+        "#version 330 core\n"
+        "layout(location = 0) in vec3 position;\n"
+        "layout(location = 1) in vec4 color;\n"
+        "uniform mat4 mvp;\n"
+        "out vec4 vColor;\n"
+        "void main() {\n"
+        "    vColor = color;\n"
+        "    gl_Position = mvp * vec4(position, 1.0);\n"
+        "}";
+
+    // 片段着色器
+    const char *fshader =
+        "#version 330 core\n"
+        "in vec4 vColor;\n"
+        "out vec4 fragColor;\n"
+        "void main() {\n"
+        "    fragColor = vColor;\n"
+        "}";
+
+    if (!m_shaderProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, vshader)) {
+        qDebug() << "顶点着色器编译错误:" << m_shaderProgram->log();
+    }
+
+    if (!m_shaderProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, fshader)) {
+        qDebug() << "片段着色器编译错误:" << m_shaderProgram->log();
+    }
+
+    if (!m_shaderProgram->link()) {
+        qDebug() << "着色器链接错误:" << m_shaderProgram->log();
+    }
+
+    m_pointShaderProgram = new QOpenGLShaderProgram();
+
+    // 点集顶点着色器：16位归一化位置按包围盒还原，高度归一化后换算为纹理坐标（对齐到首末纹素中心）
+    const char *pointVShader =
+        "#version 330 core\n"
+        "layout(location = 0) in vec3 packedPosition;\n"
+        "uniform mat4 mvp;\n"
+        "uniform vec3 boundsMin;\n"
+        "uniform vec3 boundsSize;\n"
+        "uniform float minHeight;\n"
+        "uniform float maxHeight;\n"
+        "uniform float tableSize;\n"
+        "out float vCoord;\n"
+        "void main() {\n"
+        "    vec3 position = boundsMin + packedPosition * boundsSize;\n"
+        "    float range = maxHeight - minHeight;\n"
+        "    float t = range > 0.0 ? clamp((position.z - minHeight) / range, 0.0, 1.0) : 0.0;\n"
+        "    vCoord = (t * (tableSize - 1.0) + 0.5) / tableSize;\n"
+        "    gl_Position = mvp * vec4(position, 1.0);\n"
+        "}";
+
+    const char *pointFShader =
+        "#version 330 core\n"
+        "in float vCoord;\n"
+        "uniform sampler1D colormap;\n"
+        "uniform float opacity;\n"
+        "out vec4 fragColor;\n"
+        "void main() {\n"
+        "    fragColor = vec4(texture(colormap, vCoord).rgb, opacity);\n"
+        "}";
+
+    if (!m_pointShaderProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, pointVShader)) {
+        qDebug() << "点集顶点着色器编译错误:" << m_pointShaderProgram->log();
+    }
+
+    if (!m_pointShaderProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, pointFShader)) {
+        qDebug() << "点集片段着色器编译错误:" << m_pointShaderProgram->log();
+    }
+
+    if (!m_pointShaderProgram->link()) {
+        qDebug() << "点集着色器链接错误:" << m_pointShaderProgram->log();
+    }
+
+    m_surfaceProgram = new QOpenGLShaderProgram();
+
+    // 三角网格顶点着色器：按高度着色时颜色在GPU上由颜色纹理查得，高度范围变化不需改写顶点
+    const char *surfaceVShader =
+        "#version 330 core\n"
+        "layout(location = 0) in vec3 position;\n"
+        "layout(location = 1) in vec4 color;\n"
+        "uniform mat4 mvp;\n"
+        "uniform float minHeight;\n"
+        "uniform float maxHeight;\n"
+        "uniform float tableSize;\n"
+        "out vec4 vColor;\n"
+        "out float vCoord;\n"
+        "void main() {\n"
+        "    vColor = color;\n"
+        "    float range = maxHeight - minHeight;\n"
+        "    float t = range > 0.0 ? clamp((position.z - minHeight) / range, 0.0, 1.0) : 0.0;\n"
+        "    vCoord = (t * (tableSize - 1.0) + 0.5) / tableSize;\n"
+        "    gl_Position = mvp * vec4(position, 1.0);\n"
+        "}";
+
+    const char *surfaceFShader =
+        "#version 330 core\n"
+        "in vec4 vColor;\n"
+        "in float vCoord;\n"
+        "uniform sampler1D colormap;\n"
+        "uniform float opacity;\n"
+        "uniform int useColormap;\n"
+        "out vec4 fragColor;\n"
+        "void main() {\n"
+        "    fragColor = useColormap != 0 ? vec4(texture(colormap, vCoord).rgb, opacity) : vColor;\n"
+        "}";
+
+    if (!m_surfaceProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, surfaceVShader)) {
+        qDebug() << "三角网格顶点着色器编译错误:" << m_surfaceProgram->log();
+    }
+
+    if (!m_surfaceProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, surfaceFShader)) {
+        qDebug() << "三角网格片段着色器编译错误:" << m_surfaceProgram->log();
+    }
+
+    if (!m_surfaceProgram->link()) {
+        qDebug() << "三角网格着色器链接错误:" << m_surfaceProgram->log();
+    }
+
+    m_heightFieldProgram = new QOpenGLShaderProgram();
+
+    // 高度场顶点着色器：由顶点序号得到行列，从高度纹理取高度；无效单元标记后在片段着色器中丢弃
+    const char *heightFieldVShader =
+        "#version 330 core\n"
+        "uniform mat4 mvp;\n"
+        "uniform sampler2D heights;\n"
+        "uniform int cols;\n"
+        "uniform vec2 origin;\n"
+        "uniform float cellSize;\n"
+        "uniform float minHeight;\n"
+        "uniform float maxHeight;\n"
+        "uniform float tableSize;\n"
+        "out float vCoord;\n"
+        "out float vValid;\n"
+        "void main() {\n"
+        "    int col = gl_VertexID % cols;\n"
+        "    int row = gl_VertexID / cols;\n"
+        "    float h = texelFetch(heights, ivec2(col, row), 0).r;\n"
+        "    vValid = h > -1.0e5 ? 1.0 : 0.0;\n"
+        "    float z = vValid > 0.5 ? h : minHeight;\n"
+        "    float range = maxHeight - minHeight;\n"
+        "    float t = range > 0.0 ? clamp((z - minHeight) / range, 0.0, 1.0) : 0.0;\n"
+        "    vCoord = (t * (tableSize - 1.0) + 0.5) / tableSize;\n"
+        "    vec2 xy = origin + (vec2(col, row) + 0.5) * cellSize;\n"
+        "    gl_Position = mvp * vec4(xy, z, 1.0);\n"
+        "}";
+
+    const char *heightFieldFShader =
+        "#version 330 core\n"
+        "in float vCoord;\n"
+        "in float vValid;\n"
+        "uniform sampler1D colormap;\n"
+        "uniform float opacity;\n"
+        "out vec4 fragColor;\n"
+        "void main() {\n"
+        "    if (vValid < 0.999) {\n"
+        "        discard;\n"
+        "    }\n"
+        "    fragColor = vec4(texture(colormap, vCoord).rgb, opacity);\n"
+        "}";
+
+    if (!m_heightFieldProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, heightFieldVShader)) {
+        qDebug() << "高度场顶点着色器编译错误:" << m_heightFieldProgram->log();
+    }
+
+    if (!m_heightFieldProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, heightFieldFShader)) {
+        qDebug() << "高度场片段着色器编译错误:" << m_heightFieldProgram->log();
+    }
+
+    if (!m_heightFieldProgram->link()) {
+        qDebug() << "高度场着色器链接错误:" << m_heightFieldProgram->log();
+    }
+
+    setupPickPrograms();
+}
+
+static QOpenGLShaderProgram *buildPickProgram(const char *name, const char *vshader, const char *fshader)
+{
+    QOpenGLShaderProgram *program = new QOpenGLShaderProgram();
+    if (!program->addShaderFromSourceCode(QOpenGLShader::Vertex, vshader)) {
+        qDebug() << name << "拾取顶点着色器编译错误:" << program->log();
+    }
+    if (!program->addShaderFromSourceCode(QOpenGLShader::Fragment, fshader)) {
+        qDebug() << name << "拾取片段着色器编译错误:" << program->log();
+    }
+    if (!program->link()) {
+        qDebug() << name << "拾取着色器链接错误:" << program->log();
+    }
+    return program;
+}
+
+void SlagPondRenderer::setupPickPrograms()
+{
+    // 拾取着色器输出无符号整数ID（idBase + 对象序号），绘制到R32UI帧缓冲区；ID不插值
+    const char *pickFShader =
+        "#version 330 core\n"
+        "flat in uint vId;\n"
+        "out uint pickId;\n"
+        "void main() {\n"
+        "    pickId = vId;\n"
+        "}";
+
+    // 点集：顶点序号即点序号（八叉树时为节点内序号，idBase含节点偏移）
+    const char *pointVShader =
+        "#version 330 core\n"
+        "layout(location = 0) in vec3 packedPosition;\n"
+        "uniform mat4 mvp;\n"
+        "uniform vec3 boundsMin;\n"
+        "uniform vec3 boundsSize;\n"
+        "uniform uint idBase;\n"
+        "flat out uint vId;\n"
+        "void main() {\n"
+        "    vId = idBase + uint(gl_VertexID);\n"
+        "    gl_Position = mvp * vec4(boundsMin + packedPosition * boundsSize, 1.0);\n"
+        "}";
+    m_pointPickProgram = buildPickProgram("点集", pointVShader, pickFShader);
+
+    // 三角网格：glDrawElements下gl_VertexID为索引值，取三角形的最后一个顶点
+    const char *surfaceVShader =
+        "#version 330 core\n"
+        "layout(location = 0) in vec3 position;\n"
+        "uniform mat4 mvp;\n"
+        "uniform uint idBase;\n"
+        "flat out uint vId;\n"
+        "void main() {\n"
+        "    vId = idBase + uint(gl_VertexID);\n"
+        "    gl_Position = mvp * vec4(position, 1.0);\n"
+        "}";
+    m_surfacePickProgram = buildPickProgram("三角网格", surfaceVShader, pickFShader);
+
+    // 高度场：顶点在单元中心，片段按所在位置换算单元，光标落在哪个单元就返回哪个
+    const char *heightFieldVShader =
+        "#version 330 core\n"
+        "uniform mat4 mvp;\n"
+        "uniform sampler2D heights;\n"
+        "uniform int cols;\n"
+        "uniform vec2 origin;\n"
+        "uniform float cellSize;\n"
+        "out vec2 vXY;\n"
+        "out float vValid;\n"
+        "void main() {\n"
+        "    int col = gl_VertexID % cols;\n"
+        "    int row = gl_VertexID / cols;\n"
+        "    float h = texelFetch(heights, ivec2(col, row), 0).r;\n"
+        "    vValid = h > -1.0e5 ? 1.0 : 0.0;\n"
+        "    vXY = origin + (vec2(col, row) + 0.5) * cellSize;\n"
+        "    gl_Position = mvp * vec4(vXY, vValid > 0.5 ? h : 0.0, 1.0);\n"
+        "}";
+
+    const char *heightFieldFShader =
+        "#version 330 core\n"
+        "in vec2 vXY;\n"
+        "in float vValid;\n"
+        "uniform int cols;\n"
+        "uniform int rows;\n"
+        "uniform vec2 origin;\n"
+        "uniform float cellSize;\n"
+        "uniform uint idBase;\n"
+        "out uint pickId;\n"
+        "void main() {\n"
+        "    if (vValid < 0.999) {\n"
+        "        discard;\n"
+        "    }\n"
+        "    ivec2 cell = clamp(ivec2(floor((vXY - origin) / cellSize)), ivec2(0), ivec2(cols - 1, rows - 1));\n"
+        "    pickId = idBase + uint(cell.y * cols + cell.x);\n"
+        "}";
+    m_heightFieldPickProgram = buildPickProgram("高度场", heightFieldVShader, heightFieldFShader);
+}
+
+void SlagPondRenderer::updateColormapTexture()
+{
+    if (!m_colormapDirty && m_colormapTexture) {
+        return;
+    }
+
+    if (!m_colorTableValid) {
+        buildColorLookupTable();
+    }
+
+    // 透明度由uniform控制，纹理只保存RGB
+    QVector<quint8> texels(COLOR_TABLE_SIZE * 4);
+    for (int i = 0; i < COLOR_TABLE_SIZE; ++i) {
+        const QVector4D &c = m_colorLookupTable[i];
+        texels[i * 4 + 0] = static_cast<quint8>(qBound(0.0f, c.x(), 1.0f) * 255.0f + 0.5f);
+        texels[i * 4 + 1] = static_cast<quint8>(qBound(0.0f, c.y(), 1.0f) * 255.0f + 0.5f);
+        texels[i * 4 + 2] = static_cast<quint8>(qBound(0.0f, c.z(), 1.0f) * 255.0f + 0.5f);
+        texels[i * 4 + 3] = 255;
+    }
+
+    if (!m_colormapTexture) {
+        m_colormapTexture = new QOpenGLTexture(QOpenGLTexture::Target1D);
+        m_colormapTexture->setSize(COLOR_TABLE_SIZE);
+        m_colormapTexture->setFormat(QOpenGLTexture::RGBA8_UNorm);
+        m_colormapTexture->setMipLevels(1);
+        m_colormapTexture->allocateStorage(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8);
+        m_colormapTexture->setMinMagFilters(QOpenGLTexture::Linear, QOpenGLTexture::Linear);
+        m_colormapTexture->setWrapMode(QOpenGLTexture::ClampToEdge);
+    }
+    m_colormapTexture->setData(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8, texels.constData());
+
+    m_colormapDirty = false;
+}
+
+void SlagPondRenderer::updateColorGradient()
+{
+    m_colorTableValid = false;
+    buildColorLookupTable();
+    // 点集颜色在GPU上查表，只需重新上传颜色纹理
+    m_colormapDirty = true;
+}
+
+void SlagPondRenderer::buildColorLookupTable()
+{
+    m_colorLookupTable.clear();
+    m_colorLookupTable.resize(COLOR_TABLE_SIZE);
+
+    if (m_colorGradient.isEmpty()) {
+        // 回退到简单渐变
+        for (int i = 0; i < COLOR_TABLE_SIZE; ++i) {
+            float t = static_cast<float>(i) / (COLOR_TABLE_SIZE - 1);
+            m_colorLookupTable[i] = QVector4D(
+                m_lowColor.x() * (1.0f - t) + m_highColor.x() * t,
+                m_lowColor.y() * (1.0f - t) + m_highColor.y() * t,
+                m_lowColor.z() * (1.0f - t) + m_highColor.z() * t,
+                m_surfaceOpacity
+                );
+        }
+    } else {
+        // 使用多段渐变
+        QList<float> keys = m_colorGradient.keys();
+        std::sort(keys.begin(), keys.end());
+        for (int i = 0; i < COLOR_TABLE_SIZE; ++i) {
+            float t = static_cast<float>(i) / (COLOR_TABLE_SIZE - 1);
+
+            // 找到t所在的分段
+            auto it = m_colorGradient.upperBound(t);
+            if (it == m_colorGradient.begin()) {
+                QColor color = m_colorGradient.first();
+                m_colorLookupTable[i] = QVector4D(
+                    color.redF(), color.greenF(), color.blueF(), m_surfaceOpacity
+                    );
+            } else if (it == m_colorGradient.end()) {
+                QColor color = m_colorGradient.last();
+                m_colorLookupTable[i] = QVector4D(
+                    color.redF(), color.greenF(), color.blueF(), m_surfaceOpacity
+                    );
+            } else {
+                auto next = it;
+                auto prev = it--;
+
+                float t1 = prev.key();
+                float t2 = next.key();
+                float segmentT = (t - t1) / (t2 - t1);
+                segmentT = qBound(0.0f, segmentT, 1.0f);
+
+                QColor c1 = prev.value();
+                QColor c2 = next.value();
+
+                float r = c1.redF() * (1.0f - segmentT) + c2.redF() * segmentT;
+                float g = c1.greenF() * (1.0f - segmentT) + c2.greenF() * segmentT;
+                float b = c1.blueF() * (1.0f - segmentT) + c2.blueF() * segmentT;
+
+                m_colorLookupTable[i] = QVector4D(r, g, b, m_surfaceOpacity);
+            }
+        }
+    }
+
+    m_colorTableValid = true;
+    qDebug() << "颜色查找表构建完成，大小:" << COLOR_TABLE_SIZE;
+}
+
+void SlagPondRenderer::buildSceneGeometry()
+{
+    // 网格、坐标轴、刻度和填充面只与视角有关，四个视角的数据依次写入同一个缓冲区，
+    // 切换视角只换子区间；同一上下文中的所有视图共用
+    QVector<Vertex> vertices;
+    vertices.reserve(4 * 512);
+
+    auto beginRange = [&]() {
+        DrawRange range;
+        range.first = vertices.size();
+        return range;
+    };
+    auto endRange = [&](DrawRange &range) {
+        range.count = vertices.size() - range.first;
+    };
+
+    for (int perspective = 0; perspective < 4; ++perspective) {
+        SceneRanges &ranges = m_sceneRanges[perspective];
+
+        ranges.grid = beginRange();
+        appendGridVertices(perspective, vertices);
+        endRange(ranges.grid);
+
+        ranges.ticks = beginRange();
+        appendTickVertices(perspective, vertices);
+        endRange(ranges.ticks);
+
+        for (int i = 0; i < 5; ++i) {
+            float transparency = 0.4f;
+
+            switch (perspective) {
+            case 0: transparency = (i == 1 || i == 2) ? 0.2f : 0.4f; break;
+            case 1: transparency = (i == 2 || i == 3) ? 0.2f : 0.4f; break;
+            case 2: transparency = (i == 3 || i == 4) ? 0.2f : 0.4f; break;
+            case 3: transparency = (i == 4 || i == 1) ? 0.2f : 0.4f; break;
+            }
+
+            ranges.fills[i] = beginRange();
+            appendFillVertices(i, transparency, vertices);
+            endRange(ranges.fills[i]);
+        }
+    }
+
+    if (!m_sceneBuffer.isCreated()) {
+        m_sceneBuffer.create();
+        m_sceneBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    }
+    if (!m_vaoScene) {
+        m_vaoScene = new QOpenGLVertexArrayObject();
+        m_vaoScene->create();
+    }
+
+    // 缓冲区不再变化，顶点属性一次记录在VAO中
+    m_vaoScene->bind();
+    m_sceneBuffer.bind();
+    m_sceneBuffer.allocate(vertices.constData(), vertices.size() * sizeof(Vertex));
+    setVertexAttributes(m_shaderProgram, VertexColored);
+    m_vaoScene->release();
+    m_sceneBuffer.release();
+
+    qDebug() << "静态场景几何体构建完成，顶点数:" << vertices.size()
+             << "，大小:" << vertices.size() * sizeof(Vertex) / 1024.0f << "KB";
+}
+
+void SlagPondRenderer::appendGridVertices(int perspective, QVector<Vertex> &vertices) const
+{
+    const int lengthSegments = static_cast<int>(m_length / GRID_SIZE);
+    const int widthSegments = static_cast<int>(m_width / GRID_SIZE);
+    const int heightSegments = static_cast<int>(m_height / GRID_SIZE);
+
+    auto addLine = [&](float x1, float y1, float z1, float x2, float y2, float z2) {
+        vertices.append(Vertex(x1 - m_length/2, y1 - m_width/2, z1 - m_height / 2, 0.8f, 0.8f, 0.8f, 1.0f));
+        vertices.append(Vertex(x2 - m_length/2, y2 - m_width/2, z2 - m_height / 2, 0.8f, 0.8f, 0.8f, 1.0f));
+    };
+
+    // 底部网格
+    for (int i = 0; i <= lengthSegments; ++i) {
+        float x = i * GRID_SIZE;
+        addLine(x, 0.0f, 0.0f, x, m_width, 0.0f);
+    }
+    for (int i = 0; i <= widthSegments; ++i) {
+        float y = i * GRID_SIZE;
+        addLine(0.0f, y, 0.0f, m_length, y, 0.0f);
+    }
+
+    // 侧面网格
+    switch (perspective) {
+    case 0: // 后面和右面
+        for (int i = 0; i <= lengthSegments; ++i) {
+            float x = i * GRID_SIZE;
+            addLine(x, m_width, 0.0f, x, m_width, m_height);
+        }
+        for (int i = 0; i <= heightSegments; ++i) {
+            float z = i * GRID_SIZE;
+            addLine(0.0f, m_width, z, m_length, m_width, z);
+        }
+        for (int i = 0; i <= widthSegments; ++i) {
+            float y = i * GRID_SIZE;
+            addLine(m_length, y, 0.0f, m_length, y, m_height);
+        }
+        for (int i = 0; i <= heightSegments; ++i) {
+            float z = i * GRID_SIZE;
+            addLine(m_length, 0.0f, z, m_length, m_width, z);
+        }
+        break;
+
+    case 1: // 后面和左面
+        for (int i = 0; i <= lengthSegments; ++i) {
+            float x = i * GRID_SIZE;
+            addLine(x, m_width, 0.0f, x, m_width, m_height);
+        }
+        for (int i = 0; i <= heightSegments; ++i) {
+            float z = i * GRID_SIZE;
+            addLine(0.0f, m_width, z, m_length, m_width, z);
+        }
+        for (int i = 0; i <= widthSegments; ++i) {
+            float y = i * GRID_SIZE;
+            addLine(0.0f, y, 0.0f, 0.0f, y, m_height);
+        }
+        for (int i = 0; i <= heightSegments; ++i) {
+            float z = i * GRID_SIZE;
+            addLine(0.0f, 0.0f, z, 0.0f, m_width, z);
+        }
+        break;
+
+    case 2: // 前面和左面
+        for (int i = 0; i <= lengthSegments; ++i) {
+            float x = i * GRID_SIZE;
+            addLine(x, 0.0f, 0.0f, x, 0.0f, m_height);
+        }
+        for (int i = 0; i <= heightSegments; ++i) {
+            float z = i * GRID_SIZE;
+            addLine(0.0f, 0.0f, z, m_length, 0.0f, z);
+        }
+        for (int i = 0; i <= widthSegments; ++i) {
+            float y = i * GRID_SIZE;
+            addLine(0.0f, y, 0.0f, 0.0f, y, m_height);
+        }
+        for (int i = 0; i <= heightSegments; ++i) {
+            float z = i * GRID_SIZE;
+            addLine(0.0f, 0.0f, z, 0.0f, m_width, z);
+        }
+        break;
+
+    case 3: // 前面和右面
+        for (int i = 0; i <= lengthSegments; ++i) {
+            float x = i * GRID_SIZE;
+            addLine(x, 0.0f, 0.0f, x, 0.0f, m_height);
+        }
+        for (int i = 0; i <= heightSegments; ++i) {
+            float z = i * GRID_SIZE;
+            addLine(0.0f, 0.0f, z, m_length, 0.0f, z);
+        }
+        for (int i = 0; i <= widthSegments; ++i) {
+            float y = i * GRID_SIZE;
+            addLine(m_length, y, 0.0f, m_length, y, m_height);
+        }
+        for (int i = 0; i <= heightSegments; ++i) {
+            float z = i * GRID_SIZE;
+            addLine(m_length, 0.0f, z, m_length, m_width, z);
+        }
+        break;
+    }
+
+    // 顺手添加一下坐标轴的数据
+    // X轴
+    vertices.append(Vertex(-1.0f - m_length/2, -1.0f - m_width/2, -1.0f - m_height / 2, 1.0f, 0.0f, 0.0f, 1.0f));
+    vertices.append(Vertex(5.0f - m_length/2, -1.0f - m_width/2, -1.0f - m_height / 2, 1.0f, 0.0f, 0.0f, 1.0f));
+    // Y轴
+    vertices.append(Vertex(-1.0f - m_length/2, -1.0f - m_width/2, -1.0f - m_height / 2, 0.0f, 1.0f, 0.0f, 1.0f));
+    vertices.append(Vertex(-1.0f - m_length/2, 5.0f - m_width/2, -1.0f - m_height / 2, 0.0f, 1.0f, 0.0f, 1.0f));
+    // Z轴
+    vertices.append(Vertex(-1.0f - m_length/2, -1.0f - m_width/2, -1.0f - m_height / 2, 0.0f, 0.0f, 1.0f, 1.0f));
+    vertices.append(Vertex(-1.0f - m_length/2, -1.0f - m_width/2, 5.0f - m_height / 2, 0.0f, 0.0f, 1.0f, 1.0f));
+}
+
+void SlagPondRenderer::appendFillVertices(int face, float transparency, QVector<Vertex> &out) const
+{
+    if (face < 0 || face > 4) return;
+
+    float depth = 0.5f;
+    QVector<Vertex> vertices;
+    QVector<unsigned int> indices;
+
+    vertices.reserve(8);
+    indices.reserve(12);
+
+    switch (face) {
+    case 0: { // 底面
+        float r = depth, g = depth, b = depth, a = transparency;
+        vertices << Vertex(-m_length / 2, -m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, -m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, -m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, -m_width / 2, 0.0f - m_height / 2, r, g, b, a);
+        indices << 0 << 1 << 2 << 2 << 3 << 0 << 4 << 5 << 6 << 6 << 7 << 4;
+        break;
+    }
+    case 1: { // 左面
+        float r = depth, g = depth, b = depth, a = transparency;
+        vertices << Vertex(-m_length / 2, -m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, -m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, -m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, -m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, m_width / 2, 0.0f - m_height / 2, r, g, b, a);
+        indices << 0 << 1 << 2 << 2 << 3 << 0 << 4 << 5 << 6 << 6 << 7 << 4;
+        break;
+    }
+    case 2: { // 前面
+        float r = depth, g = depth, b = depth, a = transparency;
+        vertices << Vertex(-m_length / 2, -m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, -m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, -m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, -m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, -m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, -m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, -m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, -m_width / 2, 0.0f - m_height / 2, r, g, b, a);
+        indices << 0 << 1 << 2 << 2 << 3 << 0 << 4 << 5 << 6 << 6 << 7 << 4;
+        break;
+    }
+    case 3: { // 右面
+        float r = depth, g = depth, b = depth, a = transparency;
+        vertices << Vertex(m_length / 2, -m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, -m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, -m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, -m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, m_width / 2, 0.0f - m_height / 2, r, g, b, a);
+        indices << 0 << 1 << 2 << 2 << 3 << 0 << 4 << 5 << 6 << 6 << 7 << 4;
+        break;
+    }
+    case 4: { // 后面
+        float r = depth, g = depth, b = depth, a = transparency;
+        vertices << Vertex(-m_length / 2, m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, m_width / 2, 0.0f - m_height / 2, r, g, b, a)
+                 << Vertex(-m_length / 2, m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, m_width / 2, m_height - m_height / 2, r, g, b, a)
+                 << Vertex(m_length / 2, m_width / 2, 0.0f - m_height / 2, r, g, b, a);
+        indices << 0 << 1 << 2 << 2 << 3 << 0 << 4 << 5 << 6 << 6 << 7 << 4;
+        break;
+    }
+    }
+
+    // 展开为不带索引的三角形，便于与其它静态几何体共用一个缓冲区
+    for (unsigned int index : indices) {
+        out.append(vertices[index]);
+    }
+}
+
+void SlagPondRenderer::appendTickVertices(int perspective, QVector<Vertex> &tickVertices) const
+{
+    auto addTick = [&](float x1, float y1, float z1, float x2, float y2, float z2) {
+        tickVertices.append(Vertex(x1 - m_length/2, y1 - m_width/2, z1 - m_height / 2, 0.8f, 0.8f, 0.8f, 1.0f));
+        tickVertices.append(Vertex(x2 - m_length/2, y2 - m_width/2, z1 - m_height / 2, 0.8f, 0.8f, 0.8f, 1.0f));
+    };
+
+    int tickMarkSize = GRID_SIZE / 5;
+    float tickMarkLength = 0.5f;
+    // // x轴刻度
+    // for (int i = tickMarkSize; i <= m_length; i += tickMarkSize) {
+    //     addTick(i, 0.0f, 0.0f, i, -0.3f, 0.0f);
+    // }
+
+    // // y轴刻度
+    // for (int i = 0; i <= m_width; i += tickMarkSize) {
+    //     addTick(0.0f, i, 0.0f, -0.3f, i, 0.0f);
+    // }
+
+    // // z轴刻度
+    // for (int i = 0; i <= m_height; i += tickMarkSize) {
+    //     addTick(0.0f, m_width, i, -0.3f, m_width, i);
+    // }
+    switch (perspective) {
+    case 0:
+        for (int i = tickMarkSize; i <= m_length; i += tickMarkSize) {
+            addTick(i, 0.0f, 0.0f, i, -tickMarkLength, 0.0f);
+        }
+
+        // y轴刻度
+        for (int i = 0; i <= m_width; i += tickMarkSize) {
+            addTick(0.0f, i, 0.0f, -tickMarkLength, i, 0.0f);
+        }
+
+        // z轴刻度
+        for (int i = 0; i <= m_height; i += tickMarkSize) {
+            addTick(0.0f, m_width, i, -tickMarkLength, m_width, i);
+        }
+        break;
+    case 1:
+        for (int i = tickMarkSize; i <= m_width; i += tickMarkSize) {
+            addTick(m_length, i, 0.0f, m_length + tickMarkLength, i, 0.0f);
+        }
+
+        for (int i = 0; i <= m_length; i += tickMarkSize) {
+            addTick(i, 0.0f, 0.0f, i, -tickMarkLength, 0.0f);
+        }
+
+        // z轴刻度
+        for (int i = 0; i <= m_height; i += tickMarkSize) {
+            addTick(0.0f, 0.0f, i, 0.0f, -tickMarkLength, i);
+        }
+        break;
+    case 2:
+        for (int i = tickMarkSize; i <= m_length; i += tickMarkSize) {
+            addTick(m_length - i, m_width, 0.0f, m_length - i, m_width + tickMarkLength, 0.0f);
+        }
+
+        // y轴刻度
+        for (int i = 0; i <= m_width; i += tickMarkSize) {
+            addTick(m_length, m_width - i, 0.0f, m_length + tickMarkLength, m_width - i, 0.0f);
+        }
+
+        // z轴刻度
+        for (int i = 0; i <= m_height; i += tickMarkSize) {
+            addTick(m_length, 0, i, m_length + tickMarkLength, 0, i);
+        }
+        break;
+    case 3:
+        for (int i = tickMarkSize; i <= m_width; i += tickMarkSize) {
+            addTick(0.0f, m_width - i, 0.0f, -tickMarkLength, m_width - i, 0.0f);
+        }
+
+        // y轴刻度
+        for (int i = 0; i <= m_length; i += tickMarkSize) {
+            addTick(i, m_width, 0.0f, i, m_width + tickMarkLength, 0.0f);
+        }
+
+        // z轴刻度
+        for (int i = 0; i <= m_height; i += tickMarkSize) {
+            addTick(m_length, m_width, i, m_length, m_width + tickMarkLength, i);
+        }
+        break;
+    }
+}
+
+void SlagPondRenderer::setVertexAttributes(QOpenGLShaderProgram *program, VertexFormat format, int offset, int step)
+{
+    static_assert(sizeof(Vertex) == 16, "Vertex应为16字节");
+    static_assert(sizeof(PackedPoint) == 6, "PackedPoint应为6字节");
+
+    // 整数类型的属性由setAttributeBuffer按归一化方式读取（RGBA8 -> [0,1]，16位位置 -> [0,1]）
+    switch (format) {
+    case VertexColored:
+        program->enableAttributeArray(0);
+        program->enableAttributeArray(1);
+        program->setAttributeBuffer(0, GL_FLOAT, offset + offsetof(Vertex, x), 3, sizeof(Vertex) * step);
+        program->setAttributeBuffer(1, GL_UNSIGNED_BYTE, offset + offsetof(Vertex, r), 4, sizeof(Vertex) * step);
+        break;
+    case VertexQuantized:
+        program->enableAttributeArray(0);
+        program->setAttributeBuffer(0, GL_UNSIGNED_SHORT, offset, 3, sizeof(PackedPoint) * step);
+        break;
+    }
+}
+
+void SlagPondRenderer::releaseVertexAttributes(QOpenGLShaderProgram *program, VertexFormat format)
+{
+    program->disableAttributeArray(0);
+    if (format == VertexColored) {
+        program->disableAttributeArray(1);
+    }
+}
+
+void SlagPondRenderer::drawRange(const DrawRange &range, GLenum mode)
+{
+    if (!m_vaoScene || range.count <= 0) {
+        return;
+    }
+
+    m_vaoScene->bind();
+    glDrawArrays(mode, range.first, range.count);
+    m_vaoScene->release();
+}
+
+void SlagPondRenderer::drawGrid(int perspective)
+{
+    glLineWidth(1.0f);
+    drawRange(m_sceneRanges[perspective].grid, GL_LINES);
+}
+
+void SlagPondRenderer::drawTickMarks(int perspective)
+{
+    glLineWidth(1.0f);
+    drawRange(m_sceneRanges[perspective].ticks, GL_LINES);
+}
+
+void SlagPondRenderer::drawFillGeometry(int perspective, int face)
+{
+    if (face < 0 || face >= 5) {
+        return;
+    }
+    drawRange(m_sceneRanges[perspective].fills[face], GL_TRIANGLES);
+}
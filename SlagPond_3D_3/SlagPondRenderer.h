@@ -0,0 +1,128 @@
+#ifndef SLAGPONDRENDERER_H
+#define SLAGPONDRENDERER_H
+
+#include <QOpenGLFunctions>
+#include <QOpenGLBuffer>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLTexture>
+#include <QVector4D>
+#include <QVector>
+#include <QColor>
+#include <QMap>
+#include <array>
+
+// 同一上下文中所有视图共用的OpenGL资源：着色器程序、静态场景几何体（网格、刻度、填充面）和颜色纹理
+// 每个上下文只需一份，各视图（SlagPondView）按自己的视角和变换矩阵引用
+class SlagPondRenderer : protected QOpenGLFunctions
+{
+public:
+    // 带颜色的顶点：浮点位置 + RGBA8颜色，16字节（网格、填充面、三角网格、等高线、标记）
+    struct Vertex {
+        float x, y, z;
+        quint8 r, g, b, a;
+
+        Vertex(float px = 0, float py = 0, float pz = 0,
+               float pr = 0, float pg = 0, float pb = 0, float pa = 0)
+            : x(px), y(py), z(pz)
+            , r(toByte(pr)), g(toByte(pg)), b(toByte(pb)), a(toByte(pa)) {}
+
+        static quint8 toByte(float c) { return static_cast<quint8>(qBound(0.0f, c, 1.0f) * 255.0f + 0.5f); }
+    };
+
+    // 各缓冲区的顶点格式，绘制时按格式设置顶点属性
+    enum VertexFormat {
+        VertexColored,
+        VertexQuantized
+    };
+
+    static const int COLOR_TABLE_SIZE = 256;
+
+    SlagPondRenderer();
+
+    // 上下文为当前时调用
+    void initialize();
+    void destroy();
+    bool isInitialized() const { return m_shaderProgram != nullptr; }
+
+    // 通用着色器（位置 + 顶点颜色）
+    QOpenGLShaderProgram *colorProgram() const { return m_shaderProgram; }
+    // 点集着色器：顶点只含位置，颜色由高度范围uniform和颜色纹理在GPU上计算
+    QOpenGLShaderProgram *pointProgram() const { return m_pointShaderProgram; }
+    // 三角网格着色器：顶点为位置 + 颜色，useColormap为1时忽略顶点颜色，按高度从颜色纹理取色
+    QOpenGLShaderProgram *surfaceProgram() const { return m_surfaceProgram; }
+    // 高度场着色器：顶点序号即单元序号，高度取自纹理
+    QOpenGLShaderProgram *heightFieldProgram() const { return m_heightFieldProgram; }
+    // 拾取着色器：输出对象ID（uniform idBase + 序号），用于绘制到PickBuffer
+    QOpenGLShaderProgram *pointPickProgram() const { return m_pointPickProgram; }
+    QOpenGLShaderProgram *surfacePickProgram() const { return m_surfacePickProgram; }
+    QOpenGLShaderProgram *heightFieldPickProgram() const { return m_heightFieldPickProgram; }
+
+    // offset为缓冲区内的起始字节，step>1时每隔step个顶点取一个（按步长抽稀绘制）
+    void setVertexAttributes(QOpenGLShaderProgram *program, VertexFormat format, int offset = 0, int step = 1);
+    void releaseVertexAttributes(QOpenGLShaderProgram *program, VertexFormat format);
+
+    // 静态场景几何体，按视角绘制对应子区间（需已绑定通用着色器）
+    void drawGrid(int perspective);
+    void drawTickMarks(int perspective);
+    void drawFillGeometry(int perspective, int face);
+
+    // 颜色渐变和查找表，查找表同时上传为一维纹理供着色器按高度取色
+    void updateColorGradient();
+    void updateColormapTexture();
+    QOpenGLTexture *colormapTexture() const { return m_colormapTexture; }
+    float opacity() const { return m_surfaceOpacity; }
+
+private:
+    // 静态场景几何体：四个视角全部在初始化时写入同一个VBO，每帧按视角的子区间绘制
+    struct DrawRange {
+        int first = 0;
+        int count = 0;
+    };
+    struct SceneRanges {
+        DrawRange grid;
+        DrawRange ticks;
+        std::array<DrawRange, 5> fills;
+    };
+
+    void setupShaderProgram();
+    void setupPickPrograms();
+    void buildSceneGeometry();
+    void appendGridVertices(int perspective, QVector<Vertex> &vertices) const;
+    void appendTickVertices(int perspective, QVector<Vertex> &vertices) const;
+    void appendFillVertices(int face, float transparency, QVector<Vertex> &vertices) const;
+    void drawRange(const DrawRange &range, GLenum mode);
+
+    void buildColorLookupTable();
+
+    QOpenGLShaderProgram *m_shaderProgram = nullptr;
+    QOpenGLShaderProgram *m_pointShaderProgram = nullptr;
+    QOpenGLShaderProgram *m_surfaceProgram = nullptr;
+    QOpenGLShaderProgram *m_heightFieldProgram = nullptr;
+    QOpenGLShaderProgram *m_pointPickProgram = nullptr;
+    QOpenGLShaderProgram *m_surfacePickProgram = nullptr;
+    QOpenGLShaderProgram *m_heightFieldPickProgram = nullptr;
+
+    std::array<SceneRanges, 4> m_sceneRanges;
+    QOpenGLBuffer m_sceneBuffer;
+    QOpenGLVertexArrayObject *m_vaoScene = nullptr;
+
+    // 颜色查找表
+    QVector<QVector4D> m_colorLookupTable;
+    bool m_colorTableValid = false;
+    QOpenGLTexture *m_colormapTexture = nullptr;
+    bool m_colormapDirty = true;
+
+    // 颜色渐变相关
+    QVector4D m_lowColor;
+    QVector4D m_highColor;
+    QMap<float, QColor> m_colorGradient;
+    float m_surfaceOpacity;
+
+    // 地形尺寸
+    const float m_length = 25.0f;
+    const float m_width = 25.0f;
+    const float m_height = 25.0f;
+};
+
+#endif // SLAGPONDRENDERER_H
@@ -0,0 +1,1670 @@
+#include "SlagPondView.h"
+#include "RangeImage.h"
+#include "SurfaceMesh.h"
+#include "HeightGrid.h"
+#include "CoordinateTransform.h"
+#include <QOpenGLContext>
+#include <QVector3D>
+#include <QVector2D>
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QMessageBox>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtMath>
+#include <cmath>
+#include <algorithm>
+
+SlagPondView::SlagPondView(QObject *parent)
+    : QObject(parent)
+    , m_titleColor(Qt::white)
+    , m_rotation(QQuaternion::fromAxisAndAngle(QVector3D(0, 0, 1), 0.0f))
+    , m_vaoPoints(nullptr)
+    , m_perspective(0)  // 初始视角设为0
+    , m_minHeight(0.0f)
+    , m_maxHeight(8.0f)
+    , m_pointsCount(0)
+    , m_pointsColor(1.0f, 0.0f, 0.0f, 1.0f)
+    , m_pointsSize(2.0f)
+    , m_pointsDirty(false)
+    , m_transformDirty(true)
+{
+    connect(&m_octreeWatcher, &QFutureWatcher<QSharedPointer<PointOctree>>::finished,
+            this, &SlagPondView::onOctreeBuilt);
+
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(INTERACTION_IDLE_MS);
+    connect(&m_idleTimer, &QTimer::timeout, this, &SlagPondView::endInteraction);
+
+    // 设置初始视角对应的摄像机位置
+    m_xDistance = m_cameraPositions[m_perspective].x();
+    m_yDistance = m_cameraPositions[m_perspective].y();
+    m_zDistance = m_cameraPositions[m_perspective].z();
+
+    // 初始化视图矩阵
+    m_view.setToIdentity();
+    m_view.lookAt(QVector3D(m_xDistance, m_yDistance, m_zDistance),
+                  QVector3D(0, 0, 0),
+                  QVector3D(0, 0, 1));
+}
+
+SlagPondView::~SlagPondView()
+{
+    // GL资源须由宿主在上下文当前时调用cleanup释放，这里只等待后台构建结束
+    m_octreeWatcher.waitForFinished();
+}
+
+void SlagPondView::setTitle(const QString &title, const QColor &color)
+{
+    m_title = title;
+    m_titleColor = color;
+    emit updateRequested();
+}
+
+void SlagPondView::initialize(SlagPondRenderer *renderer, QOpenGLContext *context, bool backgroundUpload)
+{
+    initializeOpenGLFunctions();
+    m_renderer = renderer;
+
+    // 初始化点集VAO和缓冲区
+    m_vaoPoints = new QOpenGLVertexArrayObject();
+    m_vaoPoints->create();
+    if (backgroundUpload && PointUploader::isSupported()) {
+        m_pointUploader = new PointUploader(context);
+        if (m_pointUploader->isValid()) {
+            connect(m_pointUploader, &PointUploader::uploaded, this, &SlagPondView::updateRequested);
+        } else {
+            delete m_pointUploader;
+            m_pointUploader = nullptr;
+        }
+    }
+    if (!m_pointUploader) {
+        m_pointsBuffer.create();
+    }
+
+    m_gpuTimer.create();
+    m_pickBuffer.create();
+    m_uploadClock.start();
+
+    if (m_gradientDirty) {
+        m_renderer->updateColorGradient();
+        m_gradientDirty = false;
+    }
+    if (!m_points.isEmpty()) {
+        schedulePointsUpload();
+    }
+
+    m_transformDirty = true;
+    emit updateRequested();
+}
+
+void SlagPondView::cleanup()
+{
+    if (!m_renderer) {
+        return;
+    }
+
+    if (m_vaoPoints) {
+        m_vaoPoints->destroy();
+        delete m_vaoPoints;
+        m_vaoPoints = nullptr;
+    }
+
+    // 清理点集缓冲区（先停止上传线程和八叉树构建）
+    m_octreeWatcher.waitForFinished();
+    clearOctreeBuffers();
+    delete m_pointUploader;
+    m_pointUploader = nullptr;
+    m_uploadedPoints = UploadedPoints();
+    m_pointsBuffer.destroy();
+
+    // 清理三角网格
+    if (m_vaoSurface) {
+        m_vaoSurface->destroy();
+        delete m_vaoSurface;
+        m_vaoSurface = nullptr;
+    }
+    m_surfaceVertexBuffer.destroy();
+    m_surfaceIndexBuffer.destroy();
+
+    // 清理高度场
+    if (m_vaoHeightField) {
+        m_vaoHeightField->destroy();
+        delete m_vaoHeightField;
+        m_vaoHeightField = nullptr;
+    }
+    m_heightFieldIndexBuffer.destroy();
+    if (m_heightTexture) {
+        glDeleteTextures(1, &m_heightTexture);
+        m_heightTexture = 0;
+    }
+
+    // 清理等高线
+    if (m_vaoContours) {
+        m_vaoContours->destroy();
+        delete m_vaoContours;
+        m_vaoContours = nullptr;
+    }
+    m_contourBuffer.destroy();
+
+    // 清理标记点
+    if (m_vaoMarkers) {
+        m_vaoMarkers->destroy();
+        delete m_vaoMarkers;
+        m_vaoMarkers = nullptr;
+    }
+    m_markerBuffer.destroy();
+
+    m_gpuTimer.destroy();
+    m_pickBuffer.destroy();
+    m_pickRequested = false;
+    m_pickOctree.reset();
+    m_renderer = nullptr;
+}
+
+bool SlagPondView::loadCSV(const QString& filePath, char separator)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    RangeImage rangeImage;
+    QString errorString;
+    if (!rangeImage.loadCSV(filePath, separator, 1000000, &errorString)) {
+        qWarning() << errorString;
+        QMessageBox::warning(nullptr, "错误", errorString);
+        return false;
+    }
+
+    // 按默认标定换算到渣池坐标系（米）
+    CoordinateTransform transform;
+    transform.apply(rangeImage, rangeImage.takeDirtyLines());
+
+    float msTime = timer.nsecsElapsed() / 1000000.0f;
+    qDebug() << "加载文件用时:" << msTime << "ms";
+
+    float minHeight;
+    float maxHeight;
+    rangeImage.heightRange(&minHeight, &maxHeight);
+    qDebug() << "高度范围: min=" << minHeight << ", max=" << maxHeight;
+
+    timer.start();
+    // 更新点集数据
+    m_points = rangeImage.toPoints();
+    m_minHeight = minHeight;
+    m_maxHeight = maxHeight;
+    schedulePointsUpload();
+
+    // 重新构建颜色查找表（共用的渲染器尚未创建时留到initialize）
+    if (m_renderer) {
+        m_renderer->updateColorGradient();
+    } else {
+        m_gradientDirty = true;
+    }
+
+    // 请求重绘
+    emit updateRequested();
+    msTime = timer.nsecsElapsed() / 1000000.0f;
+    qDebug() << "绘制点集用时:" << msTime << "ms";
+
+    return true;
+}
+
+void SlagPondView::setPointsData(const QVector<QVector3D>& points, float minHeight, float maxHeight)
+{
+    if (points.isEmpty()) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    m_points = points;
+
+    // 计算高度范围
+    m_minHeight = minHeight;
+    m_maxHeight = maxHeight;
+
+    schedulePointsUpload();
+
+    float msTime = timer.nsecsElapsed() / 1000000.0f;
+    qDebug() << "复制数据用时:" << msTime << "ms";
+
+    timer.start();
+    emit updateRequested();
+    msTime = timer.nsecsElapsed() / 1000000.0f;
+    qDebug() << "绘制点集用时:" << msTime << "ms";
+
+}
+
+void SlagPondView::setPointsVisible(bool visible)
+{
+    m_pointsVisible = visible;
+    emit updateRequested();
+}
+
+void SlagPondView::setHeightFieldVisible(bool visible)
+{
+    m_heightFieldVisible = visible;
+    emit updateRequested();
+}
+
+void SlagPondView::setSurfaceMesh(const SurfaceMesh& mesh, float minHeight, float maxHeight,
+                                  const QVector<int>* changedVertices)
+{
+    m_minHeight = minHeight;
+    m_maxHeight = maxHeight;
+
+    // 顶点数不变时只复制变化的顶点，高度范围只影响着色器uniform
+    const QVector<QVector3D> &positions = mesh.positions();
+    if (changedVertices && !m_surfaceDirty && positions.size() == m_surfacePositions.size()) {
+        for (int i : *changedVertices) {
+            m_surfacePositions[i] = positions[i];
+        }
+        markSurfaceVertices(*changedVertices);
+    } else {
+        m_surfacePositions = positions;
+        clearSurfaceDirtyVertices();
+        m_surfaceDirty = true;
+    }
+
+    // 拓扑未变化时沿用已上传的索引缓冲区
+    if (mesh.topologyRevision() != m_surfaceTopology) {
+        m_surfaceIndices = mesh.indices();
+        m_surfaceTopology = mesh.topologyRevision();
+        m_surfaceTopologyDirty = true;
+    }
+
+    emit updateRequested();
+}
+
+void SlagPondView::setSurfaceColors(const QVector<QVector4D>& colors, const QVector<int>* changedVertices)
+{
+    // 按高度着色不使用顶点颜色，保持按高度着色时无需改写顶点
+    if (colors.isEmpty() && m_surfaceColors.isEmpty()) {
+        return;
+    }
+
+    // 已是指定颜色且数量不变时只改写变化的顶点
+    if (changedVertices && !m_surfaceDirty && m_surfaceCustomColors
+        && colors.size() == m_surfaceColors.size() && colors.size() == m_surfacePositions.size()) {
+        for (int i : *changedVertices) {
+            m_surfaceColors[i] = colors[i];
+        }
+        markSurfaceVertices(*changedVertices);
+    } else {
+        m_surfaceColors = colors;
+        clearSurfaceDirtyVertices();
+        m_surfaceDirty = true;
+    }
+    emit updateRequested();
+}
+
+void SlagPondView::markSurfaceVertices(const QVector<int>& vertices)
+{
+    // 每个顶点只记录一次，视图长时间不绘制（如窗口最小化）时待上传的顶点也不超过顶点总数
+    m_surfaceVertexDirty.resize(m_surfacePositions.size());
+    for (int i : vertices) {
+        if (!m_surfaceVertexDirty[i]) {
+            m_surfaceVertexDirty[i] = 1;
+            m_surfaceDirtyVertices.append(i);
+        }
+    }
+
+    // 变化的顶点超过一半时整体上传
+    if (m_surfaceDirtyVertices.size() > m_surfacePositions.size() / 2) {
+        clearSurfaceDirtyVertices();
+        m_surfaceDirty = true;
+    }
+}
+
+void SlagPondView::clearSurfaceDirtyVertices()
+{
+    for (int i : m_surfaceDirtyVertices) {
+        m_surfaceVertexDirty[i] = 0;
+    }
+    m_surfaceDirtyVertices.clear();
+}
+
+void SlagPondView::setHeightField(const HeightGrid& grid, float minHeight, float maxHeight,
+                                        const QVector<int>* changedCells)
+{
+    m_minHeight = minHeight;
+    m_maxHeight = maxHeight;
+
+    const int cols = grid.cols();
+    const int rows = grid.rows();
+    const int tilesX = (cols + HEIGHT_TILE_SIZE - 1) / HEIGHT_TILE_SIZE;
+    const int tilesY = (rows + HEIGHT_TILE_SIZE - 1) / HEIGHT_TILE_SIZE;
+    const float *heights = grid.heights().constData();
+    const quint8 *valid = grid.validMask().constData();
+
+    // 尺寸或位置变化时重建网格和纹理
+    const bool resized = cols != m_heightFieldCols || rows != m_heightFieldRows
+                         || grid.originX() != m_heightFieldOriginX || grid.originY() != m_heightFieldOriginY
+                         || grid.cellSize() != m_heightFieldCellSize;
+    if (resized) {
+        m_heightFieldCols = cols;
+        m_heightFieldRows = rows;
+        m_heightFieldOriginX = grid.originX();
+        m_heightFieldOriginY = grid.originY();
+        m_heightFieldCellSize = grid.cellSize();
+        m_heightFieldTexels.resize(cols * rows);
+        m_heightFieldDirtyTiles.fill(0, tilesX * tilesY);
+        m_heightFieldResized = true;
+    }
+
+    if (resized || !changedCells) {
+        float *texels = m_heightFieldTexels.data();
+        for (int i = 0; i < cols * rows; ++i) {
+            texels[i] = valid[i] ? heights[i] : INVALID_HEIGHT;
+        }
+        m_heightFieldDirtyTiles.fill(1);
+    } else {
+        for (int cell : *changedCells) {
+            m_heightFieldTexels[cell] = valid[cell] ? heights[cell] : INVALID_HEIGHT;
+            m_heightFieldDirtyTiles[(cell / cols) / HEIGHT_TILE_SIZE * tilesX + (cell % cols) / HEIGHT_TILE_SIZE] = 1;
+        }
+    }
+
+    m_heightFieldDirty = true;
+    emit updateRequested();
+}
+
+void SlagPondView::setContourSegments(const QVector<QVector3D>& segments)
+{
+    m_contourSegments = segments;
+    m_contourDirty = true;
+    emit updateRequested();
+}
+
+void SlagPondView::setMarkers(const QVector<QVector3D>& markers)
+{
+    m_markers = markers;
+    m_markersDirty = true;
+    emit updateRequested();
+}
+
+void SlagPondView::setMeasureLine(const QVector<QVector3D>& points)
+{
+    m_measureLine = points;
+    m_markersDirty = true;
+    emit updateRequested();
+}
+
+void SlagPondView::setRegionOutline(const QPolygonF& outline)
+{
+    m_regionOutline = outline;
+    m_markersDirty = true;
+    emit updateRequested();
+}
+
+bool SlagPondView::selectionPosition(const QPoint &pos, QPointF *out) const
+{
+    if (m_viewport.isEmpty()) {
+        return false;
+    }
+
+    // 近、远裁剪面上的两点确定视线，再与z = 最高高度的平面求交（料堆上方，轮廓不被遮挡）
+    const float x = 2.0f * (pos.x() + 0.5f) / m_viewport.width() - 1.0f;
+    const float y = 1.0f - 2.0f * (pos.y() + 0.5f) / m_viewport.height();
+    const QMatrix4x4 inverse = m_mvpMatrix.inverted();
+    const QVector3D nearPoint = inverse.map(QVector3D(x, y, -1.0f));
+    const QVector3D farPoint = inverse.map(QVector3D(x, y, 1.0f));
+    const QVector3D direction = farPoint - nearPoint;
+    if (qAbs(direction.z()) < 1.0e-6f) {
+        return false;
+    }
+    const float t = (m_maxHeight - nearPoint.z()) / direction.z();
+    if (t < 0.0f) {
+        return false;
+    }
+    const QVector3D hit = nearPoint + direction * t;
+    *out = QPointF(hit.x(), hit.y());
+    return true;
+}
+
+void SlagPondView::drawPoints3D(const QVector<QVector3D>& points,
+                                      const QVector4D& pointColor,
+                                      float pointSize)
+{
+    m_points = points;
+    m_pointsColor = pointColor;
+    m_pointsSize = pointSize;
+
+    // 计算高度范围
+    if (!points.isEmpty()) {
+        m_minHeight = points[0].z();
+        m_maxHeight = points[0].z();
+
+        for (const auto& point : points) {
+            float z = point.z();
+            m_minHeight = qMin(m_minHeight, z);
+            m_maxHeight = qMax(m_maxHeight, z);
+        }
+    }
+
+    schedulePointsUpload();
+
+    // 重新构建颜色查找表（共用的渲染器尚未创建时留到initialize）
+    if (m_renderer) {
+        m_renderer->updateColorGradient();
+    } else {
+        m_gradientDirty = true;
+    }
+
+    emit updateRequested();
+}
+
+void SlagPondView::schedulePointsUpload()
+{
+    if (m_points.size() >= LOD_POINT_THRESHOLD) {
+        startOctreeBuild();
+        return;
+    }
+    m_octreePending = false;
+    if (m_octree) {
+        m_octree.reset();
+        m_octreeBuffersStale = true;
+    }
+
+    // 上传线程就绪时立即提交（只复制隐式共享的数组），否则留到paintGL中处理
+    if (m_pointUploader && !m_points.isEmpty()) {
+        m_pointUploader->submit(m_points);
+        m_pointsDirty = false;
+    } else {
+        m_pointsDirty = true;
+    }
+}
+
+void SlagPondView::startOctreeBuild()
+{
+    // 构建中又有新数据时只记下，完成后再用最新点集重建
+    if (m_octreeWatcher.isRunning()) {
+        m_octreePending = true;
+        return;
+    }
+
+    const QVector<QVector3D> points = m_points;
+    m_octreeBuilding = true;
+    m_octreeWatcher.setFuture(QtConcurrent::run([points]() {
+        QSharedPointer<PointOctree> octree = QSharedPointer<PointOctree>::create();
+        octree->build(points);
+        return octree;
+    }));
+}
+
+void SlagPondView::onOctreeBuilt()
+{
+    const QSharedPointer<PointOctree> octree = m_octreeWatcher.result();
+    m_octreeBuilding = false;
+    if (m_octreePending) {
+        m_octreePending = false;
+        startOctreeBuild();
+    }
+
+    // 构建期间已切换回小点集时丢弃结果；否则先显示本次结果，直到新的构建完成
+    if (m_points.size() < LOD_POINT_THRESHOLD) {
+        return;
+    }
+    m_octree = octree;
+    m_octreeBuffersStale = true;
+    emit updateRequested();
+}
+
+void SlagPondView::clearOctreeBuffers()
+{
+    for (OctreeNodeBuffer &node : m_octreeBuffers) {
+        node.buffer.destroy();
+    }
+    m_octreeBuffers.clear();
+    m_octreeGpuBytes = 0;
+    m_octreeBuffersStale = false;
+}
+
+void SlagPondView::updatePointsGeometry()
+{
+    if (m_octreeBuffersStale) {
+        clearOctreeBuffers();
+    }
+
+    // 后台上传：只在有新结果时切换缓冲区句柄
+    if (m_pointUploader) {
+        if (m_pointUploader->acquire(&m_uploadedPoints)) {
+            m_uploadBytes += static_cast<qint64>(m_uploadedPoints.count) * sizeof(PackedPoint);
+            m_pointsBoundsMin = m_uploadedPoints.boundsMin;
+            m_pointsBoundsSize = m_uploadedPoints.boundsSize;
+            m_pointsCount = m_uploadedPoints.count;
+        }
+        return;
+    }
+
+    if (!m_pointsDirty || m_points.isEmpty()) {
+        return;
+    }
+
+    // 点集已由标定变换换算到渣池坐标系（原点在池心），颜色在着色器中按高度查表
+    const int count = m_points.size();
+    QVector3D boundsMin;
+    QVector3D boundsSize;
+    pointBounds(m_points.constData(), count, &boundsMin, &boundsSize);
+
+    // 量化结果直接写入下一个缓冲区段，不经过中间数组，也不重新分配显存
+    PackedPoint *dst = static_cast<PackedPoint*>(m_pointsBuffer.map(count));
+    quantizePoints(m_points.constData(), count, boundsMin, boundsSize, dst);
+    m_pointsBuffer.unmap();
+    m_uploadBytes += static_cast<qint64>(count) * sizeof(PackedPoint);
+
+    m_pointsBoundsMin = boundsMin;
+    m_pointsBoundsSize = boundsSize;
+    m_pointsCount = count;
+
+    m_pointsDirty = false;
+
+    qDebug() << "更新点集几何体，点数:" << m_pointsCount
+             << "，显存:" << count * sizeof(PackedPoint) / (1024.0f * 1024.0f) << "MB";
+}
+
+void SlagPondView::updateSurfaceGeometry()
+{
+    if (!m_surfaceDirty && m_surfaceDirtyVertices.isEmpty() && !m_surfaceTopologyDirty) {
+        return;
+    }
+
+    if (!m_surfaceVertexBuffer.isCreated()) {
+        m_surfaceVertexBuffer.create();
+        m_surfaceVertexBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    }
+    if (!m_surfaceIndexBuffer.isCreated()) {
+        m_surfaceIndexBuffer.create();
+        m_surfaceIndexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    }
+
+    // 指定了顶点颜色且数量匹配时使用指定颜色，否则顶点颜色不使用，由着色器按高度取色
+    m_surfaceCustomColors = m_surfaceColors.size() == m_surfacePositions.size();
+    auto makeVertex = [this](int i) {
+        const QVector3D& p = m_surfacePositions[i];
+        if (m_surfaceCustomColors) {
+            const QVector4D& c = m_surfaceColors[i];
+            return Vertex(p.x(), p.y(), p.z(), c.x(), c.y(), c.z(), c.w());
+        }
+        return Vertex(p.x(), p.y(), p.z(), 1.0f, 1.0f, 1.0f, 1.0f);
+    };
+
+    const int vertexBytes = m_surfacePositions.size() * sizeof(Vertex);
+    m_surfaceVertexBuffer.bind();
+    if (m_surfaceDirty || m_surfaceVertexBuffer.size() != vertexBytes) {
+        m_surfaceVertices.resize(m_surfacePositions.size());
+        for (int i = 0; i < m_surfacePositions.size(); ++i) {
+            m_surfaceVertices[i] = makeVertex(i);
+        }
+
+        // 顶点数不变时原地覆盖，避免重新分配存储
+        if (m_surfaceVertexBuffer.size() == vertexBytes) {
+            m_surfaceVertexBuffer.write(0, m_surfaceVertices.constData(), vertexBytes);
+        } else {
+            m_surfaceVertexBuffer.allocate(m_surfaceVertices.constData(), vertexBytes);
+        }
+        m_uploadBytes += vertexBytes;
+    } else if (!m_surfaceDirtyVertices.isEmpty()) {
+        // 变化顶点排序后合并为连续区段写入（扫描线更新的单元成片分布）
+        std::sort(m_surfaceDirtyVertices.begin(), m_surfaceDirtyVertices.end());
+        const int count = m_surfaceDirtyVertices.size();
+        int k = 0;
+        while (k < count) {
+            const int first = m_surfaceDirtyVertices[k];
+            int last = first;
+            while (k < count && m_surfaceDirtyVertices[k] <= last + SURFACE_RUN_GAP) {
+                last = qMax(last, m_surfaceDirtyVertices[k]);
+                m_surfaceVertices[last] = makeVertex(last);
+                ++k;
+            }
+            // 区段内未变化的顶点保持原值，与缓冲区一致
+            const int bytes = (last - first + 1) * sizeof(Vertex);
+            m_surfaceVertexBuffer.write(first * sizeof(Vertex), m_surfaceVertices.constData() + first, bytes);
+            m_uploadBytes += bytes;
+        }
+    }
+    m_surfaceVertexBuffer.release();
+    clearSurfaceDirtyVertices();
+
+    if (m_surfaceTopologyDirty) {
+        m_surfaceIndexBuffer.bind();
+        m_surfaceIndexBuffer.allocate(m_surfaceIndices.constData(), m_surfaceIndices.size() * sizeof(unsigned int));
+        m_surfaceIndexBuffer.release();
+        m_surfaceIndexCount = m_surfaceIndices.size();
+        m_surfaceTopologyDirty = false;
+        m_uploadBytes += m_surfaceIndexCount * sizeof(unsigned int);
+    }
+
+    m_surfaceDirty = false;
+}
+
+void SlagPondView::updateHeightFieldGeometry()
+{
+    if (!m_heightFieldDirty) {
+        return;
+    }
+
+    const int cols = m_heightFieldCols;
+    const int rows = m_heightFieldRows;
+
+    if (m_heightFieldResized) {
+        // 每个单元格两个三角形，顶点序号 = 行 * 列数 + 列
+        QVector<unsigned int> indices;
+        indices.reserve((cols - 1) * (rows - 1) * 6);
+        for (int row = 0; row + 1 < rows; ++row) {
+            for (int col = 0; col + 1 < cols; ++col) {
+                const unsigned int i = row * cols + col;
+                indices << i << i + 1 << i + cols << i + 1 << i + cols + 1 << i + cols;
+            }
+        }
+
+        if (!m_vaoHeightField) {
+            m_vaoHeightField = new QOpenGLVertexArrayObject();
+            m_vaoHeightField->create();
+        }
+        if (!m_heightFieldIndexBuffer.isCreated()) {
+            m_heightFieldIndexBuffer.create();
+            m_heightFieldIndexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+        }
+        m_vaoHeightField->bind();
+        m_heightFieldIndexBuffer.bind();
+        m_heightFieldIndexBuffer.allocate(indices.constData(), indices.size() * sizeof(unsigned int));
+        m_vaoHeightField->release();
+        m_heightFieldIndexBuffer.release();
+        m_heightFieldIndexCount = indices.size();
+
+        if (!m_heightTexture) {
+            glGenTextures(1, &m_heightTexture);
+        }
+        glBindTexture(GL_TEXTURE_2D, m_heightTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, cols, rows, 0, GL_RED, GL_FLOAT, m_heightFieldTexels.constData());
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        m_heightFieldDirtyTiles.fill(0);
+        m_uploadBytes += static_cast<qint64>(cols) * rows * sizeof(float) + indices.size() * sizeof(unsigned int);
+        m_heightFieldResized = false;
+        m_heightFieldDirty = false;
+        qDebug() << "高度场重建，栅格:" << cols << "x" << rows << "，索引数:" << m_heightFieldIndexCount;
+        return;
+    }
+
+    // 只上传变化的块，按整幅行宽从镜像数组中直接取子矩形
+    const int tilesX = (cols + HEIGHT_TILE_SIZE - 1) / HEIGHT_TILE_SIZE;
+    int uploadedBytes = 0;
+    glBindTexture(GL_TEXTURE_2D, m_heightTexture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, cols);
+    for (int tile = 0; tile < m_heightFieldDirtyTiles.size(); ++tile) {
+        if (!m_heightFieldDirtyTiles[tile]) {
+            continue;
+        }
+        const int x0 = (tile % tilesX) * HEIGHT_TILE_SIZE;
+        const int y0 = (tile / tilesX) * HEIGHT_TILE_SIZE;
+        const int w = qMin(HEIGHT_TILE_SIZE, cols - x0);
+        const int h = qMin(HEIGHT_TILE_SIZE, rows - y0);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x0, y0, w, h, GL_RED, GL_FLOAT,
+                        m_heightFieldTexels.constData() + y0 * cols + x0);
+        uploadedBytes += w * h * sizeof(float);
+        m_heightFieldDirtyTiles[tile] = 0;
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_heightFieldDirty = false;
+    m_uploadBytes += uploadedBytes;
+}
+
+void SlagPondView::updateContourGeometry()
+{
+    if (!m_contourDirty) {
+        return;
+    }
+
+    // 等高线统一用浅色，略微抬高以免与网格面深度冲突
+    QVector<Vertex> vertices;
+    vertices.reserve(m_contourSegments.size());
+    for (const QVector3D& p : m_contourSegments) {
+        vertices.append(Vertex(p.x(), p.y(), p.z() + 0.02f, 0.95f, 0.95f, 0.95f, 1.0f));
+    }
+
+    if (!m_contourBuffer.isCreated()) {
+        m_contourBuffer.create();
+        m_contourBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    }
+
+    const int bytes = vertices.size() * sizeof(Vertex);
+    m_contourBuffer.bind();
+    if (m_contourBuffer.size() >= bytes && bytes > 0) {
+        m_contourBuffer.write(0, vertices.constData(), bytes);
+    } else {
+        m_contourBuffer.allocate(vertices.constData(), bytes);
+    }
+    m_contourBuffer.release();
+
+    m_contourVertexCount = vertices.size();
+    m_uploadBytes += bytes;
+    m_contourDirty = false;
+}
+
+void SlagPondView::updateMarkerGeometry()
+{
+    if (!m_markersDirty) {
+        return;
+    }
+
+    // 每个标记为一条竖线和一个水平十字，洋红色，第一个（最高）为白色
+    const float stem = 1.5f;
+    const float arm = 0.4f;
+    QVector<Vertex> vertices;
+    vertices.reserve(m_markers.size() * 6);
+    for (int i = 0; i < m_markers.size(); ++i) {
+        const QVector3D& p = m_markers[i];
+        const float g = i == 0 ? 1.0f : 0.0f;
+        auto addLine = [&](float x1, float y1, float z1, float x2, float y2, float z2) {
+            vertices.append(Vertex(x1, y1, z1, 1.0f, g, 1.0f, 1.0f));
+            vertices.append(Vertex(x2, y2, z2, 1.0f, g, 1.0f, 1.0f));
+        };
+        addLine(p.x(), p.y(), p.z(), p.x(), p.y(), p.z() + stem);
+        addLine(p.x() - arm, p.y(), p.z() + stem, p.x() + arm, p.y(), p.z() + stem);
+        addLine(p.x(), p.y() - arm, p.z() + stem, p.x(), p.y() + arm, p.z() + stem);
+    }
+
+    // 测量线：黄色，端点画小十字，略微抬高以免被表面遮住
+    const float lift = 0.05f;
+    const float cross = 0.2f;
+    for (int i = 0; i < m_measureLine.size(); ++i) {
+        const QVector3D p = m_measureLine[i] + QVector3D(0.0f, 0.0f, lift);
+        auto addLine = [&](const QVector3D &a, const QVector3D &b) {
+            vertices.append(Vertex(a.x(), a.y(), a.z(), 1.0f, 1.0f, 0.0f, 1.0f));
+            vertices.append(Vertex(b.x(), b.y(), b.z(), 1.0f, 1.0f, 0.0f, 1.0f));
+        };
+        addLine(p - QVector3D(cross, 0.0f, 0.0f), p + QVector3D(cross, 0.0f, 0.0f));
+        addLine(p - QVector3D(0.0f, cross, 0.0f), p + QVector3D(0.0f, cross, 0.0f));
+        if (i > 0) {
+            addLine(m_measureLine[i - 1] + QVector3D(0.0f, 0.0f, lift), p);
+        }
+    }
+
+    // 选区轮廓：青色闭合折线
+    for (int i = 0; i < m_regionOutline.size(); ++i) {
+        const QPointF &a = m_regionOutline[i];
+        const QPointF &b = m_regionOutline[(i + 1) % m_regionOutline.size()];
+        vertices.append(Vertex(a.x(), a.y(), m_maxHeight, 0.0f, 1.0f, 1.0f, 1.0f));
+        vertices.append(Vertex(b.x(), b.y(), m_maxHeight, 0.0f, 1.0f, 1.0f, 1.0f));
+    }
+
+    if (!m_markerBuffer.isCreated()) {
+        m_markerBuffer.create();
+        m_markerBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    }
+
+    m_markerBuffer.bind();
+    m_markerBuffer.allocate(vertices.constData(), vertices.size() * sizeof(Vertex));
+    m_markerBuffer.release();
+
+    m_markerVertexCount = vertices.size();
+    m_uploadBytes += vertices.size() * sizeof(Vertex);
+    m_markersDirty = false;
+}
+
+void SlagPondView::updateProjection(const QRect &viewport)
+{
+    if (viewport.size() == m_viewport.size()) {
+        m_viewport = viewport;
+        return;
+    }
+    m_viewport = viewport;
+
+    float aspect = static_cast<float>(viewport.width()) / static_cast<float>(viewport.height() ? viewport.height() : 1);
+    m_projection.setToIdentity();
+    m_projection.perspective(45.0f, aspect, 0.1f, 100.0f);
+    m_transformDirty = true;
+}
+
+void SlagPondView::render(const QRect &viewport)
+{
+    if (!m_renderer) {
+        return;
+    }
+    QElapsedTimer cpuTimer;
+    cpuTimer.start();
+
+    updateProjection(viewport);
+    if (m_interacting) {
+        adaptInteractiveBudget();
+    }
+    // 之前发起的拾取读回，完成了才取，否则下一帧再查
+    if (m_pickBuffer.isPending()) {
+        resolvePick();
+    }
+    m_gpuTimer.beginFrame();
+
+    // 只清除本图块
+    glViewport(viewport.x(), viewport.y(), viewport.width(), viewport.height());
+    glScissor(viewport.x(), viewport.y(), viewport.width(), viewport.height());
+    glEnable(GL_SCISSOR_TEST);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    QOpenGLShaderProgram *program = m_renderer->colorProgram();
+    if (!program->bind()) {
+        qDebug() << "无法绑定着色器程序";
+        glDisable(GL_SCISSOR_TEST);
+        return;
+    }
+
+    // 更新变换矩阵
+    if (m_transformDirty) {
+        QVector3D rotationCenter(0, 0, 0);
+        m_model.setToIdentity();
+        m_model.translate(rotationCenter);
+        m_model.rotate(m_rotation);
+        m_model.translate(-rotationCenter);
+
+        m_mvpMatrix = m_projection * m_view * m_model;
+        m_transformDirty = false;
+    }
+
+    program->setUniformValue("mvp", m_mvpMatrix);
+
+    // 更新点集等几何体
+    updatePointsGeometry();
+    updateSurfaceGeometry();
+    updateHeightFieldGeometry();
+    updateContourGeometry();
+    updateMarkerGeometry();
+
+    // 批量绘制
+    drawAll();
+
+    if (m_pickRequested) {
+        drawPickPass();
+    }
+
+    program->release();
+    glDisable(GL_SCISSOR_TEST);
+    m_gpuTimer.endFrame();
+    m_frameCount++;
+
+    // CPU耗时只含本视图的数据更新和命令提交；上传速率按约1秒的窗口统计
+    m_cpuStats.add(cpuTimer.nsecsElapsed() / 1000000.0f);
+    if (m_uploadClock.elapsed() >= 1000) {
+        m_uploadRate = m_uploadBytes / (1024.0f * 1024.0f) / (m_uploadClock.restart() / 1000.0f);
+        m_uploadBytes = 0;
+    }
+}
+
+void SlagPondView::drawAll()
+{
+    // 绘制半透明填充
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glDisable(GL_CULL_FACE);
+
+    static const std::array<std::array<int, 5>, 4> fillingOrders = {{
+        {1, 2, 0, 3, 4},
+        {2, 3, 0, 1, 4},
+        {3, 4, 0, 1, 2},
+        {4, 1, 0, 2, 3}
+    }};
+
+    const auto& order = fillingOrders[m_perspective];
+    m_gpuTimer.begin(GpuTimer::PassFills);
+    for (int i = 0; i < 5; ++i) {
+        m_renderer->drawFillGeometry(m_perspective, order[i]);
+    }
+    m_gpuTimer.end(GpuTimer::PassFills);
+
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+
+    // 以下均为深度测试下的不透明绘制，按计时阶段分组，顺序不影响结果
+    // 绘制网格
+    m_gpuTimer.begin(GpuTimer::PassGrid);
+    m_renderer->drawGrid(m_perspective);
+    m_gpuTimer.end(GpuTimer::PassGrid);
+
+    // 绘制刻度
+    m_gpuTimer.begin(GpuTimer::PassTicks);
+    m_renderer->drawTickMarks(m_perspective);
+    m_gpuTimer.end(GpuTimer::PassTicks);
+
+    // 绘制等高线、三角网格、高度场和标记点
+    m_gpuTimer.begin(GpuTimer::PassSurface);
+    drawContours();
+    drawSurface();
+    if (m_heightFieldVisible) {
+        drawHeightField();
+    }
+    drawMarkers();
+    m_gpuTimer.end(GpuTimer::PassSurface);
+
+    // 绘制点集
+    m_gpuTimer.begin(GpuTimer::PassPoints);
+    if (m_pointsVisible) {
+        drawPoints();
+    }
+    m_gpuTimer.end(GpuTimer::PassPoints);
+}
+
+void SlagPondView::requestPick(const QPoint &pos)
+{
+    m_pickPos = pos;
+    m_pickRequested = true;
+    emit updateRequested();
+}
+
+void SlagPondView::drawPickPass()
+{
+    if (!m_pickBuffer.isCreated()) {
+        m_pickRequested = false;
+        return;
+    }
+    // 上一次读回未完成时推迟到下一帧
+    if (!m_pickBuffer.begin()) {
+        emit updateRequested();
+        return;
+    }
+    m_pickRequested = false;
+
+    // 光标周围SIZE x SIZE像素放大到整个裁剪空间：先缩放再把光标平移到中心，深度不变
+    const float size = PickBuffer::SIZE;
+    const float cx = m_pickPos.x() + 0.5f;
+    const float cy = m_viewport.height() - m_pickPos.y() - 0.5f;
+    QMatrix4x4 pickMatrix;
+    pickMatrix.translate((m_viewport.width() - 2.0f * cx) / size, (m_viewport.height() - 2.0f * cy) / size, 0.0f);
+    pickMatrix.scale(m_viewport.width() / size, m_viewport.height() / size, 1.0f);
+    const QMatrix4x4 mvp = pickMatrix * m_mvpMatrix;
+
+    glDisable(GL_CULL_FACE);
+
+    // 三角网格
+    if (m_surfaceIndexCount > 0 && m_vaoSurface) {
+        QOpenGLShaderProgram *program = m_renderer->surfacePickProgram();
+        program->bind();
+        program->setUniformValue("mvp", mvp);
+        program->setUniformValue("idBase", PickBuffer::encode(PickResult::SurfaceVertex, 0));
+        m_vaoSurface->bind();
+        m_surfaceVertexBuffer.bind();
+        m_surfaceIndexBuffer.bind();
+        m_renderer->setVertexAttributes(program, SlagPondRenderer::VertexColored);
+        glDrawElements(GL_TRIANGLES, m_surfaceIndexCount, GL_UNSIGNED_INT, nullptr);
+        m_renderer->releaseVertexAttributes(program, SlagPondRenderer::VertexColored);
+        m_surfaceIndexBuffer.release();
+        m_surfaceVertexBuffer.release();
+        m_vaoSurface->release();
+    }
+
+    // 高度场
+    if (m_heightFieldVisible && m_heightFieldIndexCount > 0 && m_heightTexture) {
+        QOpenGLShaderProgram *program = m_renderer->heightFieldPickProgram();
+        program->bind();
+        program->setUniformValue("mvp", mvp);
+        program->setUniformValue("cols", m_heightFieldCols);
+        program->setUniformValue("rows", m_heightFieldRows);
+        program->setUniformValue("origin", QVector2D(m_heightFieldOriginX, m_heightFieldOriginY));
+        program->setUniformValue("cellSize", m_heightFieldCellSize);
+        program->setUniformValue("heights", 1);
+        program->setUniformValue("idBase", PickBuffer::encode(PickResult::HeightCell, 0));
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, m_heightTexture);
+        glActiveTexture(GL_TEXTURE0);
+        m_vaoHeightField->bind();
+        glDrawElements(GL_TRIANGLES, m_heightFieldIndexCount, GL_UNSIGNED_INT, nullptr);
+        m_vaoHeightField->release();
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // 点集：不抽稀，按本帧已选中并上传的八叉树节点或整个缓冲区绘制
+    m_pickNodes.clear();
+    m_pickOctree.reset();
+    const bool uploaded = m_pointUploader && m_uploadedPoints.buffer != 0;
+    if (m_pointsVisible && m_vaoPoints && (m_octree || (m_pointsCount > 0 && (uploaded || m_pointsBuffer.isCreated())))) {
+        QOpenGLShaderProgram *program = m_renderer->pointPickProgram();
+        program->bind();
+        program->setUniformValue("mvp", mvp);
+        m_vaoPoints->bind();
+        glPointSize(m_pointsSize);
+
+        if (m_octree) {
+            m_pickOctree = m_octree;
+            int base = 0;
+            for (int index : m_octreeSelection) {
+                if (index >= m_octreeBuffers.size() || !m_octreeBuffers[index].buffer.isCreated()) {
+                    continue;
+                }
+                OctreeNodeBuffer &nodeBuffer = m_octreeBuffers[index];
+                const OctreeNode &node = m_octree->node(index);
+                nodeBuffer.buffer.bind();
+                program->setUniformValue("boundsMin", node.boundsMin);
+                program->setUniformValue("boundsSize", QVector3D(node.size, node.size, node.size));
+                program->setUniformValue("idBase", PickBuffer::encode(PickResult::Point, base));
+                m_renderer->setVertexAttributes(program, SlagPondRenderer::VertexQuantized);
+                glDrawArrays(GL_POINTS, 0, node.points.size());
+                m_pickNodes.append({index, base});
+                base += node.points.size();
+            }
+        } else {
+            if (uploaded) {
+                glBindBuffer(GL_ARRAY_BUFFER, m_uploadedPoints.buffer);
+            } else {
+                m_pointsBuffer.bind();
+            }
+            program->setUniformValue("boundsMin", m_pointsBoundsMin);
+            program->setUniformValue("boundsSize", m_pointsBoundsSize);
+            program->setUniformValue("idBase", PickBuffer::encode(PickResult::Point, 0));
+            const int offset = uploaded ? 0 : m_pointsBuffer.firstElement() * static_cast<int>(sizeof(PackedPoint));
+            m_renderer->setVertexAttributes(program, SlagPondRenderer::VertexQuantized, offset);
+            glDrawArrays(GL_POINTS, 0, m_pointsCount);
+            if (uploaded) {
+                m_pointUploader->releaseFront();
+            } else {
+                m_pointsBuffer.fence();
+            }
+        }
+        m_renderer->releaseVertexAttributes(program, SlagPondRenderer::VertexQuantized);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        m_vaoPoints->release();
+    }
+
+    m_pickBuffer.end();
+    glEnable(GL_CULL_FACE);
+    m_renderer->colorProgram()->bind();
+
+    // 读回在后续帧中检查，确保有下一帧
+    emit updateRequested();
+}
+
+void SlagPondView::resolvePick()
+{
+    QVector<quint32> ids;
+    QVector<float> depths;
+    if (!m_pickBuffer.poll(&ids, &depths)) {
+        if (m_pickBuffer.isPending()) {
+            emit updateRequested();
+        }
+        return;
+    }
+
+    // 取离窗口中心最近的ID，距离相同时取较近的（深度小）
+    const int center = PickBuffer::SIZE / 2;
+    int best = -1;
+    int bestDistance = 0;
+    for (int y = 0; y < PickBuffer::SIZE; ++y) {
+        for (int x = 0; x < PickBuffer::SIZE; ++x) {
+            const int i = y * PickBuffer::SIZE + x;
+            if (ids[i] == 0) {
+                continue;
+            }
+            const int distance = (x - center) * (x - center) + (y - center) * (y - center);
+            if (best < 0 || distance < bestDistance || (distance == bestDistance && depths[i] < depths[best])) {
+                best = i;
+                bestDistance = distance;
+            }
+        }
+    }
+
+    // 位置取自数据本身（点坐标、单元中心高度、网格顶点），不受深度精度影响
+    PickResult result;
+    if (best >= 0) {
+        const PickResult::Kind kind = PickBuffer::kind(ids[best]);
+        const int index = PickBuffer::index(ids[best]);
+        switch (kind) {
+        case PickResult::Point:
+            if (m_pickOctree) {
+                auto it = std::upper_bound(m_pickNodes.constBegin(), m_pickNodes.constEnd(), index,
+                                           [](int value, const PickNode &node) { return value < node.base; });
+                if (it != m_pickNodes.constBegin()) {
+                    --it;
+                    const OctreeNode &node = m_pickOctree->node(it->node);
+                    const int local = index - it->base;
+                    if (local < node.points.size()) {
+                        const PackedPoint &p = node.points[local];
+                        result.kind = PickResult::Point;
+                        result.position = node.boundsMin + QVector3D(p.x, p.y, p.z) * (node.size / 65535.0f);
+                    }
+                }
+            } else if (index < m_points.size()) {
+                result.kind = PickResult::Point;
+                result.index = index;
+                result.position = m_points[index];
+            }
+            break;
+        case PickResult::HeightCell:
+            if (index < m_heightFieldTexels.size() && m_heightFieldTexels[index] > INVALID_HEIGHT) {
+                result.kind = PickResult::HeightCell;
+                result.index = index;
+                result.position = QVector3D(m_heightFieldOriginX + (index % m_heightFieldCols + 0.5f) * m_heightFieldCellSize,
+                                            m_heightFieldOriginY + (index / m_heightFieldCols + 0.5f) * m_heightFieldCellSize,
+                                            m_heightFieldTexels[index]);
+            }
+            break;
+        case PickResult::SurfaceVertex:
+            if (index < m_surfacePositions.size()) {
+                result.kind = PickResult::SurfaceVertex;
+                result.index = index;
+                result.position = m_surfacePositions[index];
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    m_pickOctree.reset();
+    emit picked(result);
+}
+
+void SlagPondView::drawContours()
+{
+    if (m_contourVertexCount <= 0 || !m_contourBuffer.isCreated()) {
+        return;
+    }
+
+    if (!m_vaoContours) {
+        m_vaoContours = new QOpenGLVertexArrayObject();
+        m_vaoContours->create();
+    }
+
+    m_vaoContours->bind();
+    m_contourBuffer.bind();
+
+    m_renderer->setVertexAttributes(m_renderer->colorProgram(), SlagPondRenderer::VertexColored);
+
+    glLineWidth(1.0f);
+    glDrawArrays(GL_LINES, 0, m_contourVertexCount);
+
+    m_renderer->releaseVertexAttributes(m_renderer->colorProgram(), SlagPondRenderer::VertexColored);
+    m_contourBuffer.release();
+    m_vaoContours->release();
+}
+
+void SlagPondView::drawMarkers()
+{
+    if (m_markerVertexCount <= 0 || !m_markerBuffer.isCreated()) {
+        return;
+    }
+
+    if (!m_vaoMarkers) {
+        m_vaoMarkers = new QOpenGLVertexArrayObject();
+        m_vaoMarkers->create();
+    }
+
+    m_vaoMarkers->bind();
+    m_markerBuffer.bind();
+
+    m_renderer->setVertexAttributes(m_renderer->colorProgram(), SlagPondRenderer::VertexColored);
+
+    glLineWidth(2.0f);
+    glDrawArrays(GL_LINES, 0, m_markerVertexCount);
+    glLineWidth(1.0f);
+
+    m_renderer->releaseVertexAttributes(m_renderer->colorProgram(), SlagPondRenderer::VertexColored);
+    m_markerBuffer.release();
+    m_vaoMarkers->release();
+}
+
+void SlagPondView::drawPoints()
+{
+    m_drawnPoints = 0;
+    const bool uploaded = m_pointUploader && m_uploadedPoints.buffer != 0;
+    const bool hasPoints = m_octree || (m_pointsCount > 0 && (uploaded || m_pointsBuffer.isCreated()));
+    if (!hasPoints || !m_renderer->colormapTexture()) {
+        return;
+    }
+
+    if (!m_vaoPoints) {
+        m_vaoPoints = new QOpenGLVertexArrayObject();
+        m_vaoPoints->create();
+    }
+
+    // 高度范围、透明度只是uniform，变化时无需重建顶点数据
+    QOpenGLShaderProgram *pointProgram = m_renderer->pointProgram();
+    pointProgram->bind();
+    pointProgram->setUniformValue("mvp", m_mvpMatrix);
+    pointProgram->setUniformValue("minHeight", m_minHeight);
+    pointProgram->setUniformValue("maxHeight", m_maxHeight);
+    pointProgram->setUniformValue("tableSize", static_cast<float>(SlagPondRenderer::COLOR_TABLE_SIZE));
+    pointProgram->setUniformValue("opacity", m_renderer->opacity());
+    pointProgram->setUniformValue("colormap", 0);
+    m_renderer->colormapTexture()->bind(0);
+
+    m_vaoPoints->bind();
+    glPointSize(m_pointsSize);
+
+    if (m_octree) {
+        drawOctree();
+    } else {
+        pointProgram->setUniformValue("boundsMin", m_pointsBoundsMin);
+        pointProgram->setUniformValue("boundsSize", m_pointsBoundsSize);
+        if (uploaded) {
+            glBindBuffer(GL_ARRAY_BUFFER, m_uploadedPoints.buffer);
+        } else {
+            m_pointsBuffer.bind();
+        }
+
+        // 交互期间按步长抽稀：只改顶点步长，不另存抽样数据；扫描线内等间隔取点，空间上近似均匀
+        const int step = m_interacting ? qMax(1, (m_pointsCount + m_interactivePointBudget - 1) / m_interactivePointBudget) : 1;
+        const int drawCount = (m_pointsCount + step - 1) / step;
+        if (step > 1) {
+            glPointSize(qMin(m_pointsSize * std::sqrt(static_cast<float>(step)), 2.0f * m_pointsSize));
+        }
+
+        m_drawnPoints = drawCount;
+        const int offset = uploaded ? 0 : m_pointsBuffer.firstElement() * static_cast<int>(sizeof(PackedPoint));
+        m_renderer->setVertexAttributes(pointProgram, SlagPondRenderer::VertexQuantized, offset, step);
+        glDrawArrays(GL_POINTS, 0, drawCount);
+        if (uploaded) {
+            m_pointUploader->releaseFront();
+        } else {
+            m_pointsBuffer.fence();
+        }
+        m_renderer->releaseVertexAttributes(pointProgram, SlagPondRenderer::VertexQuantized);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_vaoPoints->release();
+    m_renderer->colormapTexture()->release(0);
+
+    // 恢复通用着色器，供后续绘制使用
+    m_renderer->colorProgram()->bind();
+}
+
+void SlagPondView::drawOctree()
+{
+    // 屏幕空间误差：单位距离处1米对应的像素数
+    const float pixelsPerUnit = m_viewport.height() / (2.0f * std::tan(qDegreesToRadians(45.0f) * 0.5f));
+    QOpenGLShaderProgram *pointProgram = m_renderer->pointProgram();
+    const QVector3D eye = m_model.inverted().map(QVector3D(m_xDistance, m_yDistance, m_zDistance));
+    // 交互期间减小点数预算并放宽屏幕空间误差，停止后自动细化
+    const int budget = m_interacting ? qMin(m_interactivePointBudget, LOD_POINT_BUDGET) : LOD_POINT_BUDGET;
+    const float minPixelSpacing = m_interacting ? 2.0f : 1.0f;
+    m_octree->select(m_mvpMatrix, eye, pixelsPerUnit, budget, minPixelSpacing, &m_octreeSelection);
+
+    if (m_octreeBuffers.size() != m_octree->nodeCount()) {
+        clearOctreeBuffers();
+        m_octreeBuffers.resize(m_octree->nodeCount());
+    }
+
+    ++m_frameIndex;
+    int uploads = 0;
+    int skipped = 0;
+    int drawnPoints = 0;
+
+    // 选择结果按优先级排列，粗层级先上传，限量上传保证单帧耗时
+    for (int index : m_octreeSelection) {
+        const OctreeNode &node = m_octree->node(index);
+        OctreeNodeBuffer &nodeBuffer = m_octreeBuffers[index];
+        if (!nodeBuffer.buffer.isCreated()) {
+            if (uploads >= LOD_UPLOADS_PER_FRAME) {
+                skipped++;
+                continue;
+            }
+            const int bytes = node.points.size() * sizeof(PackedPoint);
+            nodeBuffer.buffer.create();
+            nodeBuffer.buffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+            nodeBuffer.buffer.bind();
+            nodeBuffer.buffer.allocate(node.points.constData(), bytes);
+            m_octreeGpuBytes += bytes;
+            m_uploadBytes += bytes;
+            uploads++;
+        } else {
+            nodeBuffer.buffer.bind();
+        }
+        nodeBuffer.lastFrame = m_frameIndex;
+
+        pointProgram->setUniformValue("boundsMin", node.boundsMin);
+        pointProgram->setUniformValue("boundsSize", QVector3D(node.size, node.size, node.size));
+        m_renderer->setVertexAttributes(pointProgram, SlagPondRenderer::VertexQuantized);
+        glDrawArrays(GL_POINTS, 0, node.points.size());
+        drawnPoints += node.points.size();
+    }
+    m_renderer->releaseVertexAttributes(pointProgram, SlagPondRenderer::VertexQuantized);
+
+    // 超出显存预算时按最近最少使用释放本帧未用的节点
+    if (m_octreeGpuBytes > LOD_GPU_BUDGET) {
+        QVector<int> candidates;
+        for (int i = 0; i < m_octreeBuffers.size(); ++i) {
+            if (m_octreeBuffers[i].buffer.isCreated() && m_octreeBuffers[i].lastFrame != m_frameIndex) {
+                candidates.append(i);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [&](int a, int b) {
+            return m_octreeBuffers[a].lastFrame < m_octreeBuffers[b].lastFrame;
+        });
+        for (int i : candidates) {
+            if (m_octreeGpuBytes <= LOD_GPU_BUDGET) {
+                break;
+            }
+            m_octreeGpuBytes -= m_octree->node(i).points.size() * sizeof(PackedPoint);
+            m_octreeBuffers[i].buffer.destroy();
+        }
+    }
+
+    m_drawnPoints = drawnPoints;
+    m_octreeSkippedNodes = skipped;
+
+    // 还有节点未上传时下一帧继续
+    if (skipped > 0) {
+        emit updateRequested();
+    }
+
+    if (m_frameCount % 60 == 0) {
+        qDebug() << "八叉树绘制节点数:" << m_octreeSelection.size() - skipped << "，点数:" << drawnPoints
+                 << "，显存:" << m_octreeGpuBytes / (1024.0f * 1024.0f) << "MB";
+    }
+}
+
+void SlagPondView::drawSurface()
+{
+    if (m_surfaceIndexCount <= 0 || !m_surfaceVertexBuffer.isCreated() || !m_surfaceIndexBuffer.isCreated()
+        || !m_renderer->colormapTexture()) {
+        return;
+    }
+
+    if (!m_vaoSurface) {
+        m_vaoSurface = new QOpenGLVertexArrayObject();
+        m_vaoSurface->create();
+    }
+
+    QOpenGLShaderProgram *program = m_renderer->surfaceProgram();
+    program->bind();
+    program->setUniformValue("mvp", m_mvpMatrix);
+    program->setUniformValue("minHeight", m_minHeight);
+    program->setUniformValue("maxHeight", m_maxHeight);
+    program->setUniformValue("tableSize", static_cast<float>(SlagPondRenderer::COLOR_TABLE_SIZE));
+    program->setUniformValue("opacity", m_renderer->opacity());
+    program->setUniformValue("useColormap", m_surfaceCustomColors ? 0 : 1);
+    program->setUniformValue("colormap", 0);
+    m_renderer->colormapTexture()->bind(0);
+
+    m_vaoSurface->bind();
+    m_surfaceVertexBuffer.bind();
+    m_surfaceIndexBuffer.bind();
+
+    m_renderer->setVertexAttributes(program, SlagPondRenderer::VertexColored);
+
+    // 网格三角形朝向不固定，绘制时关闭背面剔除
+    glDisable(GL_CULL_FACE);
+    glDrawElements(GL_TRIANGLES, m_surfaceIndexCount, GL_UNSIGNED_INT, nullptr);
+    glEnable(GL_CULL_FACE);
+
+    m_renderer->releaseVertexAttributes(program, SlagPondRenderer::VertexColored);
+    m_surfaceIndexBuffer.release();
+    m_surfaceVertexBuffer.release();
+    m_vaoSurface->release();
+    m_renderer->colormapTexture()->release(0);
+
+    // 恢复通用着色器，供后续绘制使用
+    m_renderer->colorProgram()->bind();
+}
+
+void SlagPondView::drawHeightField()
+{
+    if (m_heightFieldIndexCount <= 0 || !m_heightTexture || !m_renderer->colormapTexture()) {
+        return;
+    }
+
+    QOpenGLShaderProgram *program = m_renderer->heightFieldProgram();
+    program->bind();
+    program->setUniformValue("mvp", m_mvpMatrix);
+    program->setUniformValue("cols", m_heightFieldCols);
+    program->setUniformValue("origin", QVector2D(m_heightFieldOriginX, m_heightFieldOriginY));
+    program->setUniformValue("cellSize", m_heightFieldCellSize);
+    program->setUniformValue("minHeight", m_minHeight);
+    program->setUniformValue("maxHeight", m_maxHeight);
+    program->setUniformValue("tableSize", static_cast<float>(SlagPondRenderer::COLOR_TABLE_SIZE));
+    program->setUniformValue("opacity", m_renderer->opacity());
+    program->setUniformValue("colormap", 0);
+    program->setUniformValue("heights", 1);
+    m_renderer->colormapTexture()->bind(0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, m_heightTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    // 网格三角形朝向不固定，绘制时关闭背面剔除
+    m_vaoHeightField->bind();
+    glDisable(GL_CULL_FACE);
+    glDrawElements(GL_TRIANGLES, m_heightFieldIndexCount, GL_UNSIGNED_INT, nullptr);
+    glEnable(GL_CULL_FACE);
+    m_vaoHeightField->release();
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    m_renderer->colormapTexture()->release(0);
+
+    // 恢复通用着色器，供后续绘制使用
+    m_renderer->colorProgram()->bind();
+}
+
+bool SlagPondView::hasPendingWork() const
+{
+    const bool octreeWaiting = m_points.size() >= LOD_POINT_THRESHOLD
+                               && (m_octreeBuilding || m_octreePending || !m_octree);
+    return octreeWaiting || (m_octree && m_octreeSkippedNodes > 0) || m_pointsDirty;
+}
+
+void SlagPondView::setCameraPreset(int preset)
+{
+    if (preset == CAMERA_TOP) {
+        // 池心正上方；y方向留一点偏移，使上方向取+z时lookAt不退化，画面上方为+y
+        m_perspective = 0;
+        m_xDistance = 0.0f;
+        m_yDistance = -0.1f;
+        m_zDistance = 60.0f;
+    } else {
+        m_perspective = qBound(0, preset, 3);
+        m_xDistance = m_cameraPositions[m_perspective].x();
+        m_yDistance = m_cameraPositions[m_perspective].y();
+        m_zDistance = m_cameraPositions[m_perspective].z();
+    }
+
+    m_view.setToIdentity();
+    m_view.lookAt(QVector3D(m_xDistance, m_yDistance, m_zDistance),
+                  QVector3D(0, 0, 0),
+                  QVector3D(0, 0, 1));
+    m_rotation = QQuaternion::fromAxisAndAngle(QVector3D(0, 0, 1), 0.0f);
+    m_transformDirty = true;
+    emit updateRequested();
+}
+
+void SlagPondView::resetView()
+{
+    m_perspective = (m_perspective + 1) % 4;
+
+    // 重置摄像机位置到当前视角对应的位置
+    m_xDistance = m_cameraPositions[m_perspective].x();
+    m_yDistance = m_cameraPositions[m_perspective].y();
+    m_zDistance = m_cameraPositions[m_perspective].z();
+
+    m_view.setToIdentity();
+    m_view.lookAt(QVector3D(m_xDistance, m_yDistance, m_zDistance),
+                  QVector3D(0, 0, 0),
+                  QVector3D(0, 0, 1));
+
+    // 重置旋转
+    m_rotation = QQuaternion::fromAxisAndAngle(QVector3D(0, 0, 1), 0.0f);
+
+    // 静态几何体已按视角缓存，只需切换绘制的子区间
+    m_transformDirty = true;
+    emit updateRequested();
+}
+
+void SlagPondView::enlarge()
+{
+    beginInteraction();
+    const float enlargeMultiple = 1.1f;
+    m_xDistance /= enlargeMultiple;
+    m_yDistance /= enlargeMultiple;
+    m_zDistance /= enlargeMultiple;
+
+    m_xDistance = qBound(-200.0f, m_xDistance, 200.0f);
+    m_yDistance = qBound(-200.0f, m_yDistance, 200.0f);
+    m_zDistance = qBound(5.0f, m_zDistance, 200.0f);
+
+    m_view.setToIdentity();
+    m_view.lookAt(QVector3D(m_xDistance, m_yDistance, m_zDistance),
+                  QVector3D(0, 0, 0),
+                  QVector3D(0, 0, 1));
+    m_transformDirty = true;
+    emit updateRequested();
+}
+
+void SlagPondView::reduce()
+{
+    beginInteraction();
+    const float reduceMultiple = 1.1f;
+    m_xDistance *= reduceMultiple;
+    m_yDistance *= reduceMultiple;
+    m_zDistance *= reduceMultiple;
+
+    m_xDistance = qBound(-200.0f, m_xDistance, 200.0f);
+    m_yDistance = qBound(-200.0f, m_yDistance, 200.0f);
+    m_zDistance = qBound(5.0f, m_zDistance, 200.0f);
+
+    m_view.setToIdentity();
+    m_view.lookAt(QVector3D(m_xDistance, m_yDistance, m_zDistance),
+                  QVector3D(0, 0, 0),
+                  QVector3D(0, 0, 1));
+    m_transformDirty = true;
+    emit updateRequested();
+}
+
+void SlagPondView::mousePress(const QPoint &pos)
+{
+    m_lastMousePos = pos;
+}
+
+void SlagPondView::mouseMove(const QPoint &pos, Qt::MouseButtons buttons)
+{
+    if (buttons & Qt::LeftButton) {
+        beginInteraction();
+        QPoint diff = pos - m_lastMousePos;
+
+        // 水平移动控制绕Z轴旋转
+        float zAngle = diff.x() * 0.5f;  // 水平旋转角度
+        QQuaternion zRotation = QQuaternion::fromAxisAndAngle(QVector3D(0.0f, 0.0f, 1.0f), zAngle);
+
+        // 垂直移动控制绕X轴旋转
+        float xAngle = diff.y() * 0.5f;  // 垂直旋转角度
+        QQuaternion xRotation = QQuaternion::fromAxisAndAngle(QVector3D(1.0f, 0.0f, 0.0f), xAngle);
+
+        // 组合旋转：先X轴旋转，再Z轴旋转
+        m_rotation = zRotation * xRotation * m_rotation;
+        m_rotation.normalize();
+
+        m_lastMousePos = pos;
+        m_transformDirty = true;
+        emit updateRequested();
+    }
+}
+
+void SlagPondView::wheel(int angleDelta)
+{
+    beginInteraction();
+    float delta = angleDelta * 0.001f;
+    m_xDistance *= (1 - delta);
+    m_yDistance *= (1 - delta);
+    m_zDistance *= (1 - delta);
+
+    m_xDistance = qBound(-200.0f, m_xDistance, 200.0f);
+    m_yDistance = qBound(-200.0f, m_yDistance, 200.0f);
+    m_zDistance = qBound(5.0f, m_zDistance, 200.0f);
+
+    m_view.setToIdentity();
+    m_view.lookAt(QVector3D(m_xDistance, m_yDistance, m_zDistance),
+                  QVector3D(0, 0, 0),
+                  QVector3D(0, 0, 1));
+    m_transformDirty = true;
+    emit updateRequested();
+}
+
+void SlagPondView::beginInteraction()
+{
+    if (!m_interacting) {
+        m_interacting = true;
+        m_interactionClock.invalidate();
+    }
+    m_idleTimer.start();
+}
+
+void SlagPondView::endInteraction()
+{
+    // 输入已停止，按完整细节重绘一次
+    m_interacting = false;
+    emit updateRequested();
+}
+
+void SlagPondView::adaptInteractiveBudget()
+{
+    // 以相邻两次交互重绘的间隔估计实际帧时间（含GPU和交换缓冲），超出目标时减小预算，余量充足时缓慢增大
+    // 间隔过长说明期间没有输入，不计入
+    if (!m_interactionClock.isValid()) {
+        m_interactionClock.start();
+        return;
+    }
+    const float interval = m_interactionClock.restart();
+    if (interval > 100.0f) {
+        return;
+    }
+
+    if (interval > INTERACTIVE_FRAME_MS * 1.2f) {
+        m_interactivePointBudget = qMax(INTERACTIVE_MIN_POINTS, static_cast<int>(m_interactivePointBudget * 0.75f));
+    } else if (interval < INTERACTIVE_FRAME_MS * 0.8f) {
+        m_interactivePointBudget = qMin(LOD_POINT_BUDGET, static_cast<int>(m_interactivePointBudget * 1.1f));
+    }
+}
+
+qint64 SlagPondView::gpuMemoryBytes()
+{
+    // 按已分配的容量估算，不查询驱动
+    qint64 bytes = m_pointUploader ? m_pointUploader->gpuBytes() : m_pointsBuffer.sizeInBytes();
+    bytes += m_octreeGpuBytes;
+    bytes += static_cast<qint64>(m_surfaceVertices.size()) * sizeof(Vertex) + m_surfaceIndexCount * sizeof(unsigned int);
+    if (m_heightTexture) {
+        bytes += static_cast<qint64>(m_heightFieldCols) * m_heightFieldRows * sizeof(float)
+                 + m_heightFieldIndexCount * sizeof(unsigned int);
+    }
+    bytes += static_cast<qint64>(m_contourVertexCount + m_markerVertexCount) * sizeof(Vertex);
+    return bytes;
+}
+
+QStringList SlagPondView::hudLines()
+{
+    QStringList lines;
+    lines << QString("CPU p50/p95/p99: %1 / %2 / %3 ms")
+                 .arg(m_cpuStats.percentile(0.5f), 0, 'f', 2)
+                 .arg(m_cpuStats.percentile(0.95f), 0, 'f', 2)
+                 .arg(m_cpuStats.percentile(0.99f), 0, 'f', 2);
+    if (m_gpuTimer.isValid()) {
+        const FrameStats &gpu = m_gpuTimer.frameStats();
+        lines << QString("GPU p50/p95/p99: %1 / %2 / %3 ms")
+                     .arg(gpu.percentile(0.5f), 0, 'f', 2)
+                     .arg(gpu.percentile(0.95f), 0, 'f', 2)
+                     .arg(gpu.percentile(0.99f), 0, 'f', 2);
+        lines << QString("填充/网格/刻度/表面/点集: %1 / %2 / %3 / %4 / %5 ms")
+                     .arg(m_gpuTimer.passTime(GpuTimer::PassFills), 0, 'f', 2)
+                     .arg(m_gpuTimer.passTime(GpuTimer::PassGrid), 0, 'f', 2)
+                     .arg(m_gpuTimer.passTime(GpuTimer::PassTicks), 0, 'f', 2)
+                     .arg(m_gpuTimer.passTime(GpuTimer::PassSurface), 0, 'f', 2)
+                     .arg(m_gpuTimer.passTime(GpuTimer::PassPoints), 0, 'f', 2);
+    } else {
+        lines << QString("GPU: 不支持计时查询");
+    }
+    lines << QString("点数: %1（绘制 %2）%3")
+                 .arg(m_points.size())
+                 .arg(m_drawnPoints)
+                 .arg(m_interacting ? "，交互中" : "");
+    lines << QString("上传: %1 MB/s  显存: %2 MB")
+                 .arg(m_uploadRate, 0, 'f', 1)
+                 .arg(gpuMemoryBytes() / (1024.0f * 1024.0f), 0, 'f', 1);
+    return lines;
+}
@@ -0,0 +1,323 @@
+#ifndef SLAGPONDVIEW_H
+#define SLAGPONDVIEW_H
+
+#include <QObject>
+#include <QOpenGLFunctions>
+#include <QOpenGLBuffer>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLShaderProgram>
+#include <QMatrix4x4>
+#include <QVector3D>
+#include <QQuaternion>
+#include <QVector>
+#include <QRect>
+#include <QColor>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QPolygonF>
+#include <array>
+
+#include "SlagPondRenderer.h"
+#include "StreamingBuffer.h"
+#include "PointUploader.h"
+#include "PointOctree.h"
+#include "GpuTimer.h"
+#include "PickBuffer.h"
+
+class QOpenGLContext;
+class SurfaceMesh;
+class HeightGrid;
+
+// 渲染面上的一个视图（图块）：自己的摄像机和数据（点集、网格、高度场、等高线、标记），
+// 着色器、静态场景和颜色纹理引用所在上下文的SlagPondRenderer
+// 不持有上下文，由宿主（SlagPondViewWidget）在上下文当前时调用initialize/render/cleanup
+class SlagPondView : public QObject, protected QOpenGLFunctions
+{
+    Q_OBJECT
+
+public:
+    explicit SlagPondView(QObject *parent = nullptr);
+    ~SlagPondView();
+
+    // 标题（绘制在图块左上方）
+    void setTitle(const QString &title, const QColor &color);
+    QString title() const { return m_title; }
+    QColor titleColor() const { return m_titleColor; }
+
+    void resetView();
+    void enlarge();
+    void reduce();
+
+    // 相机预设：0~3为m_cameraPositions的四个斜视角，CAMERA_TOP为池心正上方俯视
+    static const int CAMERA_TOP = 4;
+    void setCameraPreset(int preset);
+
+    // 绘制三维点集函数
+    void drawPoints3D(const QVector<QVector3D>& points,
+                      const QVector4D& pointColor = QVector4D(1.0f, 0.0f, 0.0f, 1.0f),
+                      float pointSize = 5.0f);
+
+    // 批量更新点集数据
+    void setPointsData(const QVector<QVector3D>& points, float minHeight, float maxHeight);
+
+    // 点集、高度场是否绘制（数据照常更新，切换时无需重新上传），默认都绘制
+    void setPointsVisible(bool visible);
+    void setHeightFieldVisible(bool visible);
+    bool pointsVisible() const { return m_pointsVisible; }
+    bool heightFieldVisible() const { return m_heightFieldVisible; }
+
+    // 更新三角网格数据，以填充面显示
+    // changedVertices为本次变化的顶点（可重复），只改写并上传这些顶点；传nullptr或顶点数变化时整体更新
+    void setSurfaceMesh(const SurfaceMesh& mesh, float minHeight, float maxHeight,
+                        const QVector<int>* changedVertices = nullptr);
+    // 按顶点指定网格颜色（如变化量着色），传入空数组则恢复按高度着色（GPU上由颜色纹理取色）
+    // changedVertices为颜色有变化的顶点，只改写并上传这些顶点；传nullptr时整体更新
+    void setSurfaceColors(const QVector<QVector4D>& colors, const QVector<int>* changedVertices = nullptr);
+
+    // 高度场模式：静态栅格网格在顶点着色器中按高度纹理位移，每次扫描只更新纹理
+    // changedCells为本次变化的单元，传nullptr时整幅更新（如切换渣池）
+    void setHeightField(const HeightGrid& grid, float minHeight, float maxHeight,
+                        const QVector<int>* changedCells = nullptr);
+
+    // 更新等高线（每两个点一条线段）
+    void setContourSegments(const QVector<QVector3D>& segments);
+
+    // 标记点（如峰值），以竖线加十字显示
+    void setMarkers(const QVector<QVector3D>& markers);
+
+    // 测量线（如距离工具的两个拾取点），黄色折线，端点加十字；传入空数组清除
+    void setMeasureLine(const QVector<QVector3D>& points);
+
+    // 选区轮廓（渣池坐标系XY），画在当前最高高度的水平面上，与selectionPosition使用同一平面
+    void setRegionOutline(const QPolygonF& outline);
+    // 屏幕位置（帧缓冲区像素，相对图块左上角）沿视线与选区平面的交点，视线与平面平行时返回false
+    bool selectionPosition(const QPoint &pos, QPointF *out) const;
+
+    // 加载CSV数据
+    bool loadCSV(const QString& filePath, char separator = ',');
+
+    // 以下由宿主在上下文当前时调用
+    // backgroundUpload为false时点集在render中同步上传（离屏快照需要确定的帧内容）
+    void initialize(SlagPondRenderer *renderer, QOpenGLContext *context, bool backgroundUpload = true);
+    void cleanup();
+    bool isInitialized() const { return m_renderer != nullptr; }
+    // viewport为帧缓冲区像素坐标（左下角为原点）
+    void render(const QRect &viewport);
+    // 还有跨帧完成的工作（八叉树构建、节点分批上传、点集待上传），再render一次才能显示完整
+    bool hasPendingWork() const;
+
+    // 性能面板：CPU/GPU帧时间分位数、各绘制阶段GPU时间、点数、上传速率和显存估计
+    QStringList hudLines();
+
+    // 拾取光标处的对象：下一次render中把ID绘制到小尺寸帧缓冲区，读回完成后（通常晚一帧）发出picked
+    // pos为帧缓冲区像素，相对图块左上角
+    void requestPick(const QPoint &pos);
+
+    // 鼠标交互，坐标相对图块左上角
+    void mousePress(const QPoint &pos);
+    void mouseMove(const QPoint &pos, Qt::MouseButtons buttons);
+    void wheel(int angleDelta);
+
+signals:
+    // 数据或摄像机变化，需要宿主重绘
+    void updateRequested();
+    // 拾取完成，光标处没有对象时kind为None
+    void picked(const PickResult &result);
+
+private:
+    using Vertex = SlagPondRenderer::Vertex;
+
+    void updateProjection(const QRect &viewport);
+    void beginInteraction();
+    void endInteraction();
+    void adaptInteractiveBudget();
+    qint64 gpuMemoryBytes();
+    void updatePointsGeometry();
+    void schedulePointsUpload();
+    void startOctreeBuild();
+    void onOctreeBuilt();
+    void drawOctree();
+    void clearOctreeBuffers();
+    void updateSurfaceGeometry();
+    // 记录待上传的顶点（去重）；过多时改为整体上传
+    void markSurfaceVertices(const QVector<int>& vertices);
+    void clearSurfaceDirtyVertices();
+    void updateContourGeometry();
+    void updateHeightFieldGeometry();
+    void updateMarkerGeometry();
+    void drawContours();
+    void drawMarkers();
+    void drawPoints();
+    void drawSurface();
+    void drawHeightField();
+    void drawAll();
+    void drawPickPass();
+    void resolvePick();
+
+    // 共用资源，initialize之前为空
+    SlagPondRenderer *m_renderer = nullptr;
+
+    QString m_title;
+    QColor m_titleColor;
+    QRect m_viewport;
+
+    // VAOs
+    QOpenGLVertexArrayObject *m_vaoPoints;
+
+    // 点集数据（按包围盒量化为每点6字节，直接写入流式缓冲区的映射内存）
+    // 扫描更新仅数Hz，两个区段配合栅栏已足够，不必为三重缓冲多占一份显存
+    StreamingBuffer m_pointsBuffer{sizeof(PackedPoint), 2};
+    QVector<QVector3D> m_points;
+    QVector3D m_pointsBoundsMin;
+    QVector3D m_pointsBoundsSize;
+    // 支持多线程上下文时由后台线程上传，render只取用已上传的缓冲区；否则在render中走流式缓冲区
+    PointUploader *m_pointUploader = nullptr;
+    UploadedPoints m_uploadedPoints;
+
+    // 超大点集改用八叉树LOD：后台构建，每帧按视锥和屏幕空间误差在预算内选节点，
+    // 节点缓冲区按需上传（每帧限量），超出显存预算时释放最久未用的节点
+    struct OctreeNodeBuffer {
+        QOpenGLBuffer buffer;
+        quint64 lastFrame = 0;
+    };
+    QSharedPointer<PointOctree> m_octree;
+    QFutureWatcher<QSharedPointer<PointOctree>> m_octreeWatcher;
+    bool m_octreePending = false;
+    bool m_octreeBuilding = false;     // 已启动构建，结果尚未取用
+    int m_octreeSkippedNodes = 0;      // 上一帧因上传限量未绘制的节点数
+    bool m_octreeBuffersStale = false;
+    QVector<OctreeNodeBuffer> m_octreeBuffers;
+    QVector<int> m_octreeSelection;
+    qint64 m_octreeGpuBytes = 0;
+    quint64 m_frameIndex = 0;
+    static const int LOD_POINT_THRESHOLD = 2000000;     // 超过该点数使用八叉树
+    static const int LOD_POINT_BUDGET = 3000000;        // 每帧最多绘制的点数
+    static const int LOD_UPLOADS_PER_FRAME = 64;        // 每帧最多新上传的节点数
+    static constexpr qint64 LOD_GPU_BUDGET = 512LL * 1024 * 1024;
+    int m_pointsCount;
+    QVector4D m_pointsColor;
+    float m_pointsSize;
+    bool m_pointsDirty;
+    bool m_pointsVisible = true;
+
+    // 三角网格数据：索引只在拓扑变化时上传
+    QOpenGLVertexArrayObject *m_vaoSurface = nullptr;
+    QOpenGLBuffer m_surfaceVertexBuffer;
+    QOpenGLBuffer m_surfaceIndexBuffer{QOpenGLBuffer::IndexBuffer};
+    QVector<QVector3D> m_surfacePositions;
+    QVector<unsigned int> m_surfaceIndices;
+    QVector<QVector4D> m_surfaceColors;
+    QVector<Vertex> m_surfaceVertices;
+    QVector<int> m_surfaceDirtyVertices;   // 待上传的顶点（不重复，整体更新时不用）
+    QVector<quint8> m_surfaceVertexDirty;  // 每个顶点是否已在m_surfaceDirtyVertices中
+    quint64 m_surfaceTopology = 0;
+    int m_surfaceIndexCount = 0;
+    bool m_surfaceDirty = false;
+    bool m_surfaceTopologyDirty = false;
+    bool m_surfaceCustomColors = false;
+    // 增量上传时间隔不超过该顶点数的变化顶点合并为一次写入
+    static const int SURFACE_RUN_GAP = 64;
+
+    // 高度场：无顶点缓冲，顶点序号即单元序号；索引只在栅格尺寸变化时上传，
+    // 高度存于R32F纹理（无效单元为INVALID_HEIGHT），按块记录脏区只上传变化的块
+    QOpenGLVertexArrayObject *m_vaoHeightField = nullptr;
+    QOpenGLBuffer m_heightFieldIndexBuffer{QOpenGLBuffer::IndexBuffer};
+    GLuint m_heightTexture = 0;
+    QVector<float> m_heightFieldTexels;
+    QVector<quint8> m_heightFieldDirtyTiles;
+    int m_heightFieldCols = 0;
+    int m_heightFieldRows = 0;
+    float m_heightFieldOriginX = 0.0f;
+    float m_heightFieldOriginY = 0.0f;
+    float m_heightFieldCellSize = 0.0f;
+    int m_heightFieldIndexCount = 0;
+    bool m_heightFieldResized = false;
+    bool m_heightFieldDirty = false;
+    bool m_heightFieldVisible = true;
+    static const int HEIGHT_TILE_SIZE = 32;
+    static constexpr float INVALID_HEIGHT = -1.0e6f;
+
+    // 等高线
+    QOpenGLVertexArrayObject *m_vaoContours = nullptr;
+    QOpenGLBuffer m_contourBuffer;
+    QVector<QVector3D> m_contourSegments;
+    int m_contourVertexCount = 0;
+    bool m_contourDirty = false;
+
+    // 标记点
+    QOpenGLVertexArrayObject *m_vaoMarkers = nullptr;
+    QOpenGLBuffer m_markerBuffer;
+    QVector<QVector3D> m_markers;
+    int m_markerVertexCount = 0;
+    bool m_markersDirty = false;
+    // 测量线、选区轮廓与标记点共用缓冲区
+    QVector<QVector3D> m_measureLine;
+    QPolygonF m_regionOutline;
+
+    // 颜色渐变变化时（如加载CSV）在下一次render中通知共用的渲染器
+    bool m_gradientDirty = false;
+    float m_minHeight;
+    float m_maxHeight;
+
+    QMatrix4x4 m_projection;
+    QMatrix4x4 m_view;
+    QMatrix4x4 m_model;
+    QMatrix4x4 m_mvpMatrix;
+    bool m_transformDirty;
+
+    QQuaternion m_rotation;
+    QPoint m_lastMousePos;
+
+    // 摄像机距离
+    float m_xDistance;
+    float m_yDistance;
+    float m_zDistance;
+
+    // 不同视角的摄像机位置
+    const std::array<QVector3D, 4> m_cameraPositions = {
+        QVector3D(-30.0f, -60.0f, 25.0f),   // 视角0
+        QVector3D(60.0f, -30.0f, 25.0f),     // 视角1
+        QVector3D(30.0f, 60.0f, 25.0f),      // 视角2
+        QVector3D(-60.0f, 30.0f, 25.0f)      // 视角3
+    };
+
+    // 当前视角
+    int m_perspective;
+
+    // 交互期间（拖动、缩放）降低点集细节：单缓冲区按步长抽稀，八叉树减小预算、放宽误差；
+    // 输入停止INTERACTION_IDLE_MS后恢复完整细节。预算按交互帧间隔自适应，使帧率接近目标
+    QTimer m_idleTimer;
+    bool m_interacting = false;
+    QElapsedTimer m_interactionClock;
+    int m_interactivePointBudget = 1000000;
+    static const int INTERACTION_IDLE_MS = 150;
+    static const int INTERACTIVE_MIN_POINTS = 100000;
+    static constexpr float INTERACTIVE_FRAME_MS = 16.7f;
+
+    // 性能统计：GPU按阶段计时（查询结果环形读回），CPU为本视图render耗时
+    GpuTimer m_gpuTimer;
+    FrameStats m_cpuStats;
+    qint64 m_uploadBytes = 0;
+    QElapsedTimer m_uploadClock;
+    float m_uploadRate = 0.0f;      // MB/s
+    int m_drawnPoints = 0;
+
+    // ID缓冲区拾取：只在请求的那一帧多绘制一遍可拾取对象，读回异步完成，不打断正常帧
+    // 八叉树显示时点已按节点重排，记下本次绘制的节点及其ID起点，解析时从节点数据还原位置
+    struct PickNode {
+        int node;
+        int base;
+    };
+    PickBuffer m_pickBuffer;
+    bool m_pickRequested = false;
+    QPoint m_pickPos;
+    QSharedPointer<PointOctree> m_pickOctree;
+    QVector<PickNode> m_pickNodes;
+
+    int m_frameCount = 0;
+};
+
+#endif // SLAGPONDVIEW_H
@@ -3,38 +3,53 @@
 
 #include <QOpenGLWidget>
 #include <QOpenGLFunctions>
-#include <QOpenGLBuffer>
-#include <QOpenGLVertexArrayObject>
-#include <QOpenGLShaderProgram>
-#include <QMatrix4x4>
-#include <QVector3D>
-#include <QQuaternion>
 #include <QVector>
-#include <QMap>
-#include <array>
+#include <QRect>
 
+#include "SlagPondRenderer.h"
+#include "SlagPondView.h"
+
+class QPainter;
+
+// 三维显示面：一个OpenGL上下文中按图块绘制多个视图（各渣池的高度图、分布图等），
+// 着色器、静态场景和颜色纹理只有一份（SlagPondRenderer），没有多上下文切换和重复的显存占用
 class SlagPondViewWidget : public QOpenGLWidget, protected QOpenGLFunctions
 {
     Q_OBJECT
 
 public:
+    // 鼠标工具：导航时拖动旋转、滚轮缩放；选择/距离工具下单击（不拖动）拾取光标处的对象；
+    // 区域工具下拖动画矩形，按住Shift拖动画任意多边形
+    enum ToolMode {
+        ToolNavigate,
+        ToolSelect,
+        ToolDistance,
+        ToolRegion
+    };
+
     explicit SlagPondViewWidget(QWidget *parent = nullptr);
     ~SlagPondViewWidget();
 
-    void resetView();
-    void enlarge();
-    void reduce();
+    // 新增一个图块，视图归本控件所有
+    SlagPondView *addView(const QString &title, const QColor &titleColor = Qt::white);
+    int viewCount() const { return m_views.size(); }
+    SlagPondView *view(int index) const { return m_views[index]; }
+
+    // 图块每行的列数，默认所有视图排成一行
+    void setColumns(int columns);
 
-    // 绘制三维点集函数
-    void drawPoints3D(const QVector<QVector3D>& points,
-                      const QVector4D& pointColor = QVector4D(1.0f, 0.0f, 0.0f, 1.0f),
-                      float pointSize = 5.0f);
+    // 性能面板（各图块左下角），也可按F3切换
+    void setHudVisible(bool visible);
+    bool isHudVisible() const { return m_hudVisible; }
 
-    // 批量更新点集数据
-    void setPointsData(const QVector<QVector3D>& points, float minHeight, float maxHeight);
+    void setToolMode(ToolMode mode);
+    ToolMode toolMode() const { return m_toolMode; }
 
-    // 加载CSV数据
-    bool loadCSV(const QString& filePath, char separator = ',');
+signals:
+    // 选择/距离工具拾取完成（由视图读回后发出，通常晚一帧）
+    void pointPicked(SlagPondView *view, const PickResult &result);
+    // 区域工具拖动中持续发出，region为渣池坐标系XY，rectangle表示轴对齐矩形
+    void regionChanged(SlagPondView *view, const QPolygonF &region, bool rectangle);
 
 protected:
     void initializeGL() override;
@@ -43,123 +58,39 @@ protected:
 
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
     void wheelEvent(QWheelEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
 
 private:
-    // 顶点结构体
-    struct Vertex {
-        float x, y, z;
-        float r, g, b, a;
-
-        Vertex(float px = 0, float py = 0, float pz = 0,
-               float pr = 0, float pg = 0, float pb = 0, float pa = 0)
-            : x(px), y(py), z(pz), r(pr), g(pg), b(pb), a(pa) {}
-    };
-
-    // 缓存几何体数据
-    struct GeometryCache {
-        QVector<Vertex> vertices;
-        QVector<unsigned int> indices;
-        QOpenGLBuffer vertexBuffer;
-        QOpenGLBuffer indexBuffer;
-        int vertexCount = 0;
-        int indexCount = 0;
-        bool needsUpdate = true;
-
-        GeometryCache()
-            : vertexBuffer(QOpenGLBuffer::VertexBuffer)
-            , indexBuffer(QOpenGLBuffer::IndexBuffer) {}
-    };
-
-    // 网格和填充面的缓存
-    struct {
-        GeometryCache grid;
-        std::array<GeometryCache, 5> fills;
-        std::array<bool, 5> fillValid;
-    } m_geometries;
-    QVector<int> fillingOrder;
-
-    void setupShaderProgram();
-    void updateGridGeometry();
-    void updateFillGeometry(int perspective, float transparency);
-    void updateAllGeometries();
-    void updatePointsGeometry();
-    void drawGrid();
-    void drawFillGeometry(int perspective);
-    void drawTickMarks();
-    void drawPoints();
-    void drawAll();
-
-    QColor getColorForHeight(float height) const;
-    void updateColorGradient();
-    void buildColorLookupTable();
-    float interpolateColor(float value, float v1, float v2, float c1, float c2) const;
-
-    // 颜色查找表
-    QVector<QVector4D> m_colorLookupTable;
-    static const int COLOR_TABLE_SIZE = 256;
-    bool m_colorTableValid = false;
-
-    QOpenGLShaderProgram *m_shaderProgram;
-
-    // VAOs
-    QOpenGLVertexArrayObject *m_vaoGrid;
-    QOpenGLVertexArrayObject *m_vaoPoints;
-    std::array<QOpenGLVertexArrayObject*, 5> m_vaoFills;
-
-    // 点集数据
-    QOpenGLBuffer m_pointsBuffer;
-    QVector<QVector3D> m_points;
-    QVector<Vertex> m_pointVertices;
-    int m_pointsCount;
-    QVector4D m_pointsColor;
-    float m_pointsSize;
-    bool m_pointsDirty;
-
-    // 颜色渐变相关
-    QVector4D m_lowColor;
-    QVector4D m_highColor;
-    QMap<float, QColor> m_colorGradient;
-    float m_surfaceOpacity;
-    float m_minHeight;
-    float m_maxHeight;
-
-    QMatrix4x4 m_projection;
-    QMatrix4x4 m_view;
-    QMatrix4x4 m_model;
-    QMatrix4x4 m_mvpMatrix;
-    bool m_transformDirty;
-
-    QQuaternion m_rotation;
-    QPoint m_lastMousePos;
-
-    // 摄像机距离
-    float m_xDistance;
-    float m_yDistance;
-    float m_zDistance;
-
-    // 地形尺寸
-    const float m_length = 25.0f;
-    const float m_width = 25.0f;
-    const float m_height = 25.0f;
-
-    // 不同视角的摄像机位置
-    const std::array<QVector3D, 4> m_cameraPositions = {
-        QVector3D(-30.0f, -60.0f, 25.0f),   // 视角0
-        QVector3D(60.0f, -30.0f, 25.0f),     // 视角1
-        QVector3D(30.0f, 60.0f, 25.0f),      // 视角2
-        QVector3D(-60.0f, 30.0f, 25.0f)      // 视角3
-    };
-
-    // 当前视角
-    int m_perspective;
-
-    // 几何体状态
-    bool m_geometryValid;
+    // 图块在控件中的位置（逻辑像素，左上角为原点）
+    QRect tileRect(int index) const;
+    int viewAt(const QPoint &pos) const;
+    // 控件坐标换算为图块内的帧缓冲区像素（左上角为原点）
+    QPoint tilePixel(int index, const QPoint &pos) const;
+    void updateRegion(const QPoint &pos, bool freehand);
+    void drawTitles();
+    void drawHud(QPainter &painter);
+
+    SlagPondRenderer m_renderer;
+    QVector<SlagPondView*> m_views;
+    int m_columns = 0;
+    int m_activeView = -1;   // 按下鼠标时所在的图块，拖动期间不随位置切换
+    bool m_hudVisible = false;
+    ToolMode m_toolMode = ToolNavigate;
+    QPoint m_pressPos;
+    static const int CLICK_TOLERANCE = 3;   // 按下到松开移动不超过该像素数视为单击
+    // 区域工具：按下点和多边形顶点（渣池坐标），顶点间距小于该像素数时不追加
+    QPointF m_regionStart;
+    QPolygonF m_regionPolygon;
+    QPoint m_lastRegionPos;
+    static const int REGION_VERTEX_SPACING = 6;
+    static const int TILE_SPACING = 5;
 
     // 帧时间统计
-    qint64 m_lastFrameTime = 0;
     float m_frameTime = 0.0f;
+    float m_frameTimeSum = 0.0f;
+    float m_frameTimeMax = 0.0f;
     int m_frameCount = 0;
 };
 
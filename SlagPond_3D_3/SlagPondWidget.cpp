@@ -3,19 +3,48 @@
 
 #include <QTreeWidgetItem>
 #include <QElapsedTimer>
+#include <QTime>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QDebug>
+#include <QSettings>
+#include <QCoreApplication>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QVector2D>
 
 SlagPondWidget::SlagPondWidget(QWidget *parent)
     : QWidget(parent)
     , ui(new Ui::SlagPondWidget)
+    , m_alarmSocket(new QUdpSocket(this))
     , m_udpSocket(new QUdpSocket(this))
     , m_currentPort(0)
     , m_isBound(false)
 {
     ui->setupUi(this);
 
+    // 标定参数
+    QSettings settings(QCoreApplication::applicationDirPath() + "/SlagPond.ini", QSettings::IniFormat);
+    loadRadarSettings(settings);
+
+    // 渣池区域：每个渣池独立融合、统计
+    m_regions.loadSettings(settings);
+    m_merger.reset(m_regions.layout(), m_regions.mask());
+    m_ponds.resize(m_regions.count());
+    for (int i = 0; i < m_ponds.size(); ++i) {
+        const PondRegion &region = m_regions.region(i);
+        m_ponds[i].name = region.name;
+        m_ponds[i].fusion.reset(region.layout);
+        m_ponds[i].fusion.setFloorHeight(m_classifier.floorHeight());
+        m_ponds[i].contours.reset(region.layout);
+        m_ponds[i].changeDetector.loadSettings(settings);
+    }
+
+    // 满池报警阈值和通知地址
+    m_alarm.loadSettings(settings);
+    m_alarm.setPondCount(m_ponds.size());
+    m_alarmHost = QHostAddress(settings.value("alarm/notifyHost", "127.0.0.1").toString());
+    m_alarmPort = settings.value("alarm/notifyPort", m_alarmPort).toUInt();
+
     // 设置窗口属性
     setWindowTitle("水渣池毫米波雷达探测系统 V1.0");
     setMinimumSize(1400, 800);
@@ -38,13 +67,12 @@ SlagPondWidget::SlagPondWidget(QWidget *parent)
 
     // 中间3D显示区域
     QVBoxLayout *viewerLayout = new QVBoxLayout();
-    viewerLayout->addWidget(m_heightViewer, 1);
+    viewerLayout->addWidget(m_viewWidget, 1);
     viewerLayout->addWidget(m_bottomControls);
     viewerLayout->setSpacing(5);
 
     QHBoxLayout *centerLayout = new QHBoxLayout();
-    centerLayout->addWidget(m_heightViewer);
-    centerLayout->addWidget(m_distributionViewer);
+    centerLayout->addWidget(m_viewWidget);
     centerLayout->setSpacing(5);
 
     QVBoxLayout *centerMainLayout = new QVBoxLayout();
@@ -59,11 +87,23 @@ SlagPondWidget::SlagPondWidget(QWidget *parent)
     // 右侧控制面板
     mainLayout->addWidget(m_rightWidget);
 
+    connect(m_toolList, &QListWidget::itemClicked, this, &SlagPondWidget::onToolClicked);
+    connect(m_viewWidget, &SlagPondViewWidget::pointPicked, this, &SlagPondWidget::onPointPicked);
+    connect(m_viewWidget, &SlagPondViewWidget::regionChanged, this, &SlagPondWidget::onRegionChanged);
     connect(m_udpSocket, &QUdpSocket::readyRead, this, &SlagPondWidget::onSocketReadyRead);
+
+    m_clock.start();
+    m_lineFlushTimer = new QTimer(this);
+    m_lineFlushTimer->setSingleShot(true);
+    m_lineFlushTimer->setTimerType(Qt::PreciseTimer);
+    m_lineFlushTimer->setInterval(LINE_FLUSH_MS);
+    connect(m_lineFlushTimer, &QTimer::timeout, this, &SlagPondWidget::onLineFlushTimeout);
+    connect(&m_changeWatcher, &QFutureWatcher<QVector<ChangeResult>>::finished, this, &SlagPondWidget::onChangeDetectionFinished);
 }
 
 SlagPondWidget::~SlagPondWidget()
 {
+    m_changeWatcher.waitForFinished();
     delete ui;
 }
 
@@ -115,39 +155,143 @@ void SlagPondWidget::setupLeftToolbar()
     }
 }
 
-void SlagPondWidget::setup3DViewers()
+void SlagPondWidget::onToolClicked(QListWidgetItem *item)
 {
-    // 料堆实时高度图
-    m_heightViewer = new SlagPondViewWidget(this);
-    m_heightViewer->setMinimumSize(500, 500);
-    m_heightViewer->setStyleSheet(
-        "background: qlineargradient(x1:0, y1:0, x2:1, y2:1, stop:0 #1a1a1a, stop:1 #2d2d2d);"
-        "border: 2px solid #555; border-radius: 3px;"
-        );
+    const QString tool = item->text();
+    if (tool == "选") {
+        m_viewWidget->setToolMode(SlagPondViewWidget::ToolSelect);
+        m_toolInfoLabel->setText("拾取: 单击视图中的点");
+    } else if (tool == "距") {
+        clearMeasurement();
+        m_viewWidget->setToolMode(SlagPondViewWidget::ToolDistance);
+        m_toolInfoLabel->setText("距离: 依次单击两个点");
+    } else if (tool == "区") {
+        clearRegion();
+        m_viewWidget->setToolMode(SlagPondViewWidget::ToolRegion);
+        m_toolInfoLabel->setText("选区: 拖动画矩形，按住Shift拖动画多边形");
+    } else if (tool == "清") {
+        clearMeasurement();
+        clearRegion();
+        m_viewWidget->setToolMode(SlagPondViewWidget::ToolNavigate);
+        m_toolInfoLabel->setText("拾取: -");
+    } else {
+        m_viewWidget->setToolMode(SlagPondViewWidget::ToolNavigate);
+    }
+}
 
-    QLabel *heightTitle = new QLabel("料堆实时高度图");
-    heightTitle->setStyleSheet("color: #00ff00; font-size: 30px; font-weight: bold; background: transparent;");
-    heightTitle->setAlignment(Qt::AlignCenter);
+void SlagPondWidget::clearMeasurement()
+{
+    m_measurePoints.clear();
+    m_heightViewer->setMeasureLine(m_measurePoints);
+    m_distributionViewer->setMeasureLine(m_measurePoints);
+}
 
-    QVBoxLayout *heightLayout = new QVBoxLayout(m_heightViewer);
-    heightLayout->addWidget(heightTitle);
-    heightLayout->setAlignment(heightTitle, Qt::AlignTop);
+void SlagPondWidget::clearRegion()
+{
+    m_region.clear();
+    m_heightViewer->setRegionOutline(m_region);
+    m_distributionViewer->setRegionOutline(m_region);
+}
 
-    // 料堆实时水渣分布图
-    m_distributionViewer = new SlagPondViewWidget(this);
-    m_distributionViewer->setMinimumSize(500, 500);
-    m_distributionViewer->setStyleSheet(
-        "background: qlineargradient(x1:0, y1:0, x2:1, y2:1, stop:0 #1a1a1a, stop:1 #2d2d2d);"
-        "border: 2px solid #555; border-radius: 3px;"
-        );
+void SlagPondWidget::onRegionChanged(SlagPondView *view, const QPolygonF &region, bool rectangle)
+{
+    Q_UNUSED(view);
+    m_region = region;
+    m_regionIsRectangle = rectangle;
+    m_heightViewer->setRegionOutline(m_region);
+    m_distributionViewer->setRegionOutline(m_region);
+    updateRegionStats();
+}
 
-    QLabel *distTitle = new QLabel("料堆实时水渣分布图");
-    distTitle->setStyleSheet("color: #00ffff; font-size: 30px; font-weight: bold; background: transparent;");
-    distTitle->setAlignment(Qt::AlignCenter);
+void SlagPondWidget::updateRegionStats()
+{
+    if (m_region.isEmpty()) {
+        return;
+    }
+    const PondState &pond = m_ponds[m_selectedPond];
+    if (!pond.valid) {
+        return;
+    }
+    if (m_regionStatsDirty) {
+        m_regionStats.setFloorHeight(m_classifier.floorHeight());
+        m_regionStats.build(pond.filledGrid);
+        m_regionStatsDirty = false;
+    }
 
-    QVBoxLayout *distLayout = new QVBoxLayout(m_distributionViewer);
-    distLayout->addWidget(distTitle);
-    distLayout->setAlignment(distTitle, Qt::AlignTop);
+    const RegionStatistics stats = m_regionIsRectangle ? m_regionStats.rectangle(m_region.boundingRect())
+                                                       : m_regionStats.polygon(m_region);
+    if (stats.cellCount == 0) {
+        m_toolInfoLabel->setText(QString("%1 选区: 无有效单元").arg(pond.name));
+        return;
+    }
+    // 覆盖率为有效单元占选区单元的比例
+    m_toolInfoLabel->setText(QString("%1 选区: 面积 %2 m²  体积 %3 m³  覆盖 %4%\n平均高度 %5 m  最高 %6 m  标准差 %7 m")
+                                 .arg(pond.name)
+                                 .arg(stats.area, 0, 'f', 2)
+                                 .arg(stats.volume, 0, 'f', 2)
+                                 .arg(100.0f * stats.cellCount / stats.totalCells, 0, 'f', 0)
+                                 .arg(stats.meanHeight, 0, 'f', 3)
+                                 .arg(stats.maxHeight, 0, 'f', 3)
+                                 .arg(stats.stdDev, 0, 'f', 3));
+}
+
+void SlagPondWidget::onPointPicked(SlagPondView *view, const PickResult &result)
+{
+    if (result.kind == PickResult::None) {
+        m_toolInfoLabel->setText(QString("%1: 光标处没有对象").arg(view->title()));
+        return;
+    }
+
+    const QVector3D &p = result.position;
+    QString kind;
+    switch (result.kind) {
+    case PickResult::Point:         kind = "点"; break;
+    case PickResult::HeightCell:    kind = "高度单元"; break;
+    case PickResult::SurfaceVertex: kind = "网格顶点"; break;
+    default: break;
+    }
+    const QString info = QString("%1 %2  (%3, %4, %5) m")
+                             .arg(kind)
+                             .arg(result.index >= 0 ? QString("#%1").arg(result.index) : QString())
+                             .arg(p.x(), 0, 'f', 2).arg(p.y(), 0, 'f', 2).arg(p.z(), 0, 'f', 2);
+
+    if (m_viewWidget->toolMode() != SlagPondViewWidget::ToolDistance) {
+        m_toolInfoLabel->setText(QString("%1\n%2").arg(view->title(), info));
+        return;
+    }
+
+    // 已有两点时重新开始
+    if (m_measurePoints.size() >= 2) {
+        m_measurePoints.clear();
+    }
+    m_measurePoints.append(p);
+    m_heightViewer->setMeasureLine(m_measurePoints);
+    m_distributionViewer->setMeasureLine(m_measurePoints);
+
+    if (m_measurePoints.size() == 1) {
+        m_toolInfoLabel->setText(QString("距离: 起点 %1\n单击第二个点").arg(info));
+        return;
+    }
+    const QVector3D d = m_measurePoints[1] - m_measurePoints[0];
+    m_toolInfoLabel->setText(QString("距离: %1 m  水平 %2 m  高差 %3 m\n终点 %4")
+                                 .arg(d.length(), 0, 'f', 3)
+                                 .arg(QVector2D(d.x(), d.y()).length(), 0, 'f', 3)
+                                 .arg(d.z(), 0, 'f', 3)
+                                 .arg(info));
+}
+
+void SlagPondWidget::setup3DViewers()
+{
+    // 两个视图共用一个渲染面（一个OpenGL上下文），左右并排
+    m_viewWidget = new SlagPondViewWidget(this);
+    m_viewWidget->setMinimumSize(1005, 500);
+
+    // 料堆实时高度图
+    m_heightViewer = m_viewWidget->addView("料堆实时高度图", QColor("#00ff00"));
+    m_heightViewer->setPointsVisible(m_heightViewMode == HeightViewPoints);
+
+    // 料堆实时水渣分布图
+    m_distributionViewer = m_viewWidget->addView("料堆实时水渣分布图", QColor("#00ffff"));
 }
 
 void SlagPondWidget::setupRightPanel()
@@ -186,6 +330,32 @@ void SlagPondWidget::setupRightPanel()
     optionGrid->addWidget(point, 1, 0);
     optionGrid->addWidget(display, 1, 1);
 
+    // 高度图在融合高度场和当前扫描点云之间切换
+    QPushButton *heightView = new QPushButton("高度场/点云");
+    heightView->setStyleSheet(btnStyle);
+    optionGrid->addWidget(heightView, 2, 0, 1, 2);
+    connect(heightView, &QPushButton::clicked, this, [this]{
+        m_heightViewMode = m_heightViewMode == HeightViewField ? HeightViewPoints : HeightViewField;
+        const bool points = m_heightViewMode == HeightViewPoints;
+        qDebug() << "高度图显示模式:" << (points ? "点云" : "高度场");
+        m_heightViewer->setHeightFieldVisible(!points);
+        m_heightViewer->setPointsVisible(points);
+        if (points) {
+            updatePointCloud();
+        }
+    });
+
+    // 渣池选择：切换两个视图显示的渣池
+    connect(slagPond, &QPushButton::clicked, this, &SlagPondWidget::selectNextPond);
+
+    // 显示模式：水渣分布图在分类、高度、变化着色之间切换
+    connect(display, &QPushButton::clicked, this, [this]{
+        static const char *modeNames[] = {"水渣分类", "高度", "变化"};
+        m_distributionMode = static_cast<DistributionMode>((m_distributionMode + 1) % 3);
+        qDebug() << "水渣分布图显示模式:" << modeNames[m_distributionMode];
+        updateDistributionColors();
+    });
+
     // 连接设置
     QHBoxLayout *ipLayout = new QHBoxLayout();
     QLabel *ipLabel = new QLabel("连接");
@@ -254,16 +424,15 @@ void SlagPondWidget::setupRightPanel()
     QVBoxLayout *statusLayout = new QVBoxLayout(m_statusGroup);
 
     QLabel *statusLabel = new QLabel("工作状态: 空闲");
-    // 渣池状态
+    // 渣池状态：每个渣池一个标签，每列两个
     QGridLayout *slagPondLabelLayout = new QGridLayout();
-    QLabel *slagPondLabel1 = new QLabel("1号渣池: 正常");
-    QLabel *slagPondLabel2 = new QLabel("2号渣池: 正常");
-    QLabel *slagPondLabel3 = new QLabel("3号渣池: 正常");
-    QLabel *slagPondLabel4 = new QLabel("4号渣池: 正常");
-    slagPondLabelLayout->addWidget(slagPondLabel1, 0, 0);
-    slagPondLabelLayout->addWidget(slagPondLabel2, 1, 0);
-    slagPondLabelLayout->addWidget(slagPondLabel3, 0, 1);
-    slagPondLabelLayout->addWidget(slagPondLabel4, 1, 1);
+    m_pondStatusLabels.clear();
+    for (int i = 0; i < m_ponds.size(); ++i) {
+        QLabel *label = new QLabel();
+        slagPondLabelLayout->addWidget(label, i % 2, i / 2);
+        m_pondStatusLabels.append(label);
+        updatePondStatusLabel(i);
+    }
 
     statusLayout->addWidget(statusLabel);
     statusLayout->addLayout(slagPondLabelLayout);
@@ -276,6 +445,7 @@ void SlagPondWidget::setupRightPanel()
 
     // 创建表格显示结果
     QTreeWidget *resultTreeWidget = new QTreeWidget;
+    m_resultTree = resultTreeWidget;
     resultTreeWidget->setColumnCount(4);
     // 创建表头项并设置表头居中
     QTreeWidgetItem *headerItem = new QTreeWidgetItem();
@@ -294,166 +464,22 @@ void SlagPondWidget::setupRightPanel()
     resultTreeWidget->setColumnWidth(2, 50);
     resultTreeWidget->setColumnWidth(3, 50);
 
-    // 父节点1
-    QTreeWidgetItem *parent1 = new QTreeWidgetItem();
-    parent1->setText(0, "16:28");
-    parent1->setTextAlignment(0, Qt::AlignCenter);  // 第1列文本居中
-    resultTreeWidget->addTopLevelItem(parent1);
-
-    // 子节点
-    QTreeWidgetItem *child11 = new QTreeWidgetItem(parent1);
-    child11->setText(0, "16:28");
-    child11->setText(1, "1号");
-    child11->setText(2, "8.85");
-    child11->setText(3, "5.32,7.53");
-
-    // 每一列文本居中
-    for(int i = 0; i < 4; ++i)
-    {
-        child11->setTextAlignment(i, Qt::AlignCenter);
-    }
-
-    QTreeWidgetItem *child12 = new QTreeWidgetItem(parent1);
-    child12->setText(0, "16:28");
-    child12->setText(1, "2号");
-    child12->setText(2, "6.72");
-    child12->setText(3, "3.43,6.82");
-    // 每一列文本居中
-    for(int i = 0; i < 4; ++i)
-    {
-        child12->setTextAlignment(i, Qt::AlignCenter);
-    }
-
-    QTreeWidgetItem *child13 = new QTreeWidgetItem(parent1);
-    child13->setText(0, "16:28");
-    child13->setText(1, "3号");
-    child13->setText(2, "8.07");
-    child13->setText(3, "7.23,4.19");
-    // 每一列文本居中
-    for(int i = 0; i < 4; ++i)
-    {
-        child13->setTextAlignment(i, Qt::AlignCenter);
-    }
-
-    QTreeWidgetItem *child14 = new QTreeWidgetItem(parent1);
-    child14->setText(0, "16:28");
-    child14->setText(1, "4号");
-    child14->setText(2, "4.28");
-    child14->setText(3, "4.19,5.79");
-    // 每一列文本居中
-    for(int i = 0; i < 4; ++i)
-    {
-        child14->setTextAlignment(i, Qt::AlignCenter);
-    }
-
-    // 父节点2
-    QTreeWidgetItem *parent2 = new QTreeWidgetItem();
-    parent2->setText(0, "16:29");
-    parent2->setTextAlignment(0, Qt::AlignCenter);  // 第1列文本居中
-    resultTreeWidget->addTopLevelItem(parent2);
-
-
-    // 子节点
-    QTreeWidgetItem *child21 = new QTreeWidgetItem(parent2);
-    child21->setText(0, "16:29");
-    child21->setText(1, "1号");
-    child21->setText(2, "8.87");
-    child21->setText(3, "5.88,7.81");
-    // 每一列文本居中
-    for(int i = 0; i < 4; ++i)
-    {
-        child21->setTextAlignment(i, Qt::AlignCenter);
-    }
-
-    QTreeWidgetItem *child22 = new QTreeWidgetItem(parent2);
-    child22->setText(0, "16:29");
-    child22->setText(1, "2号");
-    child22->setText(2, "6.73");
-    child22->setText(3, "3.39,6.91");
-    // 每一列文本居中
-    for(int i = 0; i < 4; ++i)
-    {
-        child22->setTextAlignment(i, Qt::AlignCenter);
-    }
-
-    QTreeWidgetItem *child23 = new QTreeWidgetItem(parent2);
-    child23->setText(0, "16:29");
-    child23->setText(1, "3号");
-    child23->setText(2, "8.09");
-    child23->setText(3, "7.20,4.23");
-    // 每一列文本居中
-    for(int i = 0; i < 4; ++i)
-    {
-        child23->setTextAlignment(i, Qt::AlignCenter);
-    }
-
-    QTreeWidgetItem *child24 = new QTreeWidgetItem(parent2);
-    child24->setText(0, "16:29");
-    child24->setText(1, "4号");
-    child24->setText(2, "4.30");
-    child24->setText(3, "4.25,5.60");
-    // 每一列文本居中
-    for(int i = 0; i < 4; ++i)
-    {
-        child24->setTextAlignment(i, Qt::AlignCenter);
-    }
-
-    // 父节点3
-    QTreeWidgetItem *parent3 = new QTreeWidgetItem();
-    parent3->setText(0, "16:30");
-    parent3->setTextAlignment(0, Qt::AlignCenter);  // 第1列文本居中
-    resultTreeWidget->addTopLevelItem(parent3);
-
-    // 子节点
-    QTreeWidgetItem *child31 = new QTreeWidgetItem(parent3);
-    child31->setText(0, "16:30");
-    child31->setText(1, "1号");
-    child31->setText(2, "8.90");
-    child31->setText(3, "5.67,7.71");
-    // 每一列文本居中
-    for(int i = 0; i < 4; ++i)
-    {
-        child31->setTextAlignment(i, Qt::AlignCenter);
-    }
-
-    QTreeWidgetItem *child32 = new QTreeWidgetItem(parent3);
-    child32->setText(0, "16:30");
-    child32->setText(1, "2号");
-    child32->setText(2, "6.75");
-    child32->setText(3, "3.32,6.82");
-    // 每一列文本居中
-    for(int i = 0; i < 4; ++i)
-    {
-        child32->setTextAlignment(i, Qt::AlignCenter);
-    }
-
-    QTreeWidgetItem *child33 = new QTreeWidgetItem(parent3);
-    child33->setText(0, "16:30");
-    child33->setText(1, "3号");
-    child33->setText(2, "8.11");
-    child33->setText(3, "7.12,4.31");
-    // 每一列文本居中
-    for(int i = 0; i < 4; ++i)
-    {
-        child33->setTextAlignment(i, Qt::AlignCenter);
-    }
-
-    QTreeWidgetItem *child34 = new QTreeWidgetItem(parent3);
-    child34->setText(0, "16:30");
-    child34->setText(1, "4号");
-    child34->setText(2, "4.32");
-    child34->setText(3, "4.22,5.63");
-    // 每一列文本居中
-    for(int i = 0; i < 4; ++i)
-    {
-        child34->setTextAlignment(i, Qt::AlignCenter);
-    }
+    // 每个渣池一行
+    setupResultRows();
 
     // 展开所有节点
     resultTreeWidget->expandAll();
 
     resultLayout->addWidget(resultTreeWidget);
 
+    // 水/渣分类统计
+    m_classSummaryLabel = new QLabel("水面: -\n水渣: -");
+    resultLayout->addWidget(m_classSummaryLabel);
+
+    // 选择/距离工具的拾取结果
+    m_toolInfoLabel = new QLabel("拾取: -");
+    resultLayout->addWidget(m_toolInfoLabel);
+
     // 右侧面板外层布局
     rightLayout->addWidget(selectConnectWidget);
     rightLayout->addWidget(m_statusGroup);
@@ -515,19 +541,8 @@ void SlagPondWidget::setupRightPanel()
         sendDatagram(datagram, QHostAddress(ipEdit->text()), portEdit->text().toInt());
     });
     // connect(historicalData, &QPushButton::clicked, this, &SlagPondWidget::selectFile);
-    connect(historicalData, &QPushButton::clicked, historicalData, [this, child11]{
-        this->selectFile();
-        // 通过父对象查找子项，避免悬空指针
-        QTreeWidget* resultTreeWidget = m_resultGroup->findChild<QTreeWidget*>();
-        if (resultTreeWidget) {
-            QTreeWidgetItem* firstParent = resultTreeWidget->topLevelItem(0);
-            if (firstParent && firstParent->childCount() > 0) {
-                QTreeWidgetItem* firstChild = firstParent->child(0);
-                firstChild->setText(2, QString::number(m_maxHeight, 'f', 2));
-                firstChild->setText(3, QString(QString::number(m_maxHeight_x, 'f', 2) + "," + QString::number(m_maxHeight_y, 'f', 2)));
-            }
-        }
-    });
+    // 结果表在每次融合后由updateResultRow()更新
+    connect(historicalData, &QPushButton::clicked, this, &SlagPondWidget::selectFile);
 
 }
 
@@ -629,130 +644,575 @@ void SlagPondWidget::setupBottomControls()
     bottomLayout->addWidget(rightBtnWidget);
 
     // 连接信号槽
-    connect(rotateBtn, &QPushButton::clicked, m_heightViewer, &SlagPondViewWidget::resetView);
-    connect(enlargeBtn, &QPushButton::clicked, m_heightViewer, &SlagPondViewWidget::enlarge);
-    connect(reduceBtn, &QPushButton::clicked, m_heightViewer, &SlagPondViewWidget::reduce);
+    connect(rotateBtn, &QPushButton::clicked, m_heightViewer, &SlagPondView::resetView);
+    connect(enlargeBtn, &QPushButton::clicked, m_heightViewer, &SlagPondView::enlarge);
+    connect(reduceBtn, &QPushButton::clicked, m_heightViewer, &SlagPondView::reduce);
 
-    connect(rotateBtn2, &QPushButton::clicked, m_distributionViewer, &SlagPondViewWidget::resetView);
-    connect(enlargeBtn2, &QPushButton::clicked, m_distributionViewer, &SlagPondViewWidget::enlarge);
-    connect(reduceBtn2, &QPushButton::clicked, m_distributionViewer, &SlagPondViewWidget::reduce);
+    connect(rotateBtn2, &QPushButton::clicked, m_distributionViewer, &SlagPondView::resetView);
+    connect(enlargeBtn2, &QPushButton::clicked, m_distributionViewer, &SlagPondView::enlarge);
+    connect(reduceBtn2, &QPushButton::clicked, m_distributionViewer, &SlagPondView::reduce);
 }
 
 bool SlagPondWidget::loadCSV(const QString &filePath, char separator)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "无法打开文件:" << filePath;
-        QMessageBox::warning(this, "错误", QString("无法打开文件: %1").arg(filePath));
-        return false;
-    }
-
     QElapsedTimer timer1;
     timer1.start();
     qDebug() << "开始加载并绘制点集";
 
     QElapsedTimer timer2;
     timer2.start();
-    QVector<QVector3D> newPoints;
-    newPoints.reserve(1000000);
 
-    QTextStream in(&file);
-    in.setEncoding(QStringConverter::Encoding::System);
+    QString errorString;
+    // 文件数据按主雷达处理
+    if (!m_radars[0].image.loadCSV(filePath, separator, 1000000, &errorString)) {
+        qWarning() << errorString;
+        QMessageBox::warning(this, "错误", errorString);
+        return false;
+    }
 
-    // 读取表头
-    QString header = in.readLine().trimmed();
-    qDebug() << "CSV表头:" << header;
+    float msTime = timer2.nsecsElapsed() / 1000000.0f;
+    qDebug() << "加载文件用时:" << msTime << "ms";
+    // 文件数据没有分片到达时间，延迟从加载完成起计
+    m_lastFragmentTime = m_clock.nsecsElapsed();
 
-    int lineCount = 0;
-    int validPointCount = 0;
-    float minHeight;
-    float maxHeight;
+    integrateScanLines(true);
 
-    // 读取数据
-    while (!in.atEnd()) {
-        QString line = in.readLine().trimmed();
-        lineCount++;
+    // 帧时间统计
+    msTime = timer1.nsecsElapsed() / 1000000.0f;
+    qDebug() << "更新3D图像总耗时:" << msTime << "ms";
+    return true;
+}
 
-        if (line.isEmpty()) {
+void SlagPondWidget::loadRadarSettings(QSettings &settings)
+{
+    // 水渣分类参数；池底高度同时是报警体积和选区体积的基准
+    m_classifier.loadSettings(settings);
+    // 回波幅度所在列，[radarN]中可单独指定，小于0表示数据中没有幅度
+    const int amplitudeColumn = settings.value("classifier/amplitudeColumn",
+                                               RangeImage::DEFAULT_AMPLITUDE_COLUMN).toInt();
+
+    m_radars.resize(1);
+    m_radars[0].transform.loadSettings(settings);
+    m_radars[0].image.setAmplitudeColumn(amplitudeColumn);
+
+    const QStringList groups = settings.childGroups();
+    for (int i = 1; groups.contains(QString("radar%1").arg(i)); ++i) {
+        const QString group = QString("radar%1").arg(i);
+        RadarStream stream;
+        stream.transform.loadSettings(settings, group);
+        stream.image.setAmplitudeColumn(settings.value(group + "/amplitudeColumn", amplitudeColumn).toInt());
+        stream.address = QHostAddress(settings.value(group + "/address").toString());
+        if (stream.address.isNull()) {
+            qDebug() << group << "未配置address，忽略";
             continue;
         }
+        m_radars.append(stream);
+    }
+    qDebug() << "雷达数量:" << m_radars.size();
+}
+
+int SlagPondWidget::radarForSender(const QHostAddress &sender) const
+{
+    for (int i = 1; i < m_radars.size(); ++i) {
+        if (m_radars[i].address.isEqual(sender)) {
+            return i;
+        }
+    }
+    return 0;
+}
 
-        QStringList fields = line.split(separator);
-        if (fields.size() < 3) {
-            qWarning() << "第" << lineCount << "行数据列数不足，跳过";
+bool SlagPondWidget::integrateRadar(int radar)
+{
+    RadarStream &stream = m_radars[radar];
+    const QVector<int> dirtyLines = stream.image.takeDirtyLines();
+    if (dirtyLines.isEmpty()) {
+        return false;
+    }
+    for (int row : dirtyLines) {
+        m_lastFragmentTime = qMax(m_lastFragmentTime, stream.image.lineArrival(row));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    // 原始数据 -> 渣池坐标系（米），含该雷达的配准修正
+    stream.transform.apply(stream.image, dirtyLines);
+    const float transformTime = timer.nsecsElapsed() / 1000000.0f;
+
+    // 与其它雷达重叠的单元去重，渣池区域外的点在此丢弃
+    m_mergedPoints.clear();
+    const int merged = m_merger.merge(radar, stream.image, dirtyLines, m_mergedPoints);
+
+    // 按渣池区域拆分
+    m_regions.split(m_mergedPoints, m_pondPoints);
+
+    int changed = 0;
+    for (int i = 0; i < m_ponds.size(); ++i) {
+        const MergedPoints &points = m_pondPoints[i];
+        if (points.size() == 0) {
             continue;
         }
+        PondState &pond = m_ponds[i];
+        const QVector<int> &changedCells = pond.fusion.integrate(points.x.constData(), points.y.constData(),
+                                                                 points.z.constData(), points.amplitude.constData(),
+                                                                 points.size());
+        pond.contours.markDirty(changedCells);
+        pond.fusedCells += changedCells;
+        // 其它渣池切换显示时整幅上传，只有当前显示的渣池需要记录变化单元
+        if (i == m_selectedPond) {
+            pond.viewChangedCells += changedCells;
+        }
+        pond.updated = true;
+        changed += changedCells.size();
+    }
+
+    qDebug() << "雷达" << radar << "融合扫描线数:" << dirtyLines.size() << "，保留点数:" << merged
+             << "，更新单元数:" << changed
+             << "，坐标变换用时:" << transformTime << "ms"
+             << "，总用时:" << timer.nsecsElapsed() / 1000000.0f << "ms";
+    return true;
+}
+
+void SlagPondWidget::integrateScanLines(bool scanCompleted)
+{
+    bool updated = false;
+    for (int radar = 0; radar < m_radars.size(); ++radar) {
+        updated |= integrateRadar(radar);
+    }
+    if (!updated) {
+        return;
+    }
+
+    // 报警判定只依赖融合结果，放在所有统计和绘制之前
+    evaluateAlarms();
+    m_lastFragmentTime = -1;
+
+    for (int i = 0; i < m_ponds.size(); ++i) {
+        if (m_ponds[i].updated) {
+            updatePondResults(i);
+            m_ponds[i].updated = false;
+        }
+    }
+    if (scanCompleted) {
+        archiveResults();
+    }
 
-        // 解析坐标
-        bool okX, okY, okZ;
-        float x = fields[0].toFloat(&okX);
-        //float y = fields[1].toFloat(&okY);
-        float z = fields[2].toFloat(&okZ);
-        float y = (fields[10].toInt(&okY) % 1151) * 100.0f / 1151.0f;
+    updateViewers();
+    startChangeDetection(scanCompleted);
+}
 
-        if (!okX || !okY || !okZ) {
-            qWarning() << "第" << lineCount << "行数据格式错误，跳过";
+void SlagPondWidget::evaluateAlarms()
+{
+    for (int i = 0; i < m_ponds.size(); ++i) {
+        const PondState &pond = m_ponds[i];
+        float height;
+        if (!pond.updated || !pond.fusion.maxHeight(&height)) {
+            continue;
+        }
+        const float volume = pond.fusion.volume();
+        if (!m_alarm.evaluate(i, height, volume)) {
             continue;
         }
 
-        // 添加点
-
-        // 缩放
-        float x_show = x / 4;
-        float y_show = y / 4;
-        float z_show = z / 4;
-        newPoints.append(QVector3D(x_show, y_show, z_show));
-        validPointCount++;
-        // // 测试：构建多个y分量并绘制
-        // for(int i = 0; i < 1000; ++i)
-        // {
-        //     newPoints.append(QVector3D(x_show, 25.0f * (i / 1000), z_show));
-        // }
-
-        // 更新高度范围
-        if (validPointCount == 1) {
-            minHeight = z;
-            maxHeight = z;
-            m_maxHeight_x = x;
-            m_maxHeight_y = y;
+        // 延迟：最后一个数据分片到达 -> 报警发出
+        const float latency = m_lastFragmentTime >= 0 ? (m_clock.nsecsElapsed() - m_lastFragmentTime) / 1000000.0f : 0.0f;
+        notifyAlarm(i, height, volume, latency);
+        updatePondStatusLabel(i);
+
+        m_worstAlarmLatency = qMax(m_worstAlarmLatency, latency);
+        qDebug() << pond.name << "报警状态:" << OverflowAlarm::levelName(m_alarm.level(i))
+                 << "，高度" << height << "，体积" << volume
+                 << "，延迟" << latency << "ms（最大" << m_worstAlarmLatency << "ms）";
+        if (latency > ALARM_LATENCY_TARGET) {
+            qWarning() << "报警延迟超过" << ALARM_LATENCY_TARGET << "ms";
+        }
+    }
+}
+
+void SlagPondWidget::notifyAlarm(int pond, float height, float volume, float latencyMs)
+{
+    if (m_alarmHost.isNull()) {
+        return;
+    }
+
+    // ALARM,渣池,等级,高度,体积,延迟ms
+    const QString message = QString("ALARM,%1,%2,%3,%4,%5")
+                                .arg(m_ponds[pond].name)
+                                .arg(static_cast<int>(m_alarm.level(pond)))
+                                .arg(height, 0, 'f', 2)
+                                .arg(volume, 0, 'f', 1)
+                                .arg(latencyMs, 0, 'f', 1);
+    if (m_alarmSocket->writeDatagram(message.toUtf8(), m_alarmHost, m_alarmPort) == -1) {
+        qDebug() << QString("报警通知发送失败: %1").arg(m_alarmSocket->errorString());
+    }
+}
+
+void SlagPondWidget::updatePondStatusLabel(int pond)
+{
+    if (pond >= m_pondStatusLabels.size()) {
+        return;
+    }
+
+    static const char *levelColors[] = {"black", "#ff9900", "red"};
+    const AlarmLevel level = m_alarm.level(pond);
+    QLabel *label = m_pondStatusLabels[pond];
+    label->setText(QString("%1渣池: %2").arg(m_ponds[pond].name, OverflowAlarm::levelName(level)));
+    label->setStyleSheet(QString("color: %1;").arg(levelColors[level]));
+}
+
+void SlagPondWidget::updatePondResults(int index)
+{
+    PondState &pond = m_ponds[index];
+    const HeightGrid &grid = pond.fusion.grid();
+    QVector<int> fusedCells;
+    fusedCells.swap(pond.fusedCells);
+
+    // 最高、最低点由融合增量维护，不再整幅扫描
+    int maxIndex = 0;
+    if (!pond.fusion.maxHeight(&pond.maxHeight, &maxIndex) || !pond.fusion.minHeight(&pond.minHeight)) {
+        return;
+    }
+    pond.maxPoint = grid.cellCenter(maxIndex);
+    pond.valid = true;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 雷达阴影补洞，只填充渣池区域内的单元
+    // 记录插值结果有变化的单元，网格和分类只更新这些单元
+    QVector<int> filledCells;
+    pond.filledCount = m_holeFiller.fill(grid, m_regions.region(index).mask, pond.filledGrid, pond.filledMask,
+                                         &filledCells);
+    if (index == m_selectedPond) {
+        pond.viewFilledCells += filledCells;
+    }
+    const float fillTime = timer.nsecsElapsed() / 1000000.0f;
+
+    // 水/渣分类（面积、体积按补洞后的栅格统计），只重新分类融合或补洞有变化的单元
+    fusedCells += filledCells;
+    m_classifier.update(pond.filledGrid, pond.fusion.amplitude(), pond.filledMask, fusedCells, pond.classification);
+    const float classifyTime = timer.nsecsElapsed() / 1000000.0f - fillTime;
+
+    // 前K个峰值，水面以下的局部极大值不是料堆
+    m_peakFinder.setMinHeight(m_classifier.waterLevel());
+    pond.peaks = m_peakFinder.find(grid);
+    const float peakTime = timer.nsecsElapsed() / 1000000.0f - classifyTime - fillTime;
+
+    // 只重新生成有单元变化的块
+    pond.contoursChanged |= pond.contours.update(grid);
+
+    qDebug() << pond.name << "高度范围: min=" << pond.minHeight << ", max=" << pond.maxHeight
+             << "，补洞" << pond.filledCount << "个单元，用时:" << fillTime << "ms"
+             << "，分类用时:" << classifyTime << "ms"
+             << "，峰值" << pond.peaks.size() << "个，用时:" << peakTime << "ms";
+
+    updateResultRow(index);
+}
+
+void SlagPondWidget::updateViewers()
+{
+    PondState &pond = m_ponds[m_selectedPond];
+    QVector<int> changedCells;
+    QVector<int> filledCells;
+    changedCells.swap(pond.viewChangedCells);
+    filledCells.swap(pond.viewFilledCells);
+    if (!pond.valid) {
+        return;
+    }
+    const HeightGrid &grid = pond.fusion.grid();
+
+    // 栅格已是渣池坐标系（米），以高度场显示；切换渣池时整幅上传，否则只上传变化的块
+    const bool switched = m_displayedPond != m_selectedPond;
+    m_heightViewer->setHeightField(grid, pond.minHeight, pond.maxHeight, switched ? nullptr : &changedCells);
+
+    // 网格用补洞后的栅格，避免阴影处断裂；切换渣池时整体重建，否则只更新变化的单元
+    // 补洞单元的插值随周围实测值变化，插值有变化的单元与变化单元一起更新
+    if (switched || m_surfaceMesh.vertexCount() != pond.filledGrid.cellCount()) {
+        m_surfaceMesh.build(pond.filledGrid);
+        m_distributionViewer->setSurfaceMesh(m_surfaceMesh, pond.minHeight, pond.maxHeight);
+    } else {
+        changedCells += filledCells;
+        m_surfaceMesh.update(pond.filledGrid, changedCells);
+        m_distributionViewer->setSurfaceMesh(m_surfaceMesh, pond.minHeight, pond.maxHeight, &changedCells);
+    }
+
+    if (m_heightViewMode == HeightViewPoints) {
+        updatePointCloud();
+    }
+
+    if (pond.contoursChanged || switched) {
+        const QVector<QVector3D> segments = pond.contours.segments();
+        m_heightViewer->setContourSegments(segments);
+        m_distributionViewer->setContourSegments(segments);
+        pond.contoursChanged = false;
+    }
+
+    QVector<QVector3D> markers;
+    markers.reserve(pond.peaks.size());
+    for (const Peak &peak : pond.peaks) {
+        markers.append(QVector3D(peak.position.x(), peak.position.y(), peak.height));
+    }
+    m_heightViewer->setMarkers(markers);
+
+    const ClassStats &water = pond.classification.water;
+    const ClassStats &slag = pond.classification.slag;
+    if (m_classSummaryLabel) {
+        // 置信度为实测单元占比（其余为补洞插值）
+        m_classSummaryLabel->setText(QString("%1  水面: 面积 %2  体积 %3  置信度 %4%\n%1  水渣: 面积 %5  体积 %6  置信度 %7%")
+                                         .arg(pond.name)
+                                         .arg(water.area, 0, 'f', 2).arg(water.volume, 0, 'f', 2)
+                                         .arg(water.confidence() * 100.0f, 0, 'f', 0)
+                                         .arg(slag.area, 0, 'f', 2).arg(slag.volume, 0, 'f', 2)
+                                         .arg(slag.confidence() * 100.0f, 0, 'f', 0));
+    }
+
+    // 栅格已更新，有选区时重建积分图并刷新统计
+    m_regionStatsDirty = true;
+    updateRegionStats();
+
+    m_displayedPond = m_selectedPond;
+    updateDistributionColors();
+}
+
+void SlagPondWidget::updatePointCloud()
+{
+    const PondState &pond = m_ponds[m_selectedPond];
+    if (!pond.valid) {
+        return;
+    }
+
+    // 距离图像中已融合的扫描线均已变换到渣池坐标系
+    QVector<QVector3D> points;
+    for (const RadarStream &stream : m_radars) {
+        const RangeImage &image = stream.image;
+        const float *x = image.xs().constData();
+        const float *y = image.ys().constData();
+        const float *z = image.zs().constData();
+        for (int row = 0; row < image.rows(); ++row) {
+            const int base = image.index(row, 0);
+            for (int i = base; i < base + image.lineCount(row); ++i) {
+                if (m_regions.pondAt(x[i], y[i]) == m_selectedPond) {
+                    points.append(QVector3D(x[i], y[i], z[i]));
+                }
+            }
+        }
+    }
+    m_heightViewer->setPointsData(points, pond.minHeight, pond.maxHeight);
+}
+
+void SlagPondWidget::selectNextPond()
+{
+    m_selectedPond = (m_selectedPond + 1) % m_ponds.size();
+    qDebug() << "当前显示渣池:" << m_ponds[m_selectedPond].name;
+
+    if (m_resultTree && m_resultTree->topLevelItem(0)) {
+        m_resultTree->setCurrentItem(m_resultTree->topLevelItem(0)->child(m_selectedPond));
+    }
+    updateViewers();
+}
+
+void SlagPondWidget::setupResultRows()
+{
+    // 第一行为实时结果，每个渣池一个子项；完整扫描结束后复制一份作为历史记录
+    QTreeWidgetItem *live = new QTreeWidgetItem();
+    live->setText(0, "实时");
+    live->setTextAlignment(0, Qt::AlignCenter);
+    m_resultTree->addTopLevelItem(live);
+
+    for (const PondState &pond : m_ponds) {
+        QTreeWidgetItem *row = new QTreeWidgetItem(live);
+        row->setText(1, pond.name);
+        for (int col = 0; col < 4; ++col) {
+            row->setTextAlignment(col, Qt::AlignCenter);
+        }
+    }
+    live->setExpanded(true);
+}
+
+void SlagPondWidget::updateResultRow(int index)
+{
+    QTreeWidgetItem *live = m_resultTree ? m_resultTree->topLevelItem(0) : nullptr;
+    if (!live || index >= live->childCount()) {
+        return;
+    }
+
+    const PondState &pond = m_ponds[index];
+    const QString time = QTime::currentTime().toString("HH:mm:ss");
+
+    QTreeWidgetItem *row = live->child(index);
+    row->setText(0, time);
+    row->setText(2, QString::number(pond.maxHeight, 'f', 2));
+    row->setText(3, QString::number(pond.maxPoint.x(), 'f', 2) + "," + QString::number(pond.maxPoint.y(), 'f', 2));
+
+    // 峰值按高度降序列为子项
+    qDeleteAll(row->takeChildren());
+    for (int i = 0; i < pond.peaks.size(); ++i) {
+        const Peak &peak = pond.peaks[i];
+        QTreeWidgetItem *item = new QTreeWidgetItem(row);
+        item->setText(1, QString("峰%1").arg(i + 1));
+        item->setText(2, QString::number(peak.height, 'f', 2));
+        item->setText(3, QString::number(peak.position.x(), 'f', 2) + "," + QString::number(peak.position.y(), 'f', 2));
+        for (int col = 0; col < 4; ++col) {
+            item->setTextAlignment(col, Qt::AlignCenter);
+        }
+    }
+}
+
+void SlagPondWidget::archiveResults()
+{
+    QTreeWidgetItem *live = m_resultTree ? m_resultTree->topLevelItem(0) : nullptr;
+    if (!live) {
+        return;
+    }
+
+    QTreeWidgetItem *snapshot = live->clone();
+    snapshot->setText(0, QTime::currentTime().toString("HH:mm"));
+    m_resultTree->insertTopLevelItem(1, snapshot);
+
+    // 历史记录最多保留MAX_HISTORY条
+    while (m_resultTree->topLevelItemCount() > MAX_HISTORY + 1) {
+        delete m_resultTree->takeTopLevelItem(m_resultTree->topLevelItemCount() - 1);
+    }
+}
+
+void SlagPondWidget::startChangeDetection(bool scanCompleted)
+{
+    // 首次扫描只作为参考
+    QVector<int> ponds;
+    for (int i = 0; i < m_ponds.size(); ++i) {
+        PondState &pond = m_ponds[i];
+        if (!pond.changeDetector.hasReference()) {
+            if (pond.valid) {
+                pond.changeDetector.setReference(pond.fusion.grid());
+            }
         } else {
-            minHeight = qMin(minHeight, z);
-            maxHeight = qMax(maxHeight, z);
+            ponds.append(i);
+        }
+    }
+    if (ponds.isEmpty()) {
+        return;
+    }
 
-            if(maxHeight != z)
-            {
-                m_maxHeight_x = x;
-                m_maxHeight_y = y;
+    // 上一次检测未完成时只记下请求，完成后再按最新数据检测
+    if (m_changeWatcher.isRunning()) {
+        m_changePending = true;
+    } else {
+        QVector<ChangeDetector> detectors;
+        QVector<HeightGrid> grids;
+        for (int i : ponds) {
+            detectors.append(m_ponds[i].changeDetector);
+            grids.append(m_ponds[i].fusion.grid());
+        }
+        m_changePonds = ponds;
+        m_changeWatcher.setFuture(QtConcurrent::run([detectors, grids] {
+            QVector<ChangeResult> results;
+            for (int i = 0; i < detectors.size(); ++i) {
+                results.append(detectors[i].detect(grids[i]));
             }
+            return results;
+        }));
+    }
+
+    // 完整扫描结束后，以本次结果作为下一次的参考
+    if (scanCompleted) {
+        for (int i : ponds) {
+            m_ponds[i].changeDetector.setReference(m_ponds[i].fusion.grid());
         }
-        m_minHeight = minHeight;
-        m_maxHeight = maxHeight;
-        // 限制最大点数量
-        if (validPointCount >= 1000000) {
-            qDebug() << "达到最大点数限制(10000)，停止读取";
-            break;
+    }
+}
+
+void SlagPondWidget::onChangeDetectionFinished()
+{
+    const QVector<ChangeResult> results = m_changeWatcher.result();
+
+    for (int k = 0; k < results.size() && k < m_changePonds.size(); ++k) {
+        PondState &pond = m_ponds[m_changePonds[k]];
+        pond.lastChange = results[k];
+
+        qDebug() << pond.name << "变化检测: 连通块" << pond.lastChange.blobs.size() << "个，最大高差" << pond.lastChange.maxAbsDelta;
+        for (const ChangeBlob &blob : pond.lastChange.blobs) {
+            qDebug() << (blob.sign > 0 ? "  堆高" : "  降低")
+                     << "中心(" << blob.centroid.x() << "," << blob.centroid.y() << ")"
+                     << "面积" << blob.area << "体积" << blob.volume;
         }
     }
 
-    file.close();
-    float msTime = timer2.nsecsElapsed() / 1000000.0f;
-    qDebug() << "加载文件用时:" << msTime << "ms";
+    if (m_distributionMode == DistributionChange) {
+        updateDistributionColors();
+    }
 
-    if (validPointCount == 0) {
-        qWarning() << "文件中没有有效数据";
-        QMessageBox::warning(this, "警告", "文件中没有有效数据");
-        return false;
+    if (m_changePending) {
+        m_changePending = false;
+        startChangeDetection(false);
     }
+}
 
-    qDebug() << "成功读取" << validPointCount << "个点，总行数:" << lineCount;
-    qDebug() << "高度范围: min=" << minHeight << ", max=" << maxHeight;
+void SlagPondWidget::updateDistributionColors()
+{
+    const PondState &pond = m_ponds[m_selectedPond];
+    const int cellCount = pond.fusion.grid().cellCount();
+
+    if (m_distributionMode == DistributionClass && pond.classification.labels.size() == cellCount) {
+        // 分类着色：水面为蓝色，水渣为土黄色
+        static const QVector4D classColors[] = {
+            QVector4D(0.3f, 0.3f, 0.3f, 1.0f),   // 未知
+            QVector4D(0.1f, 0.4f, 0.9f, 1.0f),   // 水面
+            QVector4D(0.7f, 0.55f, 0.3f, 1.0f)   // 水渣
+        };
+        // 补洞插值的单元颜色减暗
+        const bool hasFilled = pond.filledMask.size() == cellCount;
+        m_nextSurfaceColors.resize(cellCount);
+        for (int i = 0; i < cellCount; ++i) {
+            m_nextSurfaceColors[i] = classColors[pond.classification.labels[i]];
+            if (hasFilled && pond.filledMask[i]) {
+                m_nextSurfaceColors[i] = QVector4D(m_nextSurfaceColors[i].toVector3D() * 0.6f, 1.0f);
+            }
+        }
+        pushSurfaceColors();
+        return;
+    }
 
-    m_heightViewer->setPointsData(newPoints, m_minHeight/4, m_maxHeight/4);
+    const ChangeResult &change = pond.lastChange;
+    if (m_distributionMode != DistributionChange || change.delta.size() != cellCount) {
+        m_nextSurfaceColors.clear();
+        pushSurfaceColors();
+        return;
+    }
 
-    // 帧时间统计
-    msTime = timer1.nsecsElapsed() / 1000000.0f;
-    qDebug() << "更新3D图像总耗时:" << msTime << "ms";
-    return true;
+    // 变化量着色：灰色为无变化，红色为堆高，蓝色为降低
+    const float range = qMax(change.maxAbsDelta, pond.changeDetector.threshold());
+    m_nextSurfaceColors.resize(change.delta.size());
+    for (int i = 0; i < m_nextSurfaceColors.size(); ++i) {
+        const float t = qBound(-1.0f, change.delta[i] / range, 1.0f);
+        if (t >= 0.0f) {
+            m_nextSurfaceColors[i] = QVector4D(0.5f + 0.5f * t, 0.5f * (1.0f - t), 0.5f * (1.0f - t), 1.0f);
+        } else {
+            m_nextSurfaceColors[i] = QVector4D(0.5f * (1.0f + t), 0.5f * (1.0f + t), 0.5f - 0.5f * t, 1.0f);
+        }
+    }
+    pushSurfaceColors();
+}
+
+void SlagPondWidget::pushSurfaceColors()
+{
+    // 换渣池、切换模式（颜色数量变化）时整体推送
+    if (m_surfaceColorsPond != m_selectedPond || m_nextSurfaceColors.size() != m_surfaceColors.size()) {
+        m_surfaceColors = m_nextSurfaceColors;
+        m_surfaceColorsPond = m_selectedPond;
+        m_distributionViewer->setSurfaceColors(m_surfaceColors);
+        return;
+    }
+
+    // 扫描间大部分单元的类别不变，只推送颜色有变化的顶点
+    m_changedColors.clear();
+    for (int i = 0; i < m_nextSurfaceColors.size(); ++i) {
+        if (m_nextSurfaceColors[i] != m_surfaceColors[i]) {
+            m_surfaceColors[i] = m_nextSurfaceColors[i];
+            m_changedColors.append(i);
+        }
+    }
+    if (!m_changedColors.isEmpty()) {
+        m_distributionViewer->setSurfaceColors(m_surfaceColors, &m_changedColors);
+    }
 }
 
 void SlagPondWidget::onSocketReadyRead()
@@ -770,10 +1230,62 @@ void SlagPondWidget::onSocketReadyRead()
             continue;
         }
 
+        // 点云数据按来源雷达、按扫描线增量写入距离图像，其余按文本消息处理
+        if (m_radars[radarForSender(senderAddress)].image.decodeDatagram(datagram, ',', m_clock.nsecsElapsed()) > 0) {
+            continue;
+        }
+
         QString message = QString::fromUtf8(datagram);
         qDebug() << QString("来自 %1:%2 -> %3").arg(senderAddress.toString()).arg(senderPort).arg(message);
 
     }
+
+    // 未写入的扫描线片段等待后续数据，超时后由onLineFlushTimeout整行写入
+    for (const RadarStream &stream : m_radars) {
+        if (stream.image.hasPendingLine() && !m_lineFlushTimer->isActive()) {
+            m_lineFlushTimer->start();
+        }
+    }
+
+    processReceivedLines();
+}
+
+void SlagPondWidget::onLineFlushTimeout()
+{
+    // 最后一个片段到达后LINE_FLUSH_MS内没有后续片段的扫描线视为完整
+    const qint64 deadline = m_clock.nsecsElapsed() - LINE_FLUSH_MS * 1000000LL;
+    bool pending = false;
+    for (RadarStream &stream : m_radars) {
+        if (!stream.image.hasPendingLine()) {
+            continue;
+        }
+        if (stream.image.pendingArrival() <= deadline) {
+            stream.image.commitPendingLine();
+        } else {
+            pending = true;
+        }
+    }
+    if (pending) {
+        m_lineFlushTimer->start();
+    }
+
+    processReceivedLines();
+}
+
+void SlagPondWidget::processReceivedLines()
+{
+    // 主雷达扫描线序号回绕说明上一次扫描已结束
+    RadarStream &primary = m_radars[0];
+    bool scanCompleted = false;
+    for (int row : primary.image.dirtyLines()) {
+        if (primary.lastScanRow >= 0 && row < primary.lastScanRow - RangeImage::SCAN_LINES / 2) {
+            scanCompleted = true;
+        }
+        primary.lastScanRow = row;
+    }
+
+    // 收到的扫描线增量融合
+    integrateScanLines(scanCompleted);
 }
 
 qint64 SlagPondWidget::sendDatagram(const QByteArray &data, const QHostAddress &targetHost, quint16 targetPort)
@@ -2,6 +2,19 @@
 #define SLAGPONDWIDGET_H
 
 #include "SlagPondViewWidget.h"
+#include "RangeImage.h"
+#include "SurfaceMesh.h"
+#include "TemporalFusion.h"
+#include "ChangeDetector.h"
+#include "WaterSlagClassifier.h"
+#include "CoordinateTransform.h"
+#include "CloudMerger.h"
+#include "ContourGenerator.h"
+#include "PeakFinder.h"
+#include "PondRegions.h"
+#include "HoleFiller.h"
+#include "OverflowAlarm.h"
+#include "RegionStats.h"
 
 #include <QWidget>
 #include <QListWidget>
@@ -17,6 +30,11 @@
 #include <QProgressBar>
 #include <QUdpSocket>
 #include <QHostAddress>
+#include <QFutureWatcher>
+#include <QTreeWidget>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QSettings>
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -43,16 +61,67 @@ private:
     void setupBottomControls();
 
     bool loadCSV(const QString& filePath, char separator = ',');
+    void loadRadarSettings(QSettings &settings);
+    int radarForSender(const QHostAddress &sender) const;
+    // 变换、去重并融合某台雷达新到的扫描线，无新数据时返回false
+    bool integrateRadar(int radar);
+    void integrateScanLines(bool scanCompleted);
+    // 满池报警：融合后立即判定，先于统计和绘制
+    void evaluateAlarms();
+    void notifyAlarm(int pond, float height, float volume, float latencyMs);
+    void updatePondStatusLabel(int pond);
+    // 分类、峰值、等高线等逐渣池统计
+    void updatePondResults(int pond);
+    // 两个视图显示当前选中的渣池
+    void updateViewers();
+    // 点云模式：各雷达当前扫描中落在所选渣池内的点（实时扫描或载入的CSV）
+    void updatePointCloud();
+    void selectNextPond();
+
+    // 变化检测在线程池中执行，完成后回到界面线程更新显示
+    void startChangeDetection(bool scanCompleted);
+    void onChangeDetectionFinished();
+    void updateDistributionColors();
+    // m_nextSurfaceColors与上次推送的颜色比较，只推送变化的顶点
+    void pushSurfaceColors();
+
+    // 左侧工具栏：选择、距离工具通过三维视图的ID缓冲区拾取
+    void onToolClicked(QListWidgetItem *item);
+    void onPointPicked(SlagPondView *view, const PickResult &result);
+    void clearMeasurement();
+    // 区域工具：选区随拖动实时统计，扫描更新时按新栅格重算
+    void onRegionChanged(SlagPondView *view, const QPolygonF &region, bool rectangle);
+    void updateRegionStats();
+    void clearRegion();
+
+    // 检测结果表：实时行下每个渣池一个子项，峰值列在渣池行下
+    void setupResultRows();
+    void updateResultRow(int pond);
+    // 完整扫描结束后把实时结果存为历史记录
+    void archiveResults();
 
     void onSocketReadyRead();
+    // 长时间无后续片段的扫描线整行写入并融合
+    void onLineFlushTimeout();
+    // 检测主雷达扫描是否结束，并融合已写入的扫描线
+    void processReceivedLines();
     qint64 sendDatagram(const QByteArray &data, const QHostAddress &targetHost, quint16 targetPort);
 
     // 左侧工具栏
     QListWidget *m_toolList;
+    // 拾取信息和距离测量（两个视图同为渣池坐标系，可跨视图测量）
+    QLabel *m_toolInfoLabel = nullptr;
+    QVector<QVector3D> m_measurePoints;
+    // 选区统计（当前渣池补洞后的栅格），积分图只在栅格更新后、有选区时重建
+    RegionStats m_regionStats;
+    QPolygonF m_region;
+    bool m_regionIsRectangle = false;
+    bool m_regionStatsDirty = true;
 
-    // 3D显示区域
-    SlagPondViewWidget *m_heightViewer;    // 料堆实时高度图
-    SlagPondViewWidget *m_distributionViewer; // 料堆实时水渣分布图
+    // 3D显示区域：一个渲染面按图块绘制两个视图
+    SlagPondViewWidget *m_viewWidget;
+    SlagPondView *m_heightViewer;    // 料堆实时高度图
+    SlagPondView *m_distributionViewer; // 料堆实时水渣分布图
 
     // 右侧控制面板
     QWidget *m_rightWidget;
@@ -62,10 +131,104 @@ private:
     // 底部控制按钮
     QWidget *m_bottomControls;
 
-    float m_minHeight = 0;
-    float m_maxHeight = 0;
-    float m_maxHeight_x = 0;
-    float m_maxHeight_y = 0;
+    // 单台雷达的数据流
+    struct RadarStream {
+        QHostAddress address;            // 为空时接收未匹配到其它雷达的所有来源
+        RangeImage image;                // 按扫描线组织的雷达数据
+        CoordinateTransform transform;   // 原始数据 -> 渣池坐标系（米）的标定变换
+        int lastScanRow = -1;
+    };
+    // [0]为主雷达（[calibration]），其余依次对应配置中的[radar1]、[radar2]...
+    QVector<RadarStream> m_radars;
+    // 多雷达合并：重叠单元去重后按渣池拆分
+    CloudMerger m_merger;
+    MergedPoints m_mergedPoints;
+    PondRegions m_regions;
+    QVector<MergedPoints> m_pondPoints;
+
+    // 单个渣池的处理状态
+    struct PondState {
+        QString name;
+        // 多次扫描融合后的高度栅格，显示和统计均以此为准
+        TemporalFusion fusion;
+        // 补洞后的栅格（网格显示和面积/体积统计用），filledMask标记插值单元
+        HeightGrid filledGrid;
+        QVector<quint8> filledMask;
+        int filledCount = 0;
+        // 自上次统计以来融合更新的单元（分类只重新计算这些单元及其邻域）
+        QVector<int> fusedCells;
+        // 等高线（按块增量生成）
+        ContourGenerator contours;
+        bool contoursChanged = false;
+        // 当前显示的渣池自上次刷新视图以来变化的单元，高度图只上传这些单元所在的纹理块
+        QVector<int> viewChangedCells;
+        // 同上，补洞结果变化的单元（与viewChangedCells一起更新网格）
+        QVector<int> viewFilledCells;
+        // 扫描间变化检测（参考为上一次完整扫描）
+        ChangeDetector changeDetector;
+        ChangeResult lastChange;
+        ClassificationResult classification;
+        QVector<Peak> peaks;
+
+        bool updated = false;   // 本次有新数据
+        bool valid = false;     // 已有有效单元
+        float minHeight = 0;
+        float maxHeight = 0;
+        QPointF maxPoint;
+    };
+    QVector<PondState> m_ponds;
+    int m_selectedPond = 0;
+    int m_displayedPond = -1;
+
+    // 各渣池的变化检测一起在线程池中执行
+    QFutureWatcher<QVector<ChangeResult>> m_changeWatcher;
+    QVector<int> m_changePonds;
+    bool m_changePending = false;
+
+    // 补洞、水/渣分类、峰值检测（各渣池共用参数）
+    HoleFiller m_holeFiller;
+    WaterSlagClassifier m_classifier;
+    PeakFinder m_peakFinder;
+    QLabel *m_classSummaryLabel = nullptr;
+    QTreeWidget *m_resultTree = nullptr;
+    static const int MAX_HISTORY = 20;
+
+    // 水渣分布图显示模式
+    enum DistributionMode {
+        DistributionClass,    // 按水/渣分类着色
+        DistributionHeight,   // 按高度着色
+        DistributionChange    // 按扫描间变化着色
+    };
+    DistributionMode m_distributionMode = DistributionClass;
+    // 高度图显示模式：融合后的高度场，或当前扫描的点云
+    enum HeightViewMode {
+        HeightViewField,
+        HeightViewPoints
+    };
+    HeightViewMode m_heightViewMode = HeightViewField;
+    // 水渣分布图使用的三角网格
+    SurfaceMesh m_surfaceMesh;
+    // 已推送到水渣分布图的顶点颜色（按高度着色时为空）及所属渣池；本次待推送的颜色
+    QVector<QVector4D> m_surfaceColors;
+    int m_surfaceColorsPond = -1;
+    QVector<QVector4D> m_nextSurfaceColors;
+    QVector<int> m_changedColors;
+
+    // 满池报警
+    OverflowAlarm m_alarm;
+    QVector<QLabel*> m_pondStatusLabels;
+    QUdpSocket *m_alarmSocket;
+    QHostAddress m_alarmHost;
+    quint16 m_alarmPort = 7999;
+    // 单调时钟（构造时启动），数据报到达时间和报警延迟均以此计
+    QElapsedTimer m_clock;
+    // 本次融合的扫描线中最后一个数据分片的到达时间（ns），用于统计报警延迟
+    qint64 m_lastFragmentTime = -1;
+    // 扫描线片段超过该时间无后续数据时整行写入，不必等下一条扫描线的首个片段
+    QTimer *m_lineFlushTimer = nullptr;
+    static const int LINE_FLUSH_MS = 5;
+    float m_worstAlarmLatency = 0.0f;
+    static constexpr float ALARM_LATENCY_TARGET = 50.0f;   // ms
 
     // UDP连接相关成员
     QUdpSocket *m_udpSocket;
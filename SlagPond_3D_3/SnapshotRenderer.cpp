@@ -0,0 +1,164 @@
+#include "SnapshotRenderer.h"
+#include "RangeImage.h"
+
+#include <QOpenGLContext>
+#include <QOffscreenSurface>
+#include <QOpenGLFramebufferObject>
+#include <QSurfaceFormat>
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QDir>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QDebug>
+
+SnapshotRenderer::SnapshotRenderer() = default;
+
+SnapshotRenderer::~SnapshotRenderer()
+{
+    if (m_context && m_context->makeCurrent(m_surface)) {
+        if (m_view) {
+            m_view->cleanup();
+        }
+        m_renderer.destroy();
+        delete m_fbo;
+        m_fbo = nullptr;
+        m_context->doneCurrent();
+    }
+    delete m_view;
+    delete m_context;
+    delete m_surface;
+}
+
+bool SnapshotRenderer::create(const QSize &size, int samples)
+{
+    // 着色器为GLSL 330 core，llvmpipe等软件实现也按3.3核心模式请求
+    QSurfaceFormat format;
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    format.setDepthBufferSize(24);
+
+    m_context = new QOpenGLContext();
+    m_context->setFormat(format);
+    if (!m_context->create()) {
+        m_errorString = "无法创建OpenGL 3.3上下文（无显示环境时可设置QT_QPA_PLATFORM=offscreen并使用Mesa llvmpipe）";
+        return false;
+    }
+
+    m_surface = new QOffscreenSurface();
+    m_surface->setFormat(m_context->format());
+    m_surface->create();
+    if (!m_surface->isValid() || !m_context->makeCurrent(m_surface)) {
+        m_errorString = "无法创建离屏表面";
+        return false;
+    }
+    initializeOpenGLFunctions();
+
+    QOpenGLFramebufferObjectFormat fboFormat;
+    fboFormat.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+    fboFormat.setSamples(samples);
+    m_fbo = new QOpenGLFramebufferObject(size, fboFormat);
+    if (!m_fbo->isValid()) {
+        delete m_fbo;
+        m_fbo = nullptr;
+        m_errorString = "无法创建帧缓冲区对象";
+        m_context->doneCurrent();
+        return false;
+    }
+
+    // 与界面相同的渲染器和视图；点集同步上传，保证每次render的内容确定
+    m_renderer.initialize();
+    m_view = new SlagPondView();
+    m_view->initialize(&m_renderer, m_context, false);
+
+    qDebug() << "离屏渲染:" << reinterpret_cast<const char*>(glGetString(GL_RENDERER))
+             << "，尺寸:" << size << "，多重采样:" << m_fbo->format().samples();
+    m_context->doneCurrent();
+    return true;
+}
+
+bool SnapshotRenderer::loadScan(const QString &filePath, char separator)
+{
+    RangeImage rangeImage;
+    if (!rangeImage.loadCSV(filePath, separator, 1000000, &m_errorString)) {
+        return false;
+    }
+    m_transform.apply(rangeImage, rangeImage.takeDirtyLines());
+
+    float minHeight = 0.0f;
+    float maxHeight = 0.0f;
+    const QVector<QVector3D> points = rangeImage.toPoints();
+    if (points.isEmpty() || !rangeImage.heightRange(&minHeight, &maxHeight)) {
+        m_errorString = QString("%1 中没有有效数据").arg(filePath);
+        return false;
+    }
+    m_view->setPointsData(points, minHeight, maxHeight);
+    return true;
+}
+
+QImage SnapshotRenderer::render(int preset)
+{
+    if (!isValid() || !m_context->makeCurrent(m_surface)) {
+        return QImage();
+    }
+
+    m_view->setCameraPreset(preset);
+    m_fbo->bind();
+
+    // 与SlagPondViewWidget::paintGL相同的每帧状态
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glEnable(GL_DEPTH_TEST);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+    m_renderer.updateColormapTexture();
+
+    // 跨帧的工作（八叉树后台构建、节点限量上传）完成前重复绘制，构建结果经事件循环送达
+    const QRect viewport(QPoint(0, 0), m_fbo->size());
+    int frames = 0;
+    m_view->render(viewport);
+    while (m_view->hasPendingWork() && ++frames < MAX_SETTLE_FRAMES) {
+        QCoreApplication::processEvents();
+        QThread::msleep(5);
+        m_view->render(viewport);
+    }
+    if (frames >= MAX_SETTLE_FRAMES) {
+        qDebug() << "离屏渲染未等到全部数据就绪，输出当前画面";
+    }
+
+    const QImage image = m_fbo->toImage();
+    m_fbo->release();
+    m_context->doneCurrent();
+    return image;
+}
+
+QString SnapshotRenderer::presetName(int preset)
+{
+    return preset == SlagPondView::CAMERA_TOP ? QString("top") : QString("iso%1").arg(preset);
+}
+
+int SnapshotRenderer::renderScans(const QStringList &scanFiles, const QVector<int> &presets, const QString &outputDir)
+{
+    QDir().mkpath(outputDir);
+    int written = 0;
+    for (const QString &scanFile : scanFiles) {
+        QElapsedTimer timer;
+        timer.start();
+        if (!loadScan(scanFile)) {
+            qWarning() << "跳过" << scanFile << ":" << m_errorString;
+            continue;
+        }
+        const QString baseName = QFileInfo(scanFile).completeBaseName();
+        for (int preset : presets) {
+            const QString path = QDir(outputDir).filePath(QString("%1_%2.png").arg(baseName, presetName(preset)));
+            const QImage image = render(preset);
+            if (image.isNull() || !image.save(path, "PNG")) {
+                qWarning() << "快照保存失败:" << path;
+                continue;
+            }
+            written++;
+        }
+        qDebug() << "快照完成:" << scanFile << "，用时:" << timer.elapsed() << "ms";
+    }
+    return written;
+}
@@ -0,0 +1,57 @@
+#ifndef SNAPSHOTRENDERER_H
+#define SNAPSHOTRENDERER_H
+
+#include <QOpenGLFunctions>
+#include <QSize>
+#include <QImage>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "SlagPondRenderer.h"
+#include "SlagPondView.h"
+#include "CoordinateTransform.h"
+
+class QOpenGLContext;
+class QOffscreenSurface;
+class QOpenGLFramebufferObject;
+
+// 无窗口渲染：QOffscreenSurface上的上下文 + 帧缓冲区对象，复用SlagPondRenderer/SlagPondView绘制，
+// 读回为图像保存PNG（交班报表的俯视图、斜视图）。无GPU时可用Mesa llvmpipe软件渲染
+// 需在界面线程使用（QOffscreenSurface须在界面线程创建），一个进程内可连续处理多次扫描
+class SnapshotRenderer : protected QOpenGLFunctions
+{
+public:
+    SnapshotRenderer();
+    ~SnapshotRenderer();
+
+    // samples > 0时使用多重采样，读回前自动解析
+    bool create(const QSize &size, int samples = 4);
+    bool isValid() const { return m_fbo != nullptr; }
+    QString errorString() const { return m_errorString; }
+
+    // 载入一次扫描（CSV），按标定换算到渣池坐标系后以点集显示
+    void setTransform(const CoordinateTransform &transform) { m_transform = transform; }
+    bool loadScan(const QString &filePath, char separator = ',');
+
+    // preset为SlagPondView的相机预设（0~3斜视角，SlagPondView::CAMERA_TOP俯视）
+    QImage render(int preset);
+
+    // 批量模式：每次扫描按各预设输出 <扫描文件名>_<预设名>.png 到outputDir，返回成功输出的图像数
+    int renderScans(const QStringList &scanFiles, const QVector<int> &presets, const QString &outputDir);
+    static QString presetName(int preset);
+
+private:
+    QOffscreenSurface *m_surface = nullptr;
+    QOpenGLContext *m_context = nullptr;
+    QOpenGLFramebufferObject *m_fbo = nullptr;
+    SlagPondRenderer m_renderer;
+    SlagPondView *m_view = nullptr;
+    CoordinateTransform m_transform;
+    QString m_errorString;
+
+    // 八叉树构建、节点分批上传等跨帧工作的最多等待帧数
+    static const int MAX_SETTLE_FRAMES = 200;
+};
+
+#endif // SNAPSHOTRENDERER_H
@@ -0,0 +1,134 @@
+#include "StreamingBuffer.h"
+
+#include <QOpenGLContext>
+#include <QDebug>
+
+StreamingBuffer::StreamingBuffer(int elementSize, int regionCount)
+    : m_buffer(QOpenGLBuffer::VertexBuffer)
+    , m_elementSize(elementSize)
+    , m_regionCount(qMax(1, regionCount))
+    , m_fences(qMax(1, regionCount), nullptr)
+{
+}
+
+void StreamingBuffer::create()
+{
+    if (m_buffer.isCreated()) {
+        return;
+    }
+    m_gl = QOpenGLContext::currentContext()->extraFunctions();
+    m_buffer.create();
+    m_buffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+}
+
+void StreamingBuffer::destroy()
+{
+    if (!m_gl) {
+        return;
+    }
+    for (GLsync &sync : m_fences) {
+        if (sync) {
+            m_gl->glDeleteSync(sync);
+            sync = nullptr;
+        }
+    }
+    m_buffer.destroy();
+    m_capacity = 0;
+}
+
+void StreamingBuffer::reserve(int count)
+{
+    if (count <= m_capacity) {
+        return;
+    }
+
+    // 按1.5倍扩容，数据量缓慢增长时不必每次重新分配
+    m_capacity = qMax(count, m_capacity + m_capacity / 2);
+    for (GLsync &sync : m_fences) {
+        if (sync) {
+            m_gl->glDeleteSync(sync);
+            sync = nullptr;
+        }
+    }
+
+    m_buffer.bind();
+    m_buffer.allocate(static_cast<qint64>(m_capacity) * m_elementSize * m_regionCount);
+    m_buffer.release();
+    m_current = 0;
+
+    qDebug() << "流式缓冲区扩容，每区段元素数:" << m_capacity
+             << "，总大小:" << static_cast<qint64>(m_capacity) * m_elementSize * m_regionCount / (1024.0f * 1024.0f) << "MB";
+}
+
+void StreamingBuffer::waitRegion(int region)
+{
+    GLsync &sync = m_fences[region];
+    if (!sync) {
+        return;
+    }
+
+    // 区段数足够时栅栏早已完成，这里通常立即返回
+    GLenum status = m_gl->glClientWaitSync(sync, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        status = m_gl->glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);   // 100ms
+        qDebug() << "流式缓冲区等待GPU释放区段" << region;
+    }
+    if (status == GL_WAIT_FAILED) {
+        qDebug() << "流式缓冲区栅栏等待失败";
+    }
+    m_gl->glDeleteSync(sync);
+    sync = nullptr;
+}
+
+void *StreamingBuffer::map(int count)
+{
+    reserve(count);
+
+    m_writing = (m_current + 1) % m_regionCount;
+    waitRegion(m_writing);
+
+    const int offset = m_writing * m_capacity * m_elementSize;
+    const int bytes = count * m_elementSize;
+
+    m_buffer.bind();
+    void *ptr = m_buffer.mapRange(offset, bytes, QOpenGLBuffer::RangeWrite
+                                                     | QOpenGLBuffer::RangeInvalidate
+                                                     | QOpenGLBuffer::RangeUnsynchronized);
+    if (ptr) {
+        m_stagingBytes = -1;
+        return ptr;
+    }
+
+    // 不支持映射时写入暂存区，unmap时用glBufferSubData上传
+    if (m_staging.size() < bytes) {
+        m_staging.resize(bytes);
+    }
+    m_stagingBytes = bytes;
+    return m_staging.data();
+}
+
+void StreamingBuffer::unmap()
+{
+    if (m_writing < 0) {
+        return;
+    }
+
+    if (m_stagingBytes >= 0) {
+        m_buffer.write(m_writing * m_capacity * m_elementSize, m_staging.constData(), m_stagingBytes);
+    } else {
+        m_buffer.unmap();
+    }
+    m_buffer.release();
+
+    m_current = m_writing;
+    m_writing = -1;
+}
+
+void StreamingBuffer::fence()
+{
+    GLsync &sync = m_fences[m_current];
+    if (sync) {
+        m_gl->glDeleteSync(sync);
+    }
+    sync = m_gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,55 @@
+#ifndef STREAMINGBUFFER_H
+#define STREAMINGBUFFER_H
+
+#include <QOpenGLBuffer>
+#include <QOpenGLExtraFunctions>
+#include <QByteArray>
+#include <QVector>
+
+// 流式顶点缓冲区：一个VBO按容量分为若干区段轮流写入，避免每次更新都glBufferData重新分配
+// 写入时以不同步方式映射下一个区段（GPU可能仍在读上一区段），每个区段绘制后插入栅栏，
+// 再次轮到该区段时只需确认其栅栏已完成；映射失败时退回glBufferSubData
+// 需在OpenGL上下文当前时使用
+class StreamingBuffer
+{
+public:
+    explicit StreamingBuffer(int elementSize, int regionCount = 3);
+
+    void create();
+    void destroy();
+    bool isCreated() const { return m_buffer.isCreated(); }
+
+    // 映射下一个区段，返回可写入count个元素的指针；容量不足时扩容（唯一会重新分配的情况）
+    void *map(int count);
+    // 结束写入，之后本区段成为绘制用的当前区段
+    void unmap();
+
+    // 当前区段第一个元素的下标，用作glDrawArrays的first
+    int firstElement() const { return m_current * m_capacity; }
+    int capacity() const { return m_capacity; }
+    // 已分配的显存（所有区段）
+    qint64 sizeInBytes() const { return static_cast<qint64>(m_capacity) * m_elementSize * m_regionCount; }
+
+    void bind() { m_buffer.bind(); }
+    void release() { m_buffer.release(); }
+    // 在读取当前区段的绘制命令之后调用
+    void fence();
+
+private:
+    void reserve(int count);
+    void waitRegion(int region);
+
+    QOpenGLBuffer m_buffer;
+    QOpenGLExtraFunctions *m_gl = nullptr;
+    const int m_elementSize;
+    const int m_regionCount;
+    int m_capacity = 0;        // 每个区段的元素数
+    int m_current = 0;         // 最近一次写完的区段
+    int m_writing = -1;        // 正在写入的区段
+    QVector<GLsync> m_fences;
+    // 映射不可用时的暂存区
+    QByteArray m_staging;
+    int m_stagingBytes = 0;
+};
+
+#endif // STREAMINGBUFFER_H
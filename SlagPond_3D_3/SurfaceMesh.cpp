@@ -0,0 +1,163 @@
+#include "SurfaceMesh.h"
+#include "RangeImage.h"
+#include "HeightGrid.h"
+
+#include <QDebug>
+#include <cmath>
+
+SurfaceMesh::SurfaceMesh()
+    : m_maxDepthJump(0.5f)
+    , m_rows(0)
+    , m_cols(0)
+    , m_topologyRevision(0)
+{
+}
+
+bool SurfaceMesh::build(const RangeImage &image, float scale)
+{
+    const int rows = image.rows();
+    const int cols = image.cols();
+    const QVector<float> &xs = image.xs();
+    const QVector<float> &ys = image.ys();
+    const QVector<float> &zs = image.zs();
+
+    // 顶点：每个格点一个，无效格点不会被索引引用
+    m_positions.resize(rows * cols);
+    for (int i = 0; i < rows * cols; ++i) {
+        m_positions[i] = QVector3D(xs[i] * scale, ys[i] * scale, zs[i] * scale);
+    }
+
+    QVector<quint8> cellMask = computeCellMask(rows, cols, zs.constData(), image.validMask().constData());
+    return updateTopology(rows, cols, cellMask);
+}
+
+bool SurfaceMesh::build(const HeightGrid &grid, float scale)
+{
+    const int rows = grid.rows();
+    const int cols = grid.cols();
+    const QVector<float> &heights = grid.heights();
+
+    m_positions.resize(rows * cols);
+    for (int i = 0; i < rows * cols; ++i) {
+        const QPointF c = grid.cellCenter(i);
+        m_positions[i] = QVector3D(c.x() * scale, c.y() * scale, heights[i] * scale);
+    }
+
+    QVector<quint8> cellMask = computeCellMask(rows, cols, heights.constData(), grid.validMask().constData());
+    return updateTopology(rows, cols, cellMask);
+}
+
+bool SurfaceMesh::update(const HeightGrid &grid, const QVector<int> &cells, float scale)
+{
+    const int rows = grid.rows();
+    const int cols = grid.cols();
+    if (rows != m_rows || cols != m_cols || m_positions.size() != rows * cols) {
+        return build(grid, scale);
+    }
+
+    const float *heights = grid.heights().constData();
+    const quint8 *valid = grid.validMask().constData();
+
+    for (int i : cells) {
+        const QPointF c = grid.cellCenter(i);
+        m_positions[i] = QVector3D(c.x() * scale, c.y() * scale, heights[i] * scale);
+    }
+
+    // 格点只影响以它为角点的四个单元
+    bool topologyChanged = false;
+    for (int i : cells) {
+        const int row = i / cols;
+        const int col = i % cols;
+        for (int r = qMax(0, row - 1); r <= qMin(rows - 2, row); ++r) {
+            for (int c = qMax(0, col - 1); c <= qMin(cols - 2, col); ++c) {
+                const quint8 mask = cellTriangles(r, c, cols, heights, valid);
+                quint8 &current = m_cellMask[r * (cols - 1) + c];
+                if (mask != current) {
+                    current = mask;
+                    topologyChanged = true;
+                }
+            }
+        }
+    }
+
+    if (topologyChanged) {
+        rebuildIndices();
+    }
+    return topologyChanged;
+}
+
+quint8 SurfaceMesh::cellTriangles(int row, int col, int cols, const float *z, const quint8 *valid) const
+{
+    auto triangleOk = [&](int a, int b, int c) {
+        if (!valid[a] || !valid[b] || !valid[c]) {
+            return false;
+        }
+        const float lo = qMin(z[a], qMin(z[b], z[c]));
+        const float hi = qMax(z[a], qMax(z[b], z[c]));
+        return hi - lo <= m_maxDepthJump;
+    };
+
+    const int i00 = row * cols + col;
+    const int i01 = i00 + 1;
+    const int i10 = i00 + cols;
+    const int i11 = i10 + 1;
+
+    quint8 mask = 0;
+    if (triangleOk(i00, i01, i10)) mask |= 1;
+    if (triangleOk(i01, i11, i10)) mask |= 2;
+    return mask;
+}
+
+QVector<quint8> SurfaceMesh::computeCellMask(int rows, int cols, const float *z, const quint8 *valid) const
+{
+    QVector<quint8> cellMask(qMax(0, rows - 1) * qMax(0, cols - 1), 0);
+
+    for (int row = 0; row + 1 < rows; ++row) {
+        for (int col = 0; col + 1 < cols; ++col) {
+            cellMask[row * (cols - 1) + col] = cellTriangles(row, col, cols, z, valid);
+        }
+    }
+    return cellMask;
+}
+
+bool SurfaceMesh::updateTopology(int rows, int cols, QVector<quint8> &cellMask)
+{
+    if (rows == m_rows && cols == m_cols && cellMask == m_cellMask) {
+        return false;
+    }
+
+    m_rows = rows;
+    m_cols = cols;
+    m_cellMask.swap(cellMask);
+    rebuildIndices();
+    return true;
+}
+
+void SurfaceMesh::rebuildIndices()
+{
+    const int rows = m_rows;
+    const int cols = m_cols;
+
+    m_indices.clear();
+    m_indices.reserve(m_cellMask.size() * 6);
+
+    for (int row = 0; row + 1 < rows; ++row) {
+        for (int col = 0; col + 1 < cols; ++col) {
+            const quint8 mask = m_cellMask[row * (cols - 1) + col];
+            const unsigned int i00 = row * cols + col;
+            const unsigned int i01 = i00 + 1;
+            const unsigned int i10 = i00 + cols;
+            const unsigned int i11 = i10 + 1;
+
+            if (mask & 1) {
+                m_indices << i00 << i01 << i10;
+            }
+            if (mask & 2) {
+                m_indices << i01 << i11 << i10;
+            }
+        }
+    }
+
+    m_topologyRevision++;
+    qDebug() << "重建网格拓扑，三角形数:" << triangleCount();
+}
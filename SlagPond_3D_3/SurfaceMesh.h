@@ -0,0 +1,60 @@
+#ifndef SURFACEMESH_H
+#define SURFACEMESH_H
+
+#include <QVector>
+#include <QVector3D>
+
+class RangeImage;
+class HeightGrid;
+
+// 由有序数据（距离图像或高度栅格）生成带索引的三角网格
+// 每个格点对应一个顶点，相邻四个格点组成两个三角形；
+// 三角形内高差超过阈值时断开，避免在深度跳变处拉出"幕布"。
+// 只有拓扑（有效位/断开位）变化时才重建索引，否则只更新顶点坐标。
+// 高度栅格可按变化单元增量更新：只改写这些单元的顶点，只重算相邻单元的三角形掩码。
+class SurfaceMesh
+{
+public:
+    SurfaceMesh();
+
+    // 三角形内允许的最大高差（与输入坐标同单位）
+    void setMaxDepthJump(float jump) { m_maxDepthJump = jump; }
+    float maxDepthJump() const { return m_maxDepthJump; }
+
+    // 由距离图像生成网格，scale为输出坐标缩放。返回索引是否重建
+    bool build(const RangeImage &image, float scale = 1.0f);
+    // 由高度栅格生成网格，每个单元中心一个顶点
+    bool build(const HeightGrid &grid, float scale = 1.0f);
+    // 只更新cells（单元序号，即顶点序号，可重复）对应的顶点，栅格尺寸与上次build不同时整体重建
+    // 返回索引是否重建
+    bool update(const HeightGrid &grid, const QVector<int> &cells, float scale = 1.0f);
+
+    const QVector<QVector3D>& positions() const { return m_positions; }
+    int vertexCount() const { return m_positions.size(); }
+    const QVector<unsigned int>& indices() const { return m_indices; }
+    int triangleCount() const { return m_indices.size() / 3; }
+
+    // 拓扑版本号，索引重建时递增
+    quint64 topologyRevision() const { return m_topologyRevision; }
+
+private:
+    // 计算每个单元的三角形掩码（有效位 + 高差阈值）
+    QVector<quint8> computeCellMask(int rows, int cols, const float *z, const quint8 *valid) const;
+    // 单个单元（左上角格点为row, col）的三角形掩码
+    quint8 cellTriangles(int row, int col, int cols, const float *z, const quint8 *valid) const;
+    // 根据网格尺寸和每个单元的三角形掩码重建索引，掩码未变化时返回false
+    bool updateTopology(int rows, int cols, QVector<quint8> &cellMask);
+    // 按当前掩码重建索引
+    void rebuildIndices();
+
+    float m_maxDepthJump;
+    int m_rows;
+    int m_cols;
+    quint64 m_topologyRevision;
+
+    QVector<QVector3D> m_positions;
+    QVector<unsigned int> m_indices;
+    QVector<quint8> m_cellMask;   // 每个单元：bit0 = 上三角，bit1 = 下三角
+};
+
+#endif // SURFACEMESH_H
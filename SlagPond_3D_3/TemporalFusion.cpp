@@ -0,0 +1,177 @@
+#include "TemporalFusion.h"
+#include "RangeImage.h"
+
+TemporalFusion::TemporalFusion()
+    : m_alpha(0.3f)
+    , m_floorHeight(0.0f)
+    , m_volumeSum(0.0)
+    , m_validCount(0)
+    , m_maxIndex(-1)
+    , m_maxHeight(0.0f)
+    , m_minIndex(-1)
+    , m_minHeight(0.0f)
+    , m_extremaStale(false)
+{
+    reset();
+}
+
+void TemporalFusion::reset()
+{
+    reset(m_grid);
+}
+
+void TemporalFusion::reset(const HeightGrid &layout)
+{
+    m_grid.reset(layout.originX(), layout.originY(), layout.cellSize(), layout.cols(), layout.rows());
+    m_confidence.fill(0.0f, m_grid.cellCount());
+    m_amplitude.fill(0.0f, m_grid.cellCount());
+    m_scanSum.fill(0.0f, m_grid.cellCount());
+    m_scanAmplitudeSum.fill(0.0f, m_grid.cellCount());
+    m_scanCount.fill(0, m_grid.cellCount());
+    m_changedCells.clear();
+    m_volumeSum = 0.0;
+    m_validCount = 0;
+    m_maxIndex = -1;
+    m_minIndex = -1;
+    m_extremaStale = false;
+}
+
+void TemporalFusion::setFloorHeight(float height)
+{
+    if (height == m_floorHeight) {
+        return;
+    }
+    m_floorHeight = height;
+
+    const QVector<float> &heights = m_grid.heights();
+    const QVector<quint8> &valid = m_grid.validMask();
+    m_volumeSum = 0.0;
+    for (int i = 0; i < heights.size(); ++i) {
+        if (valid[i]) {
+            m_volumeSum += excess(heights[i]);
+        }
+    }
+}
+
+const QVector<int>& TemporalFusion::integrate(const RangeImage &image, const QVector<int> &lines)
+{
+    m_changedCells.clear();
+
+    for (int row : lines) {
+        const int base = image.index(row, 0);
+        accumulate(image.xs().constData() + base, image.ys().constData() + base, image.zs().constData() + base,
+                   image.amplitudes().constData() + base, image.lineCount(row));
+    }
+
+    applyAccumulated();
+    return m_changedCells;
+}
+
+const QVector<int>& TemporalFusion::integrate(const float *x, const float *y, const float *z,
+                                              const float *amplitude, int count)
+{
+    m_changedCells.clear();
+    accumulate(x, y, z, amplitude, count);
+    applyAccumulated();
+    return m_changedCells;
+}
+
+void TemporalFusion::accumulate(const float *x, const float *y, const float *z, const float *amplitude, int count)
+{
+    // 本次落点按单元累加
+    for (int i = 0; i < count; ++i) {
+        const int cell = m_grid.cellIndex(x[i], y[i]);
+        if (cell < 0) {
+            continue;
+        }
+        if (m_scanCount[cell] == 0) {
+            m_changedCells.append(cell);
+        }
+        m_scanSum[cell] += z[i];
+        m_scanAmplitudeSum[cell] += amplitude[i];
+        m_scanCount[cell]++;
+    }
+}
+
+void TemporalFusion::applyAccumulated()
+{
+    // 只对涉及的单元做滑动平均，置信度向1收敛
+    QVector<float> &heights = m_grid.heights();
+    QVector<quint8> &valid = m_grid.validMask();
+
+    for (int cell : m_changedCells) {
+        const float observed = m_scanSum[cell] / m_scanCount[cell];
+        const float observedAmplitude = m_scanAmplitudeSum[cell] / m_scanCount[cell];
+        if (valid[cell]) {
+            const float previous = heights[cell];
+            heights[cell] += m_alpha * (observed - previous);
+            m_volumeSum += excess(heights[cell]) - excess(previous);
+            m_amplitude[cell] += m_alpha * (observedAmplitude - m_amplitude[cell]);
+            m_confidence[cell] += m_alpha * (1.0f - m_confidence[cell]);
+        } else {
+            heights[cell] = observed;
+            m_volumeSum += excess(observed);
+            m_validCount++;
+            m_amplitude[cell] = observedAmplitude;
+            valid[cell] = 1;
+            m_confidence[cell] = m_alpha;
+        }
+
+        m_scanSum[cell] = 0.0f;
+        m_scanAmplitudeSum[cell] = 0.0f;
+        m_scanCount[cell] = 0;
+    }
+
+    updateExtrema();
+}
+
+void TemporalFusion::updateExtrema()
+{
+    const QVector<float> &heights = m_grid.heights();
+
+    for (int cell : m_changedCells) {
+        const float height = heights[cell];
+        if (m_maxIndex < 0 || height >= m_maxHeight) {
+            // 不低于原最高值的单元必然是新的最高点
+            m_maxIndex = cell;
+            m_maxHeight = height;
+        } else if (cell == m_maxIndex) {
+            // 原最高点被下调后需要重新查找
+            m_extremaStale = true;
+        }
+        if (m_minIndex < 0 || height <= m_minHeight) {
+            m_minIndex = cell;
+            m_minHeight = height;
+        } else if (cell == m_minIndex) {
+            m_extremaStale = true;
+        }
+    }
+
+    // 原最高点或最低点向内移动时整幅重新查找
+    if (m_extremaStale) {
+        if (!m_grid.heightRange(&m_minHeight, &m_maxHeight, &m_maxIndex, &m_minIndex)) {
+            m_maxIndex = -1;
+            m_minIndex = -1;
+        }
+        m_extremaStale = false;
+    }
+}
+
+bool TemporalFusion::maxHeight(float *height, int *index) const
+{
+    if (m_maxIndex < 0) {
+        return false;
+    }
+    if (height) *height = m_maxHeight;
+    if (index) *index = m_maxIndex;
+    return true;
+}
+
+bool TemporalFusion::minHeight(float *height) const
+{
+    if (m_minIndex < 0) {
+        return false;
+    }
+    if (height) *height = m_minHeight;
+    return true;
+}
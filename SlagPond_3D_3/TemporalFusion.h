@@ -0,0 +1,81 @@
+#ifndef TEMPORALFUSION_H
+#define TEMPORALFUSION_H
+
+#include "HeightGrid.h"
+
+#include <QVector>
+
+class RangeImage;
+
+// 多次扫描的时间融合：每个栅格单元维护高度的指数滑动平均和置信度
+// 按扫描线增量融合，耗时只与本次落点涉及的单元数成正比
+class TemporalFusion
+{
+public:
+    TemporalFusion();
+
+    // 新观测的权重（0~1），越大越跟随最新扫描
+    void setAlpha(float alpha) { m_alpha = qBound(0.01f, alpha, 1.0f); }
+    float alpha() const { return m_alpha; }
+
+    // 清空融合状态（更换渣池或栅格参数时调用）
+    void reset();
+    void reset(const HeightGrid &layout);
+
+    // 融合距离图像中指定扫描线的数据，返回本次更新的单元
+    const QVector<int>& integrate(const RangeImage &image, const QVector<int> &lines);
+    // 融合一组已在渣池坐标系下的点（多雷达合并后的数据）
+    const QVector<int>& integrate(const float *x, const float *y, const float *z,
+                                  const float *amplitude, int count);
+
+    const HeightGrid& grid() const { return m_grid; }
+    const QVector<float>& confidence() const { return m_confidence; }
+    // 每个单元回波幅度的滑动平均
+    const QVector<float>& amplitude() const { return m_amplitude; }
+    const QVector<int>& changedCells() const { return m_changedCells; }
+
+    // 融合后的最高点、最低点，无有效单元时返回false
+    bool maxHeight(float *height, int *index = nullptr) const;
+    bool minHeight(float *height) const;
+
+    // 池底高度（体积计算基准），修改时按当前栅格重算一次体积
+    void setFloorHeight(float height);
+    float floorHeight() const { return m_floorHeight; }
+
+    // 有效单元在池底以上的总体积，逐单元按max(h - 池底, 0)计（与水渣分类的体积定义一致）
+    // 增量维护，O(1)，不含补洞单元
+    float volume() const { return static_cast<float>(m_volumeSum * m_grid.cellArea()); }
+    int validCount() const { return m_validCount; }
+
+private:
+    void accumulate(const float *x, const float *y, const float *z, const float *amplitude, int count);
+    void applyAccumulated();
+    void updateExtrema();
+    float excess(float height) const { return qMax(height - m_floorHeight, 0.0f); }
+
+    HeightGrid m_grid;
+    QVector<float> m_confidence;
+    QVector<float> m_amplitude;
+
+    // 单次融合的临时累加（用完后恢复为0）
+    QVector<float> m_scanSum;
+    QVector<float> m_scanAmplitudeSum;
+    QVector<int> m_scanCount;
+    QVector<int> m_changedCells;
+
+    float m_alpha;
+    float m_floorHeight;
+
+    // 增量维护的池底以上高度和与有效单元数
+    double m_volumeSum;
+    int m_validCount;
+
+    // 增量维护的最高点、最低点
+    int m_maxIndex;
+    float m_maxHeight;
+    int m_minIndex;
+    float m_minHeight;
+    bool m_extremaStale;
+};
+
+#endif // TEMPORALFUSION_H
@@ -0,0 +1,232 @@
+#include "WaterSlagClassifier.h"
+#include "ParallelFor.h"
+
+#include <QSettings>
+#include <QDebug>
+#include <cmath>
+#include <algorithm>
+
+WaterSlagClassifier::WaterSlagClassifier()
+    : m_waterLevel(0.5f)
+    , m_heightTolerance(0.125f)
+    , m_amplitudeThreshold(50.0f)
+    , m_roughnessThreshold(0.075f)
+    , m_floorHeight(0.0f)
+{
+}
+
+void WaterSlagClassifier::loadSettings(QSettings &settings)
+{
+    settings.beginGroup("classifier");
+    m_waterLevel = settings.value("waterLevel", m_waterLevel).toFloat();
+    m_heightTolerance = settings.value("heightTolerance", m_heightTolerance).toFloat();
+    m_amplitudeThreshold = settings.value("amplitudeThreshold", m_amplitudeThreshold).toFloat();
+    m_roughnessThreshold = settings.value("roughnessThreshold", m_roughnessThreshold).toFloat();
+    m_floorHeight = settings.value("floorHeight", m_floorHeight).toFloat();
+    settings.endGroup();
+
+    qDebug() << "水渣分类: 水位" << m_waterLevel << "，容差" << m_heightTolerance
+             << "，幅度阈值" << m_amplitudeThreshold << "，粗糙度阈值" << m_roughnessThreshold
+             << "，池底高度" << m_floorHeight;
+}
+
+void WaterSlagClassifier::computeRoughness(const HeightGrid &grid, QVector<float> &roughness) const
+{
+    const int cols = grid.cols();
+    const int rows = grid.rows();
+    const float *h = grid.heights().constData();
+    const quint8 *valid = grid.validMask().constData();
+
+    roughness.resize(cols * rows);
+    float *out = roughness.data();
+
+    parallelFor(rows, [&](int begin, int end) {
+        // 行两端各补一个0，3x3窗口逐偏移累加整行
+        QVector<float> padH(cols + 2, 0.0f);
+        QVector<float> padW(cols + 2, 0.0f);
+        QVector<float> sum(cols);
+        QVector<float> sumSq(cols);
+        QVector<float> count(cols);
+        float *ph = padH.data();
+        float *pw = padW.data();
+        float *s = sum.data();
+        float *sq = sumSq.data();
+        float *n = count.data();
+
+        for (int row = begin; row < end; ++row) {
+            std::fill(s, s + cols, 0.0f);
+            std::fill(sq, sq + cols, 0.0f);
+            std::fill(n, n + cols, 0.0f);
+
+            for (int rr = qMax(0, row - 1); rr <= qMin(rows - 1, row + 1); ++rr) {
+                const float *srcH = h + rr * cols;
+                const quint8 *srcV = valid + rr * cols;
+                for (int c = 0; c < cols; ++c) {
+                    const float m = static_cast<float>(srcV[c]);
+                    ph[c + 1] = srcH[c] * m;
+                    pw[c + 1] = m;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    for (int c = 0; c < cols; ++c) {
+                        const float v = ph[c + k];
+                        s[c] += v;
+                        sq[c] += v * v;
+                        n[c] += pw[c + k];
+                    }
+                }
+            }
+
+            float *dst = out + row * cols;
+            for (int c = 0; c < cols; ++c) {
+                const float inv = 1.0f / std::max(n[c], 1.0f);
+                const float mean = s[c] * inv;
+                const float var = sq[c] * inv - mean * mean;
+                dst[c] = std::sqrt(std::max(var, 0.0f));
+            }
+        }
+    });
+}
+
+float WaterSlagClassifier::roughnessAt(const HeightGrid &grid, int col, int row) const
+{
+    // 与computeRoughness相同：3x3邻域内有效单元高度的标准差
+    float sum = 0.0f;
+    float sumSq = 0.0f;
+    float count = 0.0f;
+    for (int rr = qMax(0, row - 1); rr <= qMin(grid.rows() - 1, row + 1); ++rr) {
+        for (int cc = qMax(0, col - 1); cc <= qMin(grid.cols() - 1, col + 1); ++cc) {
+            const int i = grid.index(cc, rr);
+            if (grid.isValid(i)) {
+                const float v = grid.height(i);
+                sum += v;
+                sumSq += v * v;
+                count += 1.0f;
+            }
+        }
+    }
+    const float inv = 1.0f / std::max(count, 1.0f);
+    const float mean = sum * inv;
+    return std::sqrt(std::max(sumSq * inv - mean * mean, 0.0f));
+}
+
+ClassificationResult WaterSlagClassifier::classify(const HeightGrid &grid, const QVector<float> &amplitude,
+                                                  const QVector<quint8> &filled) const
+{
+    ClassificationResult result;
+    const int cols = grid.cols();
+    const int rows = grid.rows();
+    const int n = cols * rows;
+
+    result.cols = cols;
+    result.rows = rows;
+    result.labels.resize(n);
+    computeRoughness(grid, result.roughness);
+
+    // 没有幅度数据时该项特征恒为"弱回波"，由高度和粗糙度决定
+    QVector<float> noAmplitude;
+    if (amplitude.size() != n) {
+        noAmplitude.fill(0.0f, n);
+    }
+    const float *amp = amplitude.size() == n ? amplitude.constData() : noAmplitude.constData();
+    const float *h = grid.heights().constData();
+    const quint8 *valid = grid.validMask().constData();
+    const float *rough = result.roughness.constData();
+    quint8 *labels = result.labels.data();
+
+    parallelFor(rows, [&](int begin, int end) {
+        for (int i = begin * cols; i < end * cols; ++i) {
+            labels[i] = valid[i] ? label(h[i], amp[i], rough[i]) : CellUnknown;
+        }
+    });
+
+    // 分类统计，逐单元的贡献留作增量更新时扣除
+    const float cellArea = grid.cellArea();
+    const bool hasFilled = filled.size() == n;
+    result.volumes.fill(0.0f, n);
+    result.filled.fill(0, n);
+    for (int i = 0; i < n; ++i) {
+        if (labels[i] == CellUnknown) {
+            continue;
+        }
+        result.filled[i] = hasFilled && filled[i] ? 1 : 0;
+        result.volumes[i] = std::max(h[i] - m_floorHeight, 0.0f) * cellArea;
+        addToStats(result, i, 1);
+    }
+    result.water.area = result.water.cellCount * cellArea;
+    result.slag.area = result.slag.cellCount * cellArea;
+
+    return result;
+}
+
+void WaterSlagClassifier::update(const HeightGrid &grid, const QVector<float> &amplitude, const QVector<quint8> &filled,
+                                 const QVector<int> &cells, ClassificationResult &result) const
+{
+    const int cols = grid.cols();
+    const int rows = grid.rows();
+    const int n = cols * rows;
+    if (result.cols != cols || result.rows != rows || result.labels.size() != n || result.volumes.size() != n) {
+        result = classify(grid, amplitude, filled);
+        return;
+    }
+
+    // 变化单元的粗糙度影响其3x3邻域，邻域去重后逐单元重新分类
+    QVector<int> affected;
+    affected.reserve(cells.size() * 9);
+    for (int cell : cells) {
+        const int row = cell / cols;
+        const int col = cell % cols;
+        for (int rr = qMax(0, row - 1); rr <= qMin(rows - 1, row + 1); ++rr) {
+            for (int cc = qMax(0, col - 1); cc <= qMin(cols - 1, col + 1); ++cc) {
+                affected.append(rr * cols + cc);
+            }
+        }
+    }
+    std::sort(affected.begin(), affected.end());
+    affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+
+    const float *h = grid.heights().constData();
+    const bool hasAmplitude = amplitude.size() == n;
+    const bool hasFilled = filled.size() == n;
+    const float cellArea = grid.cellArea();
+    for (int i : affected) {
+        addToStats(result, i, -1);
+        result.roughness[i] = roughnessAt(grid, i % cols, i / cols);
+        if (!grid.isValid(i)) {
+            result.labels[i] = CellUnknown;
+            result.volumes[i] = 0.0f;
+            result.filled[i] = 0;
+            continue;
+        }
+        result.labels[i] = label(h[i], hasAmplitude ? amplitude[i] : 0.0f, result.roughness[i]);
+        result.filled[i] = hasFilled && filled[i] ? 1 : 0;
+        result.volumes[i] = std::max(h[i] - m_floorHeight, 0.0f) * cellArea;
+        addToStats(result, i, 1);
+    }
+    result.water.area = result.water.cellCount * cellArea;
+    result.slag.area = result.slag.cellCount * cellArea;
+}
+
+quint8 WaterSlagClassifier::label(float height, float amplitude, float roughness) const
+{
+    const float dh = std::fabs(height - m_waterLevel);
+    const int votes = static_cast<int>(dh <= m_heightTolerance)
+                      + static_cast<int>(amplitude <= m_amplitudeThreshold)
+                      + static_cast<int>(roughness <= m_roughnessThreshold);
+    // 远离水位线的单元不可能是水面
+    return dh <= 2.0f * m_heightTolerance && votes >= 2 ? CellWater : CellSlag;
+}
+
+void WaterSlagClassifier::addToStats(ClassificationResult &result, int index, int sign) const
+{
+    ClassStats *stats = nullptr;
+    if (result.labels[index] == CellWater) {
+        stats = &result.water;
+    } else if (result.labels[index] == CellSlag) {
+        stats = &result.slag;
+    } else {
+        return;
+    }
+    stats->cellCount += sign;
+    stats->filledCellCount += sign * result.filled[index];
+    stats->volume += sign * result.volumes[index];
+}
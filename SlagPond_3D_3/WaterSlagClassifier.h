@@ -0,0 +1,81 @@
+#ifndef WATERSLAGCLASSIFIER_H
+#define WATERSLAGCLASSIFIER_H
+
+#include "HeightGrid.h"
+
+#include <QVector>
+
+class QSettings;
+
+// 单元类别
+enum CellClass : quint8 {
+    CellUnknown = 0,   // 无数据
+    CellWater = 1,     // 水面
+    CellSlag = 2       // 水渣
+};
+
+// 某一类别的统计
+struct ClassStats {
+    int cellCount = 0;
+    float area = 0.0f;     // 面积
+    float volume = 0.0f;   // 池底以上的体积
+    int filledCellCount = 0;   // 其中由补洞插值得到的单元数
+
+    // 实测单元占比，作为面积/体积的置信度
+    float confidence() const { return cellCount > 0 ? 1.0f - float(filledCellCount) / cellCount : 0.0f; }
+};
+
+struct ClassificationResult {
+    int cols = 0;
+    int rows = 0;
+    QVector<quint8> labels;    // 每个单元的 CellClass
+    QVector<float> roughness;  // 3x3邻域高度标准差
+    QVector<float> volumes;    // 每个单元计入统计的体积（增量更新时扣除旧值）
+    QVector<quint8> filled;    // 每个单元计入统计时是否为插值单元
+    ClassStats water;
+    ClassStats slag;
+};
+
+// 水/渣分类：依据单元高度相对水位线的偏差、回波幅度和局部粗糙度三项特征投票
+// 水面贴近水位线、回波弱、表面平整；渣堆通常高出水面、回波强、表面起伏大
+// 按行分块批量处理，特征计算为连续数组运算以便编译器向量化
+class WaterSlagClassifier
+{
+public:
+    WaterSlagClassifier();
+
+    // 以下参数单位均为米（幅度除外），需按现场标定
+    void setWaterLevel(float level) { m_waterLevel = level; }
+    float waterLevel() const { return m_waterLevel; }
+    void setHeightTolerance(float tolerance) { m_heightTolerance = tolerance; }
+    void setAmplitudeThreshold(float threshold) { m_amplitudeThreshold = threshold; }
+    void setRoughnessThreshold(float threshold) { m_roughnessThreshold = threshold; }
+    // 池底高度（体积计算基准）
+    void setFloorHeight(float height) { m_floorHeight = height; }
+    float floorHeight() const { return m_floorHeight; }
+
+    // 从配置文件[classifier]组读取以上参数，未配置的项保持当前值
+    void loadSettings(QSettings &settings);
+
+    // filled非空时统计其中标记为插值的单元数
+    ClassificationResult classify(const HeightGrid &grid, const QVector<float> &amplitude,
+                                  const QVector<quint8> &filled = QVector<quint8>()) const;
+    // 只重新分类cells及其3x3邻域（粗糙度依赖邻域），统计按单元新旧贡献之差修正
+    // result须为同一栅格上一次的分类结果，否则整幅重新分类
+    void update(const HeightGrid &grid, const QVector<float> &amplitude, const QVector<quint8> &filled,
+                const QVector<int> &cells, ClassificationResult &result) const;
+
+private:
+    void computeRoughness(const HeightGrid &grid, QVector<float> &roughness) const;
+    float roughnessAt(const HeightGrid &grid, int col, int row) const;
+    quint8 label(float height, float amplitude, float roughness) const;
+    void addToStats(ClassificationResult &result, int index, int sign) const;
+
+    float m_waterLevel;
+    float m_heightTolerance;
+    float m_amplitudeThreshold;
+    float m_roughnessThreshold;
+    float m_floorHeight;
+};
+
+#endif // WATERSLAGCLASSIFIER_H
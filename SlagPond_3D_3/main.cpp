@@ -1,9 +1,82 @@
 #include "SlagPondWidget.h"
+#include "SnapshotRenderer.h"
 
 #include <QApplication>
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QSettings>
+#include <QDebug>
+
+// 批量快照：SlagPond_3D_3 --snapshot [-o 目录] [--size 1600x1200] [--presets top,0] 扫描1.csv 扫描2.csv ...
+static int runSnapshots(QGuiApplication &app)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("渣池扫描离屏快照");
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("snapshot", "无窗口批量输出快照"));
+    parser.addOption(QCommandLineOption({"o", "output"}, "输出目录", "dir", "."));
+    parser.addOption(QCommandLineOption("size", "图像尺寸", "WxH", "1600x1200"));
+    parser.addOption(QCommandLineOption("presets", "相机预设，0~3为斜视角，top为俯视", "list", "top,0"));
+    parser.addOption(QCommandLineOption("samples", "多重采样数", "n", "4"));
+    parser.addOption(QCommandLineOption("config", "标定配置文件", "ini",
+                                        QCoreApplication::applicationDirPath() + "/SlagPond.ini"));
+    parser.addPositionalArgument("scans", "扫描数据CSV文件", "scan.csv...");
+    parser.process(app);
+
+    const QStringList scans = parser.positionalArguments();
+    if (scans.isEmpty()) {
+        qWarning() << "未指定扫描文件";
+        return 1;
+    }
+
+    const QStringList sizeParts = parser.value("size").split('x');
+    const QSize size = sizeParts.size() == 2 ? QSize(sizeParts[0].toInt(), sizeParts[1].toInt()) : QSize();
+    if (size.isEmpty()) {
+        qWarning() << "图像尺寸无效:" << parser.value("size");
+        return 1;
+    }
+
+    QVector<int> presets;
+    for (const QString &name : parser.value("presets").split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const int preset = name.trimmed() == "top" ? SlagPondView::CAMERA_TOP : name.toInt(&ok);
+        if (preset != SlagPondView::CAMERA_TOP && (!ok || preset < 0 || preset > 3)) {
+            qWarning() << "未知的相机预设:" << name;
+            return 1;
+        }
+        presets.append(preset);
+    }
+
+    // 扫描数据按主雷达标定换算
+    QSettings settings(parser.value("config"), QSettings::IniFormat);
+    CoordinateTransform transform;
+    transform.loadSettings(settings);
+
+    SnapshotRenderer renderer;
+    if (!renderer.create(size, parser.value("samples").toInt())) {
+        qWarning() << renderer.errorString();
+        return 2;
+    }
+    renderer.setTransform(transform);
+
+    const int written = renderer.renderScans(scans, presets, parser.value("output"));
+    qDebug() << "共输出快照:" << written << "/" << scans.size() * presets.size();
+    return written == scans.size() * presets.size() ? 0 : 1;
+}
 
 int main(int argc, char *argv[])
 {
+    // 快照模式不创建任何窗口，只需QGuiApplication；未指定平台插件时使用offscreen，无显示环境也可运行
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--snapshot") == 0) {
+            if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+                qputenv("QT_QPA_PLATFORM", "offscreen");
+            }
+            QGuiApplication app(argc, argv);
+            return runSnapshots(app);
+        }
+    }
+
     QApplication a(argc, argv);
     SlagPondWidget w;
     w.show();